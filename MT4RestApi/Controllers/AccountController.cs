@@ -17,6 +17,26 @@ public class AccountController : ControllerBase
         _logger = logger;
     }
 
+    /// <summary>
+    /// Accounts that crossed their group's margin call or stop out level since the
+    /// previous call. Each change is returned once.
+    /// </summary>
+    [HttpGet("margin-levels/changes")]
+    public async Task<ActionResult<ApiResponse<List<MarginLevelChange>>>> GetMarginLevelChanges()
+    {
+        if (!_mt4Service.IsConnected)
+        {
+            return BadRequest(ApiResponse<List<MarginLevelChange>>.ErrorResult("Not connected to MT4 server"));
+        }
+
+        var changes = await _mt4Service.ScanMarginLevelsAsync();
+        if (!changes.Success)
+        {
+            return BadRequest(ApiResponse<List<MarginLevelChange>>.ErrorResult(changes.Error!));
+        }
+        return Ok(ApiResponse<List<MarginLevelChange>>.SuccessResult(changes.Value!));
+    }
+
     /// <summary>
     /// Get account balance information
     /// </summary>
@@ -31,7 +51,11 @@ public class AccountController : ControllerBase
         _logger.LogInformation("Retrieving balance for account: {Login}", login);
         
         var balanceInfo = await _mt4Service.GetBalanceInfoAsync(login);
-        return Ok(ApiResponse<BalanceInfo>.SuccessResult(balanceInfo));
+        if (!balanceInfo.Success)
+        {
+            return BadRequest(ApiResponse<BalanceInfo>.ErrorResult(balanceInfo.Error!));
+        }
+        return Ok(ApiResponse<BalanceInfo>.SuccessResult(balanceInfo.Value!));
     }
 
     /// <summary>
@@ -48,7 +72,11 @@ public class AccountController : ControllerBase
         _logger.LogInformation("Retrieving equity for account: {Login}", login);
         
         var balanceInfo = await _mt4Service.GetBalanceInfoAsync(login);
-        return Ok(ApiResponse<double>.SuccessResult(balanceInfo.Equity));
+        if (!balanceInfo.Success)
+        {
+            return BadRequest(ApiResponse<double>.ErrorResult(balanceInfo.Error!));
+        }
+        return Ok(ApiResponse<double>.SuccessResult(balanceInfo.Value!.Equity));
     }
 
     /// <summary>
@@ -65,6 +93,10 @@ public class AccountController : ControllerBase
         _logger.LogInformation("Retrieving margin for account: {Login}", login);
         
         var balanceInfo = await _mt4Service.GetBalanceInfoAsync(login);
-        return Ok(ApiResponse<double>.SuccessResult(balanceInfo.Margin));
+        if (!balanceInfo.Success)
+        {
+            return BadRequest(ApiResponse<double>.ErrorResult(balanceInfo.Error!));
+        }
+        return Ok(ApiResponse<double>.SuccessResult(balanceInfo.Value!.Margin));
     }
 }
\ No newline at end of file
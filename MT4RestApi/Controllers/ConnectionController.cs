@@ -30,15 +30,14 @@ public class ConnectionController : ControllerBase
 
         _logger.LogInformation("Attempting to connect to server: {Server}", request.Server);
         
-        var success = await _mt4Service.ConnectAsync(request.Server);
-        if (success)
+        var result = await _mt4Service.ConnectAsync(request.Server);
+        if (result.Success)
         {
             return Ok(ApiResponse.SuccessResult());
         }
 
-        var error = _mt4Service.GetLastError();
-        _logger.LogError("Connection failed: {Error}", error);
-        return BadRequest(ApiResponse.ErrorResult(error));
+        _logger.LogError("Connection failed: {Error}", result.Error);
+        return BadRequest(ApiResponse.ErrorResult(result.Error!));
     }
 
     /// <summary>
@@ -54,15 +53,14 @@ public class ConnectionController : ControllerBase
 
         _logger.LogInformation("Attempting to login with login: {Login}", request.Login);
         
-        var success = await _mt4Service.LoginAsync(request.Login, request.Password);
-        if (success)
+        var result = await _mt4Service.LoginAsync(request.Login, request.Password);
+        if (result.Success)
         {
             return Ok(ApiResponse.SuccessResult());
         }
 
-        var error = _mt4Service.GetLastError();
-        _logger.LogError("Login failed: {Error}", error);
-        return BadRequest(ApiResponse.ErrorResult(error));
+        _logger.LogError("Login failed: {Error}", result.Error);
+        return BadRequest(ApiResponse.ErrorResult(result.Error!));
     }
 
     /// <summary>
@@ -94,4 +92,44 @@ public class ConnectionController : ControllerBase
         await _mt4Service.DisconnectAsync();
         return Ok(ApiResponse.SuccessResult());
     }
+
+    /// <summary>
+    /// Load and queueing time per pooled manager connection
+    /// </summary>
+    [HttpGet("pool")]
+    public async Task<ActionResult<ApiResponse<PoolStatus>>> GetPoolStatus()
+    {
+        if (!_mt4Service.IsConnected)
+        {
+            return BadRequest(ApiResponse<PoolStatus>.ErrorResult("Not connected to MT4 server"));
+        }
+
+        var status = await _mt4Service.GetPoolStatusAsync();
+        if (!status.Success)
+        {
+            return BadRequest(ApiResponse<PoolStatus>.ErrorResult(status.Error!));
+        }
+
+        return Ok(ApiResponse<PoolStatus>.SuccessResult(status.Value!));
+    }
+
+    /// <summary>
+    /// Load and queueing time per dealing connection
+    /// </summary>
+    [HttpGet("pool/dealing")]
+    public async Task<ActionResult<ApiResponse<PoolStatus>>> GetDealingStatus()
+    {
+        if (!_mt4Service.IsConnected)
+        {
+            return BadRequest(ApiResponse<PoolStatus>.ErrorResult("Not connected to MT4 server"));
+        }
+
+        var status = await _mt4Service.GetDealingStatusAsync();
+        if (!status.Success)
+        {
+            return BadRequest(ApiResponse<PoolStatus>.ErrorResult(status.Error!));
+        }
+
+        return Ok(ApiResponse<PoolStatus>.SuccessResult(status.Value!));
+    }
 }
\ No newline at end of file
@@ -0,0 +1,41 @@
+using Microsoft.AspNetCore.Mvc;
+using MT4RestApi.Models;
+using MT4RestApi.Services;
+
+namespace MT4RestApi.Controllers;
+
+[ApiController]
+[Route("api/groups")]
+public class GroupsController : ControllerBase
+{
+    private readonly IMT4ManagerService _mt4Service;
+    private readonly ILogger<GroupsController> _logger;
+
+    public GroupsController(IMT4ManagerService mt4Service, ILogger<GroupsController> logger)
+    {
+        _mt4Service = mt4Service;
+        _logger = logger;
+    }
+
+    /// <summary>
+    /// Group settings (leverage, currency, margin call and stop out levels) from
+    /// the wrapper's group cache
+    /// </summary>
+    [HttpGet]
+    public async Task<IActionResult> GetGroups([FromQuery] string? fields = null)
+    {
+        if (!_mt4Service.IsConnected)
+        {
+            return BadRequest(ApiResponse<object>.ErrorResult("Not connected to MT4 server"));
+        }
+
+        _logger.LogInformation("Retrieving groups");
+
+        var json = await _mt4Service.GetGroupsJsonAsync(fields);
+        if (!json.Success)
+        {
+            return BadRequest(ApiResponse<object>.ErrorResult(json.Error!));
+        }
+        return Ok(ApiResponse<RawJson>.SuccessResult(new RawJson(json.Value!)));
+    }
+}
@@ -143,9 +143,9 @@ public class LayerController : ControllerBase
 
             return Ok(new ApiResponse<bool>
             {
-                Success = result,
-                Message = result ? "Trade closed successfully" : "Failed to close trade",
-                Data = result
+                Success = result.Success,
+                Message = result.Success ? "Trade closed successfully" : $"Failed to close trade: {result.Error}",
+                Data = result.Success
             });
         }
         catch (Exception ex)
@@ -211,12 +211,20 @@ public class LayerController : ControllerBase
         try
         {
             var symbols = await _mt4Service.GetSymbolsAsync();
+            if (!symbols.Success)
+            {
+                return Ok(new ApiResponse<object>
+                {
+                    Success = false,
+                    Message = $"Failed to get symbols: {symbols.Error}"
+                });
+            }
 
             return Ok(new ApiResponse<List<SymbolInfo>>
             {
                 Success = true,
-                Message = $"Found {symbols.Count} symbols",
-                Data = symbols
+                Message = $"Found {symbols.Value!.Count} symbols",
+                Data = symbols.Value
             });
         }
         catch (Exception ex)
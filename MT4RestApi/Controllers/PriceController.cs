@@ -47,7 +47,7 @@ public class PriceController : ControllerBase
 
             if (_mt4Service.IsConnected)
             {
-                quote = await _mt4Service.GetQuoteAsync(symbol);
+                quote = (await _mt4Service.GetQuoteAsync(symbol)).Value;
                 if (quote != null)
                 {
                     quote.CleanSymbol();
@@ -147,7 +147,7 @@ public class PriceController : ControllerBase
             _logger.LogInformation("Attempting MT4 fallback for {Count} symbols", notFoundSymbols.Count);
             foreach (var symbol in notFoundSymbols)
             {
-                var quote = await _mt4Service.GetQuoteAsync(symbol);
+                var quote = (await _mt4Service.GetQuoteAsync(symbol)).Value;
                 if (quote != null)
                 {
                     quote.CleanSymbol();
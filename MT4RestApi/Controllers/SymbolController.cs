@@ -31,12 +31,16 @@ public class SymbolController : ControllerBase
         _logger.LogInformation("Retrieving symbol list");
 
         var symbols = await _mt4Service.GetSymbolsAsync();
+        if (!symbols.Success)
+        {
+            return BadRequest(ApiResponse<List<SymbolInfo>>.ErrorResult(symbols.Error!));
+        }
 
         return Ok(new ApiResponse<List<SymbolInfo>>
         {
             Success = true,
-            Message = $"Found {symbols.Count} symbols",
-            Data = symbols
+            Message = $"Found {symbols.Value!.Count} symbols",
+            Data = symbols.Value
         });
     }
 
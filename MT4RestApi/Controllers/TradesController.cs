@@ -21,17 +21,35 @@ public class TradesController : ControllerBase
     /// Get all trades from MT4 server
     /// </summary>
     [HttpGet]
-    public async Task<ActionResult<ApiResponse<List<TradeRecord>>>> GetTrades([FromQuery] bool openOnly = false)
+    public async Task<ActionResult<ApiResponse<List<TradeRecord>>>> GetTrades([FromQuery] bool openOnly = false, [FromQuery] string? fields = null)
     {
         if (!_mt4Service.IsConnected)
         {
             return BadRequest(ApiResponse<List<TradeRecord>>.ErrorResult("Not connected to MT4 server"));
         }
 
+        if (!string.IsNullOrWhiteSpace(fields) && !openOnly)
+        {
+            // Projected list: the wrapper emits only the requested columns.
+            // openOnly filters on full records, so it stays on the typed path.
+            _logger.LogInformation("Retrieving trades (fields: {Fields})", fields);
+
+            var json = await _mt4Service.GetTradesJsonAsync(0, fields);
+            if (!json.Success)
+            {
+                return BadRequest(ApiResponse<List<TradeRecord>>.ErrorResult(json.Error!));
+            }
+            return Ok(ApiResponse<RawJson>.SuccessResult(new RawJson(json.Value!)));
+        }
+
         _logger.LogInformation("Retrieving trades (openOnly: {OpenOnly})", openOnly);
         
         var trades = await _mt4Service.GetTradesAsync(0, openOnly);
-        return Ok(ApiResponse<List<TradeRecord>>.SuccessResult(trades));
+        if (!trades.Success)
+        {
+            return BadRequest(ApiResponse<List<TradeRecord>>.ErrorResult(trades.Error!));
+        }
+        return Ok(ApiResponse<List<TradeRecord>>.SuccessResult(trades.Value!));
     }
 
     /// <summary>
@@ -48,7 +66,81 @@ public class TradesController : ControllerBase
         _logger.LogInformation("Retrieving trades for user: {Login} (openOnly: {OpenOnly})", login, openOnly);
         
         var trades = await _mt4Service.GetTradesAsync(login, openOnly);
-        return Ok(ApiResponse<List<TradeRecord>>.SuccessResult(trades));
+        if (!trades.Success)
+        {
+            return BadRequest(ApiResponse<List<TradeRecord>>.ErrorResult(trades.Error!));
+        }
+        return Ok(ApiResponse<List<TradeRecord>>.SuccessResult(trades.Value!));
+    }
+
+    /// <summary>
+    /// Open trades added, modified or removed since a version from a previous call
+    /// (0 for a full snapshot). The response carries the version to send next time.
+    /// </summary>
+    [HttpGet("changes")]
+    public async Task<IActionResult> GetTradeChanges([FromQuery] ulong since = 0, [FromQuery] string? fields = null)
+    {
+        if (!_mt4Service.IsConnected)
+        {
+            return BadRequest(ApiResponse<object>.ErrorResult("Not connected to MT4 server"));
+        }
+
+        var json = await _mt4Service.GetTradesSinceJsonAsync(since, fields);
+        if (!json.Success)
+        {
+            return BadRequest(ApiResponse<object>.ErrorResult(json.Error!));
+        }
+        return Ok(ApiResponse<RawJson>.SuccessResult(new RawJson(json.Value!)));
+    }
+
+    /// <summary>
+    /// Net open volume, notional and floating profit per symbol, across all groups
+    /// or for one group
+    /// </summary>
+    [HttpGet("exposure")]
+    public async Task<ActionResult<ApiResponse<List<ExposureInfo>>>> GetExposure([FromQuery] string? group = null)
+    {
+        if (!_mt4Service.IsConnected)
+        {
+            return BadRequest(ApiResponse<List<ExposureInfo>>.ErrorResult("Not connected to MT4 server"));
+        }
+
+        _logger.LogInformation("Retrieving exposure for group: {Group}", group ?? "all groups");
+
+        var exposure = await _mt4Service.GetExposureAsync(string.IsNullOrEmpty(group) ? null : group);
+        if (!exposure.Success)
+        {
+            return BadRequest(ApiResponse<List<ExposureInfo>>.ErrorResult(exposure.Error!));
+        }
+        return Ok(ApiResponse<List<ExposureInfo>>.SuccessResult(exposure.Value!));
+    }
+
+    /// <summary>
+    /// Stream all trades (or one user's) as a raw JSON array, chunk by chunk
+    /// </summary>
+    [HttpGet("stream")]
+    public async Task StreamTrades([FromQuery] int login = 0, CancellationToken cancellationToken = default)
+    {
+        if (!_mt4Service.IsConnected)
+        {
+            Response.StatusCode = StatusCodes.Status400BadRequest;
+            await Response.WriteAsJsonAsync(ApiResponse<object>.ErrorResult("Not connected to MT4 server"), cancellationToken);
+            return;
+        }
+
+        _logger.LogInformation("Streaming trades for login: {Login}", login == 0 ? "all users" : login.ToString());
+
+        Response.ContentType = "application/json";
+        try
+        {
+            await _mt4Service.StreamTradesAsync(login, Response.Body, cancellationToken);
+        }
+        catch (Exception ex) when (ex is IOException or InvalidOperationException)
+        {
+            // Headers are already sent; abort so the client sees a truncated response
+            _logger.LogError(ex, "Trade stream failed for login {Login}", login);
+            HttpContext.Abort();
+        }
     }
 
     /// <summary>
@@ -65,12 +157,12 @@ public class TradesController : ControllerBase
         _logger.LogInformation("Retrieving trade: {Order}", order);
         
         var trade = await _mt4Service.GetTradeAsync(order);
-        if (trade == null)
+        if (!trade.Success)
         {
-            return NotFound(ApiResponse<TradeRecord>.ErrorResult("Trade not found"));
+            return NotFound(ApiResponse<TradeRecord>.ErrorResult(trade.Error!));
         }
 
-        return Ok(ApiResponse<TradeRecord>.SuccessResult(trade));
+        return Ok(ApiResponse<TradeRecord>.SuccessResult(trade.Value!));
     }
 
     /// <summary>
@@ -122,7 +214,7 @@ public class TradesController : ControllerBase
 
         var result = await _mt4Service.CloseTradeAsync(order);
 
-        if (result)
+        if (result.Success)
         {
             return Ok(new ApiResponse<bool>
             {
@@ -135,7 +227,7 @@ public class TradesController : ControllerBase
         return BadRequest(new ApiResponse<bool>
         {
             Success = false,
-            Message = _mt4Service.GetLastError(),
+            Message = result.Error,
             Data = false
         });
     }
@@ -21,17 +21,54 @@ public class UsersController : ControllerBase
     /// Get all users from MT4 server
     /// </summary>
     [HttpGet]
-    public async Task<ActionResult<ApiResponse<List<UserRecord>>>> GetUsers()
+    public async Task<ActionResult<ApiResponse<List<UserRecord>>>> GetUsers([FromQuery] string? fields = null)
     {
         if (!_mt4Service.IsConnected)
         {
             return BadRequest(ApiResponse<List<UserRecord>>.ErrorResult("Not connected to MT4 server"));
         }
 
+        if (!string.IsNullOrWhiteSpace(fields))
+        {
+            // Projected list: the wrapper emits only the requested columns
+            _logger.LogInformation("Retrieving all users (fields: {Fields})", fields);
+
+            var json = await _mt4Service.GetUsersJsonAsync(fields);
+            if (!json.Success)
+            {
+                return BadRequest(ApiResponse<List<UserRecord>>.ErrorResult(json.Error!));
+            }
+            return Ok(ApiResponse<RawJson>.SuccessResult(new RawJson(json.Value!)));
+        }
+
         _logger.LogInformation("Retrieving all users");
         
         var users = await _mt4Service.GetUsersAsync();
-        return Ok(ApiResponse<List<UserRecord>>.SuccessResult(users));
+        if (!users.Success)
+        {
+            return BadRequest(ApiResponse<List<UserRecord>>.ErrorResult(users.Error!));
+        }
+        return Ok(ApiResponse<List<UserRecord>>.SuccessResult(users.Value!));
+    }
+
+    /// <summary>
+    /// Users added, modified or removed since a version from a previous call
+    /// (0 for a full snapshot). The response carries the version to send next time.
+    /// </summary>
+    [HttpGet("changes")]
+    public async Task<IActionResult> GetUserChanges([FromQuery] ulong since = 0, [FromQuery] string? fields = null)
+    {
+        if (!_mt4Service.IsConnected)
+        {
+            return BadRequest(ApiResponse<object>.ErrorResult("Not connected to MT4 server"));
+        }
+
+        var json = await _mt4Service.GetUsersSinceJsonAsync(since, fields);
+        if (!json.Success)
+        {
+            return BadRequest(ApiResponse<object>.ErrorResult(json.Error!));
+        }
+        return Ok(ApiResponse<RawJson>.SuccessResult(new RawJson(json.Value!)));
     }
 
     /// <summary>
@@ -48,12 +85,12 @@ public class UsersController : ControllerBase
         _logger.LogInformation("Retrieving user: {Login}", login);
         
         var user = await _mt4Service.GetUserAsync(login);
-        if (user == null)
+        if (!user.Success)
         {
-            return NotFound(ApiResponse<UserRecord>.ErrorResult("User not found"));
+            return NotFound(ApiResponse<UserRecord>.ErrorResult(user.Error!));
         }
 
-        return Ok(ApiResponse<UserRecord>.SuccessResult(user));
+        return Ok(ApiResponse<UserRecord>.SuccessResult(user.Value!));
     }
 
     /// <summary>
@@ -75,14 +112,47 @@ public class UsersController : ControllerBase
 
         _logger.LogInformation("Creating user: {Login}", user.Login);
         
-        var success = await _mt4Service.CreateUserAsync(user);
-        if (success)
+        var result = await _mt4Service.CreateUserAsync(user);
+        if (result.Success)
         {
             return Ok(ApiResponse.SuccessResult());
         }
 
-        var error = _mt4Service.GetLastError();
-        return BadRequest(ApiResponse.ErrorResult(error));
+        return BadRequest(ApiResponse.ErrorResult(result.Error!));
+    }
+
+    /// <summary>
+    /// Create many users in one wrapper call; results are per record, in order
+    /// </summary>
+    [HttpPost("batch")]
+    [ApiExplorerSettings(IgnoreApi = true)]  // Hide from Swagger
+    public async Task<ActionResult<ApiResponse<CreateUsersResult>>> CreateUsers([FromBody] List<UserRecord> users)
+    {
+        if (!_mt4Service.IsConnected)
+        {
+            return BadRequest(ApiResponse<CreateUsersResult>.ErrorResult("Not connected to MT4 server"));
+        }
+
+        if (users.Count == 0 || users.Any(u => u.Login <= 0))
+        {
+            return BadRequest(ApiResponse<CreateUsersResult>.ErrorResult("Valid login is required for every user"));
+        }
+
+        _logger.LogInformation("Creating {Count} users", users.Count);
+
+        var result = await _mt4Service.CreateUsersAsync(users);
+        if (result.Success)
+        {
+            return Ok(ApiResponse<CreateUsersResult>.SuccessResult(result));
+        }
+
+        // Results carries the per-user codes when only some were created
+        return BadRequest(new ApiResponse<CreateUsersResult>
+        {
+            Success = false,
+            Message = result.Message,
+            Data = result
+        });
     }
 
     /// <summary>
@@ -102,14 +172,13 @@ public class UsersController : ControllerBase
 
         _logger.LogInformation("Updating user: {Login}", login);
         
-        var success = await _mt4Service.UpdateUserAsync(user);
-        if (success)
+        var result = await _mt4Service.UpdateUserAsync(user);
+        if (result.Success)
         {
             return Ok(ApiResponse.SuccessResult());
         }
 
-        var error = _mt4Service.GetLastError();
-        return BadRequest(ApiResponse.ErrorResult(error));
+        return BadRequest(ApiResponse.ErrorResult(result.Error!));
     }
 
     /// <summary>
@@ -126,14 +195,13 @@ public class UsersController : ControllerBase
 
         _logger.LogInformation("Deleting user: {Login}", login);
         
-        var success = await _mt4Service.DeleteUserAsync(login);
-        if (success)
+        var result = await _mt4Service.DeleteUserAsync(login);
+        if (result.Success)
         {
             return Ok(ApiResponse.SuccessResult());
         }
 
-        var error = _mt4Service.GetLastError();
-        return BadRequest(ApiResponse.ErrorResult(error));
+        return BadRequest(ApiResponse.ErrorResult(result.Error!));
     }
 
     /// <summary>
@@ -150,6 +218,10 @@ public class UsersController : ControllerBase
         _logger.LogInformation("Retrieving balance for user: {Login}", login);
         
         var balanceInfo = await _mt4Service.GetBalanceInfoAsync(login);
-        return Ok(ApiResponse<BalanceInfo>.SuccessResult(balanceInfo));
+        if (!balanceInfo.Success)
+        {
+            return BadRequest(ApiResponse<BalanceInfo>.ErrorResult(balanceInfo.Error!));
+        }
+        return Ok(ApiResponse<BalanceInfo>.SuccessResult(balanceInfo.Value!));
     }
 }
\ No newline at end of file
@@ -1,3 +1,8 @@
+using System.Runtime.InteropServices;
+using System.Text.Json;
+using System.Text.Json.Serialization;
+using MT4RestApi.Native;
+
 namespace MT4RestApi.Models;
 
 public class ApiResponse<T>
@@ -31,6 +36,44 @@ public class ApiResponse : ApiResponse<object>
     }
 }
 
+/// <summary>
+/// What a service call returned, or why it failed. Each call carries its own
+/// error, so concurrent requests never report each other's failures.
+/// </summary>
+public readonly record struct ServiceResult<T>(T? Value, string? Error)
+{
+    public bool Success => Error == null;
+
+    public static ServiceResult<T> Ok(T value) => new(value, null);
+
+    public static ServiceResult<T> Fail(string error) => new(default, error);
+}
+
+/// <summary>
+/// JSON the wrapper already produced, written into a response as-is
+/// </summary>
+[JsonConverter(typeof(RawJsonConverter))]
+public readonly record struct RawJson(string Json);
+
+public class RawJsonConverter : JsonConverter<RawJson>
+{
+    public override RawJson Read(ref Utf8JsonReader reader, Type typeToConvert, JsonSerializerOptions options)
+    {
+        using var document = JsonDocument.ParseValue(ref reader);
+        return new RawJson(document.RootElement.GetRawText());
+    }
+
+    public override void Write(Utf8JsonWriter writer, RawJson value, JsonSerializerOptions options)
+    {
+        if (value.Json == null)
+        {
+            writer.WriteNullValue();
+            return;
+        }
+        writer.WriteRawValue(value.Json, skipInputValidation: true);
+    }
+}
+
 public class ConnectionRequest
 {
     public string Server { get; set; } = string.Empty;
@@ -42,11 +85,161 @@ public class LoginRequest
     public string Password { get; set; } = string.Empty;
 }
 
+/// <summary>
+/// Blittable mirror of MT4AccountState in MT4Wrapper.h
+/// </summary>
+[StructLayout(LayoutKind.Sequential)]
+public unsafe struct MT4AccountState
+{
+    public double balance;
+    public double credit;
+    public double equity;
+    public double profit;
+    public double margin;
+    public double margin_free;
+    public double margin_level;
+    public int login;
+    public int leverage;
+    public int positions;
+    public int level;
+    public fixed byte group[16];
+}
+
+/// <summary>
+/// Blittable mirror of MT4MarginEvent in MT4Wrapper.h
+/// </summary>
+[StructLayout(LayoutKind.Sequential)]
+public struct MT4MarginEvent
+{
+    public double balance;
+    public double equity;
+    public double margin;
+    public double margin_level;
+    public int login;
+    public int level;
+    public int previous_level;
+    public int positions;
+}
+
+/// <summary>
+/// An account whose margin level crossed its group's margin call or stop out
+/// threshold, in either direction
+/// </summary>
+public class MarginLevelChange
+{
+    public int Login { get; set; }
+    public int Level { get; set; }           // 0 = ok, 1 = margin call, 2 = stop out
+    public int PreviousLevel { get; set; }
+    public double Balance { get; set; }
+    public double Equity { get; set; }
+    public double Margin { get; set; }
+    public double MarginLevel { get; set; }
+    public int Positions { get; set; }
+
+    public static MarginLevelChange FromEvent(in MT4MarginEvent data) => new MarginLevelChange
+    {
+        Login = data.login,
+        Level = data.level,
+        PreviousLevel = data.previous_level,
+        Balance = data.balance,
+        Equity = data.equity,
+        Margin = data.margin,
+        MarginLevel = data.margin_level,
+        Positions = data.positions
+    };
+}
+
+/// <summary>
+/// Blittable mirror of MT4PoolStats in MT4Wrapper.h
+/// </summary>
+[StructLayout(LayoutKind.Sequential)]
+public struct MT4PoolStats
+{
+    public long calls;
+    public long wait_us_total;
+    public long wait_us_max;
+    public int index;
+    public int in_flight;
+    public int max_in_flight;
+    public int acquire_timeout_ms;
+}
+
+/// <summary>
+/// Mirror of MT4Completion in MT4Wrapper.h: one finished request-queue call
+/// </summary>
+[StructLayout(LayoutKind.Sequential)]
+public struct MT4Completion
+{
+    public long request;
+    public long tag;
+    public IntPtr data;      // UTF-8, owned by the wrapper
+    public int result;
+    public int length;
+}
+
+/// <summary>
+/// One pooled manager connection: load and how long calls queued for it
+/// </summary>
+public class PoolConnectionInfo
+{
+    public int Index { get; set; }
+    public long Calls { get; set; }
+    public int InFlight { get; set; }
+    public int MaxInFlight { get; set; }
+    public double AverageWaitMs { get; set; }
+    public double MaxWaitMs { get; set; }
+    public int AcquireTimeoutMs { get; set; }
+
+    public static PoolConnectionInfo FromStats(in MT4PoolStats data) => new PoolConnectionInfo
+    {
+        Index = data.index,
+        Calls = data.calls,
+        InFlight = data.in_flight,
+        MaxInFlight = data.max_in_flight,
+        AverageWaitMs = data.calls > 0 ? data.wait_us_total / 1000.0 / data.calls : 0,
+        MaxWaitMs = data.wait_us_max / 1000.0,
+        AcquireTimeoutMs = data.acquire_timeout_ms
+    };
+}
+
+public class PoolStatus
+{
+    public List<PoolConnectionInfo> Connections { get; set; } = new();
+    public long Rejected { get; set; }       // calls refused with every connection busy
+}
+
 public class BalanceInfo
 {
     public int Login { get; set; }
+    public string Group { get; set; } = string.Empty;
+    public int Leverage { get; set; }
     public double Balance { get; set; }
+    public double Credit { get; set; }
     public double Equity { get; set; }
+    public double Profit { get; set; }
     public double Margin { get; set; }
     public double FreeMargin { get; set; }
+    public double MarginLevel { get; set; }
+    public int Level { get; set; }   // 0 = ok, 1 = margin call, 2 = stop out
+
+    public static unsafe BalanceInfo FromState(in MT4AccountState state)
+    {
+        fixed (byte* group = state.group)
+        {
+            return new BalanceInfo
+            {
+                Login = state.login,
+                Group = MT4WrapperApi.FixedString(group, 16),
+                Leverage = state.leverage,
+                Balance = state.balance,
+                Credit = state.credit,
+                Equity = state.equity,
+                Profit = state.profit,
+                Margin = state.margin,
+                FreeMargin = state.margin_free,
+                MarginLevel = state.margin_level,
+                Level = state.level
+            };
+        }
+    }
 }
\ No newline at end of file
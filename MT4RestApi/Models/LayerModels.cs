@@ -1,4 +1,6 @@
+using System.Runtime.InteropServices;
 using System.Text.Json;
+using MT4RestApi.Native;
 
 namespace MT4RestApi.Models;
 
@@ -40,6 +42,39 @@ public class CloseAllTradesRequest
     public int Login { get; set; } // Optional - 0 means all users
 }
 
+/// <summary>
+/// Blittable mirror of MT4SymbolData in MT4Wrapper.h
+/// </summary>
+[StructLayout(LayoutKind.Sequential)]
+public unsafe struct MT4SymbolData
+{
+    public double contract_size;
+    public double tick_value;
+    public double tick_size;
+    public double point;
+    public double margin_initial;
+    public double margin_maintenance;
+    public double margin_hedged;
+    public double margin_divider;
+    public double swap_long;
+    public double swap_short;
+    public int type;
+    public int digits;
+    public int trade;
+    public int spread;
+    public int stops_level;
+    public int freeze_level;
+    public int margin_mode;
+    public int profit_mode;
+    public int swap_type;
+    public int exemode;
+    public int long_only;
+    public fixed byte symbol[12];
+    public fixed byte description[64];
+    public fixed byte currency[12];
+    public fixed byte margin_currency[12];
+}
+
 public class SymbolInfo
 {
     public string Symbol { get; set; } = string.Empty;
@@ -63,4 +98,22 @@ public class SymbolInfo
             Symbol = Symbol.Substring(0, Symbol.Length - 2);
         }
     }
+
+    public static unsafe SymbolInfo FromData(in MT4SymbolData data)
+    {
+        fixed (byte* symbol = data.symbol)
+        fixed (byte* description = data.description)
+        {
+            var symbolInfo = new SymbolInfo
+            {
+                Symbol = MT4WrapperApi.FixedString(symbol, 12),
+                Description = MT4WrapperApi.FixedString(description, 64),
+                Spread = data.spread,
+                Digits = data.digits,
+                ContractSize = data.contract_size
+            };
+            symbolInfo.CleanSymbol();
+            return symbolInfo;
+        }
+    }
 }
\ No newline at end of file
@@ -1,5 +1,27 @@
+using System.Runtime.InteropServices;
+using MT4RestApi.Native;
+
 namespace MT4RestApi.Models;
 
+/// <summary>
+/// Blittable mirror of MT4QuoteData in MT4Wrapper.h
+/// </summary>
+[StructLayout(LayoutKind.Sequential)]
+public unsafe struct MT4QuoteData
+{
+    public double bid;
+    public double ask;
+    public double high;
+    public double low;
+    public double point;
+    public int digits;
+    public int spread;
+    public int direction;
+    public int type;
+    public int time;
+    public fixed byte symbol[12];
+}
+
 public class PriceQuote
 {
     public string Symbol { get; set; } = string.Empty;
@@ -22,6 +44,26 @@ public class PriceQuote
             Symbol = Symbol.Substring(0, Symbol.Length - 2);
         }
     }
+
+    public static unsafe PriceQuote FromData(in MT4QuoteData data)
+    {
+        fixed (byte* symbol = data.symbol)
+        {
+            var quote = new PriceQuote
+            {
+                Symbol = MT4WrapperApi.FixedString(symbol, 12),
+                Bid = data.bid,
+                Ask = data.ask,
+                Spread = data.spread,
+                Digits = data.digits,
+                High = data.high,
+                Low = data.low,
+                Timestamp = DateTimeOffset.FromUnixTimeSeconds(data.time).UtcDateTime
+            };
+            quote.CleanSymbol();
+            return quote;
+        }
+    }
 }
 
 public class PriceRequest
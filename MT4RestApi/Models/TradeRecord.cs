@@ -1,7 +1,34 @@
 using System.Runtime.InteropServices;
+using MT4RestApi.Native;
 
 namespace MT4RestApi.Models;
 
+/// <summary>
+/// Blittable mirror of MT4TradeData in MT4Wrapper.h
+/// </summary>
+[StructLayout(LayoutKind.Sequential)]
+public unsafe struct MT4TradeData
+{
+    public double open_price;
+    public double close_price;
+    public double sl;
+    public double tp;
+    public double commission;
+    public double storage;
+    public double profit;
+    public int order;
+    public int login;
+    public int cmd;
+    public int volume;
+    public int digits;
+    public int open_time;
+    public int close_time;
+    public int expiration;
+    public int magic;
+    public fixed byte symbol[12];
+    public fixed byte comment[32];
+}
+
 [StructLayout(LayoutKind.Sequential, CharSet = CharSet.Ansi)]
 public struct TradeRecordNative
 {
@@ -94,4 +121,87 @@ public class TradeRecord
         trade.CleanSymbol();
         return trade;
     }
-}
\ No newline at end of file
+
+    public static unsafe TradeRecord FromData(in MT4TradeData data)
+    {
+        fixed (byte* symbol = data.symbol)
+        fixed (byte* comment = data.comment)
+        {
+            var trade = new TradeRecord
+            {
+                Order = data.order,
+                Login = data.login,
+                Symbol = MT4WrapperApi.FixedString(symbol, 12),
+                Digits = data.digits,
+                Cmd = data.cmd,
+                Volume = data.volume,
+                OpenTime = DateTimeOffset.FromUnixTimeSeconds(data.open_time).DateTime,
+                OpenPrice = data.open_price,
+                StopLoss = data.sl,
+                TakeProfit = data.tp,
+                CloseTime = data.close_time > 0 ? DateTimeOffset.FromUnixTimeSeconds(data.close_time).DateTime : DateTime.MinValue,
+                ClosePrice = data.close_price,
+                Commission = data.commission,
+                Storage = data.storage,
+                Profit = data.profit,
+                Magic = data.magic,
+                Comment = MT4WrapperApi.FixedString(comment, 32)
+            };
+            trade.CleanSymbol();
+            return trade;
+        }
+    }
+}
+
+/// <summary>
+/// Blittable mirror of MT4ExposureData in MT4Wrapper.h
+/// </summary>
+[StructLayout(LayoutKind.Sequential)]
+public unsafe struct MT4ExposureData
+{
+    public double buy_volume;
+    public double sell_volume;
+    public double net_volume;
+    public double buy_notional;
+    public double sell_notional;
+    public double profit;
+    public int positions;
+    public fixed byte symbol[12];
+    public fixed byte group[16];
+}
+
+/// <summary>
+/// Net exposure in one symbol, overall or within one group
+/// </summary>
+public class ExposureInfo
+{
+    public string Symbol { get; set; } = string.Empty;
+    public string Group { get; set; } = string.Empty;
+    public double BuyVolume { get; set; }
+    public double SellVolume { get; set; }
+    public double NetVolume { get; set; }
+    public double BuyNotional { get; set; }
+    public double SellNotional { get; set; }
+    public double Profit { get; set; }
+    public int Positions { get; set; }
+
+    public static unsafe ExposureInfo FromData(in MT4ExposureData data)
+    {
+        fixed (byte* symbol = data.symbol)
+        fixed (byte* group = data.group)
+        {
+            return new ExposureInfo
+            {
+                Symbol = MT4WrapperApi.FixedString(symbol, 12),
+                Group = MT4WrapperApi.FixedString(group, 16),
+                BuyVolume = data.buy_volume,
+                SellVolume = data.sell_volume,
+                NetVolume = data.net_volume,
+                BuyNotional = data.buy_notional,
+                SellNotional = data.sell_notional,
+                Profit = data.profit,
+                Positions = data.positions
+            };
+        }
+    }
+}
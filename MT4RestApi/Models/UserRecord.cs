@@ -1,8 +1,49 @@
 using System.Runtime.InteropServices;
 using System.Text.Json.Serialization;
+using MT4RestApi.Native;
 
 namespace MT4RestApi.Models;
 
+/// <summary>
+/// Blittable mirror of MT4UserData in MT4Wrapper.h
+/// </summary>
+[StructLayout(LayoutKind.Sequential)]
+public unsafe struct MT4UserData
+{
+    public double balance;
+    public double credit;
+    public double prevbalance;
+    public double prevmonthbalance;
+    public double prevequity;
+    public double prevmonthequity;
+    public int login;
+    public int leverage;
+    public int enable;
+    public int enable_read_only;
+    public int agent_account;
+    public int regdate;
+    public int lastdate;
+    public int timestamp;
+    public fixed byte group[16];
+    public fixed byte name[128];
+    public fixed byte email[48];
+    public fixed byte country[32];
+    public fixed byte city[32];
+    public fixed byte phone[32];
+    public fixed byte status[16];
+    public fixed byte comment[64];
+}
+
+/// <summary>
+/// Per-record result of MT4_CreateUsersBatch (mirrors MT4CreateUserResult)
+/// </summary>
+[StructLayout(LayoutKind.Sequential)]
+public struct MT4CreateUserResult
+{
+    public int login;
+    public int code;
+}
+
 [StructLayout(LayoutKind.Sequential, CharSet = CharSet.Ansi)]
 public struct UserRecordNative
 {
@@ -116,4 +157,47 @@ public class UserRecord
             LastDate = DateTimeOffset.FromUnixTimeSeconds(native.lastdate).DateTime
         };
     }
-}
\ No newline at end of file
+
+    public static unsafe UserRecord FromData(in MT4UserData data)
+    {
+        fixed (byte* group = data.group)
+        fixed (byte* name = data.name)
+        fixed (byte* email = data.email)
+        fixed (byte* country = data.country)
+        fixed (byte* city = data.city)
+        fixed (byte* phone = data.phone)
+        {
+            return new UserRecord
+            {
+                Login = data.login,
+                Group = MT4WrapperApi.FixedString(group, 16),
+                Name = MT4WrapperApi.FixedString(name, 128),
+                Email = MT4WrapperApi.FixedString(email, 48),
+                Country = MT4WrapperApi.FixedString(country, 32),
+                City = MT4WrapperApi.FixedString(city, 32),
+                Phone = MT4WrapperApi.FixedString(phone, 32),
+                Balance = data.balance,
+                Credit = data.credit,
+                Leverage = data.leverage,
+                Enable = data.enable != 0,
+                RegDate = DateTimeOffset.FromUnixTimeSeconds(data.regdate).DateTime,
+                LastDate = DateTimeOffset.FromUnixTimeSeconds(data.lastdate).DateTime
+            };
+        }
+    }
+}
+
+public class CreateUserResult
+{
+    public int Login { get; set; }
+    // 0 created, > 0 MT4 server RET_* code, < 0 wrapper error (-6 bad record, -8 not attempted)
+    public int Code { get; set; }
+}
+
+public class CreateUsersResult
+{
+    public bool Success { get; set; }
+    public int CreatedCount { get; set; }
+    public List<CreateUserResult> Results { get; set; } = new List<CreateUserResult>();
+    public string Message { get; set; } = string.Empty;
+}
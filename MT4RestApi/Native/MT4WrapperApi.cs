@@ -1,4 +1,6 @@
 using System.Runtime.InteropServices;
+using System.Text;
+using MT4RestApi.Models;
 
 namespace MT4RestApi.Native;
 
@@ -15,8 +17,23 @@ public static class MT4WrapperApi
     public const int MT4_ERROR_NOT_CONNECTED = -5;
     public const int MT4_ERROR_INVALID_PARAMETER = -6;
     public const int MT4_ERROR_BUFFER_TOO_SMALL = -7;
+    public const int MT4_ERROR_CANCELLED = -8;
+    public const int MT4_ERROR_BUSY = -9;
+    public const int MT4_ERROR_NO_PRICE = -10;
     public const int MT4_ERROR_INTERNAL = -99;
 
+    // Field projection for the JSON list exports
+    public const ulong MT4_FIELDS_ALL = ulong.MaxValue;
+    public const int MT4_RECORD_USER = 1;
+    public const int MT4_RECORD_TRADE = 2;
+    public const int MT4_RECORD_SYMBOL = 3;
+    public const int MT4_RECORD_GROUP = 4;
+
+    // Mirror states
+    public const int MT4_MIRROR_STOPPED = 0;
+    public const int MT4_MIRROR_STARTING = 1;
+    public const int MT4_MIRROR_READY = 2;
+
     [DllImport(DllName, CallingConvention = CallingConvention.Cdecl, EntryPoint = "MT4_Initialize")]
     public static extern int MT4_Initialize();
 
@@ -41,14 +58,40 @@ public static class MT4WrapperApi
     [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
     public static extern int MT4_Ping();
 
+    // Contexts: separate manager connections. Exports run on the calling thread's
+    // context (IntPtr.Zero = the default one), so bind before each call on a
+    // pooled thread.
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern IntPtr MT4_CreateContext();
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern int MT4_DestroyContext(IntPtr context);
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern int MT4_SetThreadContext(IntPtr context);
+
+    // Field projection for the JSON list exports
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+    public static extern int MT4_ParseFieldMask(int recordType, [MarshalAs(UnmanagedType.LPStr)] string fields, out ulong mask);
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern int MT4_EstimateJsonSize(int recordType, ulong fieldMask, out int estimatedSize);
+
     [DllImport(DllName, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
     public static extern int MT4_GetUserInfo(int login, [Out] byte[] buffer, int bufferSize);
 
     [DllImport(DllName, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
-    public static extern int MT4_GetAllUsers([Out] byte[] buffer, int bufferSize);
+    public static extern int MT4_GetAllUsers(ulong fieldMask, [Out] byte[]? buffer, int bufferSize, out int requiredSize);
 
     [DllImport(DllName, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
-    public static extern int MT4_GetTrades(int login, [Out] byte[] buffer, int bufferSize);
+    public static extern int MT4_GetTrades(int login, ulong fieldMask, [Out] byte[]? buffer, int bufferSize, out int requiredSize);
+
+    // Deltas since a version from a previous response; see MT4Wrapper.h for the document shape
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern int MT4_GetUsersSince(ulong version, ulong fieldMask, [Out] byte[]? buffer, int bufferSize, out int requiredSize);
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern int MT4_GetTradesSince(ulong version, ulong fieldMask, [Out] byte[]? buffer, int bufferSize, out int requiredSize);
 
     [DllImport(DllName, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
     public static extern int MT4_OpenTrade(int login, [MarshalAs(UnmanagedType.LPStr)] string symbol, int cmd, 
@@ -58,12 +101,29 @@ public static class MT4WrapperApi
     [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
     public static extern int MT4_CloseTrade(int order, double lots, double price);
 
+    // Closes count open trades in parallel across the dealing connections;
+    // prices may be null (current price). results[i] is MT4_SUCCESS, a server
+    // RET_* code (> 0), MT4_ERROR_INVALID_PARAMETER (not an open trade),
+    // MT4_ERROR_NO_PRICE (no current price), MT4_ERROR_NOT_CONNECTED /
+    // MT4_ERROR_BUSY / MT4_ERROR_NOT_INITIALIZED (no connection for the close),
+    // MT4_ERROR_INTERNAL (the close threw) or MT4_ERROR_CANCELLED (not
+    // attempted). Returns the number closed, or a negative code when nothing
+    // was attempted.
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern int MT4_CloseTradesBatch(int[] orders, int count, double[]? prices, [Out] int[] results);
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+    public static extern int MT4_GetSymbols(ulong fieldMask, [Out] byte[]? buffer, int bufferSize, out int requiredSize);
+
     [DllImport(DllName, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
-    public static extern int MT4_GetSymbols([Out] byte[] buffer, int bufferSize);
+    public static extern int MT4_GetGroups(ulong fieldMask, [Out] byte[]? buffer, int bufferSize, out int requiredSize);
 
     [DllImport(DllName, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
     public static extern int MT4_CreateUser([MarshalAs(UnmanagedType.LPStr)] string jsonData, [Out] byte[] buffer, int bufferSize);
 
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+    public static extern int MT4_CreateUsersBatch([MarshalAs(UnmanagedType.LPStr)] string jsonArray, int count, [Out] MT4CreateUserResult[] results);
+
     [DllImport(DllName, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
     public static extern int MT4_UpdateUser(int login, [MarshalAs(UnmanagedType.LPStr)] string jsonData);
 
@@ -73,6 +133,325 @@ public static class MT4WrapperApi
     [DllImport(DllName, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
     public static extern int MT4_GetQuote([MarshalAs(UnmanagedType.LPStr)] string symbol, [Out] byte[] buffer, int bufferSize);
 
+    // Binary exports: fill a blittable array, return the record count or an error code.
+    // On MT4_ERROR_BUFFER_TOO_SMALL, total holds the exact number of records needed.
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern unsafe int MT4_GetTradesBinary(int login, MT4TradeData* records, int maxRecords, out int total);
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern unsafe int MT4_GetUsersBinary(MT4UserData* records, int maxRecords, out int total);
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern unsafe int MT4_GetSymbolsBinary(MT4SymbolData* records, int maxRecords, out int total);
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern unsafe int MT4_GetQuotesBinary(MT4QuoteData* records, int maxRecords, out int total);
+
+    // Open trades by ticket, login or symbol, answered from the mirror's indexes
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern int MT4_GetTradeByOrder(int order, out MT4TradeData record);
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern unsafe int MT4_GetTradesByLogin(int login, MT4TradeData* records, int maxRecords, out int total);
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+    public static extern unsafe int MT4_GetTradesBySymbol([MarshalAs(UnmanagedType.LPStr)] string symbol, MT4TradeData* records, int maxRecords, out int total);
+
+    // Cursors: one server fetch, then pages of whole records as JSON arrays.
+    // Open returns a handle (> 0); CursorNext returns the records written, 0 when done.
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern int MT4_OpenUsersCursor(out int total);
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern int MT4_OpenTradesCursor(int login, out int total);
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern int MT4_CursorNext(int cursor, int maxRecords, [Out] byte[]? buffer, int bufferSize, out int requiredSize);
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern int MT4_CursorSeek(int cursor, int position);
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern int MT4_CursorClose(int cursor);
+
+    // Streaming: the wrapper calls back with consecutive chunks of one JSON array.
+    // Return 0 from the callback to continue, non-zero to cancel.
+    [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+    public delegate int ChunkCallback(IntPtr data, int length, IntPtr userContext);
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern int MT4_StreamTrades(int login, ChunkCallback callback, IntPtr userContext, int chunkBytes);
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern int MT4_StreamUsers(ChunkCallback callback, IntPtr userContext, int chunkBytes);
+
+    // Pumping mirror: a second connection that keeps users, open trades, symbols
+    // and groups in memory; list reads are served from it once READY.
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+    public static extern int MT4_StartMirror([MarshalAs(UnmanagedType.LPStr)] string server, int login, [MarshalAs(UnmanagedType.LPStr)] string password);
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern int MT4_StopMirror();
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern int MT4_GetMirrorState(out int users, out int trades, out int symbols, out int groups);
+
+    // Floating profit, margin and margin level of one login; kept current per
+    // tick by the mirror's margin engine, otherwise asked of the server
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern int MT4_GetAccountState(int login, out MT4AccountState state);
+
+    // Net volume, notional and profit per symbol, overall (group null) or for one group
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+    public static extern unsafe int MT4_GetExposure([MarshalAs(UnmanagedType.LPStr)] string? group, MT4ExposureData* records, int maxRecords, out int total);
+
+    // Accounts whose margin level crossed a threshold since the previous call (mirror only)
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern unsafe int MT4_ScanMarginLevels(MT4MarginEvent* records, int maxRecords, out int total);
+
+    // Connection pool: calls not bound to a context go to the least loaded connection
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+    public static extern int MT4_StartPool([MarshalAs(UnmanagedType.LPStr)] string server, int login,
+        [MarshalAs(UnmanagedType.LPStr)] string password, int size, int maxInFlight, int acquireTimeoutMs);
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern int MT4_StopPool();
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern unsafe int MT4_GetPoolStats(MT4PoolStats* records, int maxRecords, out int total, out long rejected);
+
+    // Dealing connections: reserved for MT4_OpenTrade / MT4_CloseTrade
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+    public static extern int MT4_StartDealing([MarshalAs(UnmanagedType.LPStr)] string server, int login,
+        [MarshalAs(UnmanagedType.LPStr)] string password, int size, int acquireTimeoutMs);
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern int MT4_StopDealing();
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern unsafe int MT4_GetDealingStats(MT4PoolStats* records, int maxRecords, out int total, out long rejected);
+
+    // Request queue: MT4_Submit* return a request id (> 0) at once; a wrapper worker
+    // runs the call and reports it to the completion callback (data is valid only
+    // during the callback) or, without one, to MT4_PollCompletions.
+    [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+    public delegate void CompletionCallback(in MT4Completion completion, IntPtr userContext);
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern int MT4_StartQueue(int workers, int maxQueued);
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern int MT4_StopQueue();
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern int MT4_SetCompletionCallback(CompletionCallback? callback, IntPtr userContext);
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern unsafe int MT4_PollCompletions(MT4Completion* records, int maxRecords, int timeoutMs);
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern int MT4_FreeCompletion(long request);
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern long MT4_SubmitGetUserInfo(long tag, int login);
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern long MT4_SubmitGetAllUsers(long tag, ulong fieldMask);
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern long MT4_SubmitGetTrades(long tag, int login, ulong fieldMask);
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern long MT4_SubmitGetSymbols(long tag, ulong fieldMask);
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern long MT4_SubmitGetGroups(long tag, ulong fieldMask);
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+    public static extern long MT4_SubmitGetQuote(long tag, [MarshalAs(UnmanagedType.LPStr)] string symbol);
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+    public static extern long MT4_SubmitOpenTrade(long tag, int login, [MarshalAs(UnmanagedType.LPStr)] string symbol,
+        int cmd, double volume, double price, double stoploss, double takeprofit,
+        [MarshalAs(UnmanagedType.LPStr)] string? comment);
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern long MT4_SubmitCloseTrade(long tag, int order, double lots, double price);
+
+    // The batches complete with {"created"|"closed":N,"error":"...","results":[...]}
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern long MT4_SubmitCloseTradesBatch(long tag, int[] orders, int count, double[]? prices);
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+    public static extern long MT4_SubmitCreateUser(long tag, [MarshalAs(UnmanagedType.LPStr)] string jsonData);
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+    public static extern long MT4_SubmitCreateUsersBatch(long tag, [MarshalAs(UnmanagedType.LPStr)] string jsonArray, int count);
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl, CharSet = CharSet.Ansi)]
+    public static extern long MT4_SubmitUpdateUser(long tag, int login, [MarshalAs(UnmanagedType.LPStr)] string jsonData);
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern long MT4_SubmitDeleteUser(long tag, int login);
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern long MT4_SubmitGetUsersSince(long tag, ulong version, ulong fieldMask);
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern long MT4_SubmitGetTradesSince(long tag, ulong version, ulong fieldMask);
+
+    // The binary reads complete with result records packed as in the binary exports
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern long MT4_SubmitGetTradesBinary(long tag, int login);
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern long MT4_SubmitGetTradesByLogin(long tag, int login);
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern long MT4_SubmitGetUsersBinary(long tag);
+
+    [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+    public static extern long MT4_SubmitGetSymbolsBinary(long tag);
+
+    public delegate int RecordReader<T>(Span<T> records, out int total) where T : unmanaged;
+
+    public static unsafe int GetTradesBinary(int login, Span<MT4TradeData> records, out int total)
+    {
+        fixed (MT4TradeData* ptr = records)
+        {
+            return MT4_GetTradesBinary(login, ptr, records.Length, out total);
+        }
+    }
+
+    public static unsafe int GetTradesByLogin(int login, Span<MT4TradeData> records, out int total)
+    {
+        fixed (MT4TradeData* ptr = records)
+        {
+            return MT4_GetTradesByLogin(login, ptr, records.Length, out total);
+        }
+    }
+
+    public static unsafe int GetTradesBySymbol(string symbol, Span<MT4TradeData> records, out int total)
+    {
+        fixed (MT4TradeData* ptr = records)
+        {
+            return MT4_GetTradesBySymbol(symbol, ptr, records.Length, out total);
+        }
+    }
+
+    public static unsafe int GetExposure(string? group, Span<MT4ExposureData> records, out int total)
+    {
+        fixed (MT4ExposureData* ptr = records)
+        {
+            return MT4_GetExposure(group, ptr, records.Length, out total);
+        }
+    }
+
+    public static unsafe int GetPoolStats(Span<MT4PoolStats> records, out int total, out long rejected)
+    {
+        fixed (MT4PoolStats* ptr = records)
+        {
+            return MT4_GetPoolStats(ptr, records.Length, out total, out rejected);
+        }
+    }
+
+    public static unsafe int GetDealingStats(Span<MT4PoolStats> records, out int total, out long rejected)
+    {
+        fixed (MT4PoolStats* ptr = records)
+        {
+            return MT4_GetDealingStats(ptr, records.Length, out total, out rejected);
+        }
+    }
+
+    public static unsafe int ScanMarginLevels(Span<MT4MarginEvent> records, out int total)
+    {
+        fixed (MT4MarginEvent* ptr = records)
+        {
+            return MT4_ScanMarginLevels(ptr, records.Length, out total);
+        }
+    }
+
+    public static unsafe int GetUsersBinary(Span<MT4UserData> records, out int total)
+    {
+        fixed (MT4UserData* ptr = records)
+        {
+            return MT4_GetUsersBinary(ptr, records.Length, out total);
+        }
+    }
+
+    public static unsafe int GetSymbolsBinary(Span<MT4SymbolData> records, out int total)
+    {
+        fixed (MT4SymbolData* ptr = records)
+        {
+            return MT4_GetSymbolsBinary(ptr, records.Length, out total);
+        }
+    }
+
+    public static unsafe int GetQuotesBinary(Span<MT4QuoteData> records, out int total)
+    {
+        fixed (MT4QuoteData* ptr = records)
+        {
+            return MT4_GetQuotesBinary(ptr, records.Length, out total);
+        }
+    }
+
+    /// <summary>
+    /// Reads every record from a binary export, retrying once with the exact size
+    /// the wrapper asked for. Returns the records, or an empty array on error.
+    /// </summary>
+    public static T[] ReadRecords<T>(RecordReader<T> reader, int initialCapacity, out int result) where T : unmanaged
+    {
+        var records = new T[initialCapacity];
+        result = reader(records, out int total);
+
+        // The set can grow between calls, so allow a couple of resizes
+        for (int attempt = 0; attempt < 3 && result == MT4_ERROR_BUFFER_TOO_SMALL; attempt++)
+        {
+            records = new T[Math.Max(total, records.Length * 2)];
+            result = reader(records, out total);
+        }
+
+        if (result < 0) return Array.Empty<T>();
+        return result == records.Length ? records : records[..result];
+    }
+
+    public delegate int JsonReader(byte[] buffer, int bufferSize, out int requiredSize);
+
+    /// <summary>
+    /// Reads a JSON list export. The first buffer is sized from sizeHint, which is
+    /// updated with the size the wrapper reported so the next call usually fits in
+    /// one pass. Returns null on error.
+    /// </summary>
+    public static string? ReadJson(JsonReader reader, ref int sizeHint, out int result)
+    {
+        var buffer = new byte[Math.Max(sizeHint, 256)];
+        result = reader(buffer, buffer.Length, out int required);
+
+        // The data can grow between calls, so allow a couple of resizes
+        for (int attempt = 0; attempt < 3 && result == MT4_ERROR_BUFFER_TOO_SMALL && required > buffer.Length; attempt++)
+        {
+            buffer = new byte[required + required / 8];
+            result = reader(buffer, buffer.Length, out required);
+        }
+
+        if (result != MT4_SUCCESS) return null;
+
+        sizeHint = required + required / 8;
+        return Encoding.UTF8.GetString(buffer, 0, required - 1);
+    }
+
+    /// <summary>
+    /// Converts a zero-terminated fixed char field from a binary record
+    /// </summary>
+    public static unsafe string FixedString(byte* text, int size)
+    {
+        int length = 0;
+        while (length < size && text[length] != 0) length++;
+        return Encoding.UTF8.GetString(text, length);
+    }
+
+    // The wrapper keeps the last error per thread: call this on the thread that
+    // made the failing call, before any await
     public static string GetLastErrorString()
     {
         IntPtr ptr = MT4_GetLastError();
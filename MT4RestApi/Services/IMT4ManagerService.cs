@@ -5,35 +5,47 @@ namespace MT4RestApi.Services;
 public interface IMT4ManagerService
 {
     // Connection Management
-    Task<bool> ConnectAsync(string server);
-    Task<bool> LoginAsync(int login, string password);
+    Task<ServiceResult<bool>> ConnectAsync(string server);
+    Task<ServiceResult<bool>> LoginAsync(int login, string password);
     Task DisconnectAsync();
     bool IsConnected { get; }
     
     // User Management
-    Task<List<UserRecord>> GetUsersAsync();
-    Task<UserRecord?> GetUserAsync(int login);
-    Task<bool> CreateUserAsync(UserRecord user);
-    Task<bool> UpdateUserAsync(UserRecord user);
-    Task<bool> DeleteUserAsync(int login);
+    Task<ServiceResult<List<UserRecord>>> GetUsersAsync();
+    Task<ServiceResult<UserRecord>> GetUserAsync(int login);
+    Task<ServiceResult<string>> GetUsersJsonAsync(string fields);
+    Task<ServiceResult<string>> GetUsersSinceJsonAsync(ulong version, string? fields);
+    Task<ServiceResult<bool>> CreateUserAsync(UserRecord user);
+    Task<CreateUsersResult> CreateUsersAsync(IReadOnlyList<UserRecord> users);
+    Task<ServiceResult<bool>> UpdateUserAsync(UserRecord user);
+    Task<ServiceResult<bool>> DeleteUserAsync(int login);
     
     // Trade Management
-    Task<List<TradeRecord>> GetTradesAsync(int login = 0, bool openOnly = false);
-    Task<TradeRecord?> GetTradeAsync(int order);
+    Task<ServiceResult<List<TradeRecord>>> GetTradesAsync(int login = 0, bool openOnly = false);
+    Task<ServiceResult<TradeRecord>> GetTradeAsync(int order);
+    Task<ServiceResult<string>> GetTradesJsonAsync(int login, string fields);
+    Task<ServiceResult<string>> GetTradesSinceJsonAsync(ulong version, string? fields);
+    Task<int> StreamTradesAsync(int login, Stream destination, CancellationToken cancellationToken = default);
     
     // Account Information
-    Task<BalanceInfo> GetBalanceInfoAsync(int login);
+    Task<ServiceResult<BalanceInfo>> GetBalanceInfoAsync(int login);
+    Task<ServiceResult<List<ExposureInfo>>> GetExposureAsync(string? group);
+    Task<ServiceResult<List<MarginLevelChange>>> ScanMarginLevelsAsync();
     
     // New Trading Operations
     Task<OpenTradeResult> OpenTradeAsync(OpenTradeRequest request);
-    Task<bool> CloseTradeAsync(int order);
+    Task<ServiceResult<bool>> CloseTradeAsync(int order);
     Task<CloseTradesResult> CloseAllTradesAsync(int login = 0);
-    Task<List<SymbolInfo>> GetSymbolsAsync();
+    Task<ServiceResult<List<SymbolInfo>>> GetSymbolsAsync();
+    Task<ServiceResult<string>> GetGroupsJsonAsync(string? fields);
     Task<bool> PingAsync();
+    Task<ServiceResult<PoolStatus>> GetPoolStatusAsync();
+    Task<ServiceResult<PoolStatus>> GetDealingStatusAsync();
     
     // Price/Quote Operations
-    Task<PriceQuote?> GetQuoteAsync(string symbol);
+    Task<ServiceResult<PriceQuote>> GetQuoteAsync(string symbol);
     
-    // Error Handling
+    // Why the wrapper failed to initialize; empty once it is ready. Call errors
+    // come back with each result.
     string GetLastError();
 }
\ No newline at end of file
@@ -1,3 +1,7 @@
+using System.Buffers;
+using System.Collections.Concurrent;
+using System.IO.Pipelines;
+using System.Runtime.InteropServices;
 using System.Text;
 using System.Text.Json;
 using System.Text.Json.Nodes;
@@ -12,11 +16,46 @@ public class MT4ManagerService : IMT4ManagerService, IDisposable
     private bool _disposed = false;
     private readonly object _lock = new();
     private readonly ILogger<MT4ManagerService> _logger;
-    private string _lastError = string.Empty;
+    private string _initError = string.Empty;   // see GetLastError
+    private string _server = string.Empty;
 
-    public MT4ManagerService(ILogger<MT4ManagerService> logger)
+    // Connection state as of the last connect, disconnect or probe. Requests read
+    // it without a lock or a native call: MT4_IsConnected waits for the request
+    // connection, which may be busy with another request.
+    private volatile bool _connected;
+    private int _probing;
+    private Timer? _connectionProbe;
+
+    // Extra manager connections (MT4Settings:Pool); Size 1 keeps every call on
+    // the one request connection
+    private readonly int _poolSize;
+    private readonly int _poolMaxInFlight;
+    private readonly int _poolAcquireTimeoutMs;
+
+    // Connections reserved for trade transactions (MT4Settings:Dealing); 0 sends
+    // trades through the pool with everything else
+    private readonly int _dealingConnections;
+    private readonly int _dealingAcquireTimeoutMs;
+
+    // Calls on the wrapper's request queue by tag, until the completion arrives
+    // on a wrapper worker thread; no thread-pool thread waits for them
+    private readonly ConcurrentDictionary<long, PendingCall> _pending = new();
+    private long _nextTag;
+    private readonly MT4WrapperApi.CompletionCallback _onCompletion;   // kept alive for the wrapper
+
+    // Data is the JSON or error text; Records the packed records of a binary read
+    private readonly record struct NativeCompletion(int Result, string Data, byte[]? Records = null);
+    private readonly record struct PendingCall(TaskCompletionSource<NativeCompletion> Completion, bool Binary);
+
+    public MT4ManagerService(ILogger<MT4ManagerService> logger, IConfiguration configuration)
     {
         _logger = logger;
+        _poolSize = configuration.GetValue("MT4Settings:Pool:Size", 1);
+        _poolMaxInFlight = configuration.GetValue("MT4Settings:Pool:MaxInFlightPerConnection", 2);
+        _poolAcquireTimeoutMs = configuration.GetValue("MT4Settings:Pool:AcquireTimeoutMs", 10000);
+        _dealingConnections = configuration.GetValue("MT4Settings:Dealing:Connections", 1);
+        _dealingAcquireTimeoutMs = configuration.GetValue("MT4Settings:Dealing:AcquireTimeoutMs", 5000);
+        _onCompletion = OnCompletion;
         
         try
         {
@@ -24,13 +63,30 @@ public class MT4ManagerService : IMT4ManagerService, IDisposable
             int result = MT4WrapperApi.MT4_Initialize();
             if (result == MT4WrapperApi.MT4_SUCCESS)
             {
-                _initialized = true;
-                _logger.LogInformation("MT4 Wrapper initialized successfully");
+                // One worker per connection slot keeps the pool and dealing connections busy
+                int workers = configuration.GetValue("MT4Settings:Queue:Workers",
+                    Math.Max(_poolSize, 1) * _poolMaxInFlight + _dealingConnections);
+                int maxQueued = configuration.GetValue("MT4Settings:Queue:MaxQueued", 1024);
+                MT4WrapperApi.MT4_SetCompletionCallback(_onCompletion, IntPtr.Zero);
+                if (MT4WrapperApi.MT4_StartQueue(workers, maxQueued) == MT4WrapperApi.MT4_SUCCESS)
+                {
+                    _initialized = true;
+                    _logger.LogInformation("MT4 Wrapper initialized successfully");
+                    _connectionProbe = new Timer(_ => ProbeConnection(), null, TimeSpan.FromSeconds(5), TimeSpan.FromSeconds(5));
+                }
+                else
+                {
+                    // Every trade and JSON read is submitted to the queue; without it
+                    // they would all fail, so the service does not start
+                    _initError = $"Request queue not started: {MT4WrapperApi.GetLastErrorString()}";
+                    _logger.LogError("Failed to initialize MT4 Wrapper: {Error}", _initError);
+                    MT4WrapperApi.MT4_Shutdown();
+                }
             }
             else
             {
-                _lastError = MT4WrapperApi.GetLastErrorString();
-                _logger.LogError("Failed to initialize MT4 Wrapper: {Error}", _lastError);
+                _initError = MT4WrapperApi.GetLastErrorString();
+                _logger.LogError("Failed to initialize MT4 Wrapper: {Error}", _initError);
             }
         }
         catch (DllNotFoundException ex)
@@ -55,28 +111,87 @@ public class MT4ManagerService : IMT4ManagerService, IDisposable
             _logger.LogError("1. Ensure MT4Wrapper.dll is in the same folder as MT4RestApi.exe");
             _logger.LogError("2. Ensure mtmanapi.dll is in the same folder");
             _logger.LogError("3. Install Visual C++ Redistributable 2015-2022 x86");
-            _lastError = $"MT4Wrapper.dll not found. {ex.Message}";
+            _initError = $"MT4Wrapper.dll not found. {ex.Message}";
         }
         catch (Exception ex)
         {
             _logger.LogError(ex, "Failed to initialize MT4 Manager Service");
-            _lastError = ex.Message;
+            _initError = ex.Message;
         }
     }
 
-    public bool IsConnected
+    // Submits one call to the wrapper's request queue; the task completes when a
+    // wrapper worker has run it. A refused submit completes at once with its error.
+    private Task<NativeCompletion> SubmitAsync(Func<long, long> submit, bool binary = false)
     {
-        get
+        long tag = Interlocked.Increment(ref _nextTag);
+        var completion = new TaskCompletionSource<NativeCompletion>(TaskCreationOptions.RunContinuationsAsynchronously);
+        _pending[tag] = new PendingCall(completion, binary);
+
+        long request = submit(tag);
+        if (request < 0)
         {
-            lock (_lock)
+            _pending.TryRemove(tag, out _);
+            return Task.FromResult(new NativeCompletion((int)request, MT4WrapperApi.GetLastErrorString()));
+        }
+        return completion.Task;
+    }
+
+    // Runs on a wrapper worker thread; data is freed when this returns
+    private void OnCompletion(in MT4Completion completion, IntPtr userContext)
+    {
+        if (_pending.TryRemove(completion.tag, out var pending))
+        {
+            if (pending.Binary && completion.result >= 0)
             {
-                if (!_initialized) return false;
-                return MT4WrapperApi.MT4_IsConnected() != 0;
+                var records = new byte[completion.length];
+                Marshal.Copy(completion.data, records, 0, completion.length);
+                pending.Completion.TrySetResult(new NativeCompletion(completion.result, string.Empty, records));
+                return;
             }
+
+            string data = completion.length > 0
+                ? Marshal.PtrToStringUTF8(completion.data, completion.length)
+                : string.Empty;
+            pending.Completion.TrySetResult(new NativeCompletion(completion.result, data));
+        }
+    }
+
+    // Submits a binary read; result is the record count
+    private async Task<ServiceResult<T[]>> SubmitRecordsAsync<T>(Func<long, long> submit) where T : unmanaged
+    {
+        var completion = await SubmitAsync(submit, binary: true);
+        if (completion.Result < 0)
+        {
+            return ServiceResult<T[]>.Fail(completion.Data);
+        }
+
+        var records = new T[completion.Result];
+        completion.Records.AsSpan().CopyTo(MemoryMarshal.AsBytes(records.AsSpan()));
+        return ServiceResult<T[]>.Ok(records);
+    }
+
+    public bool IsConnected => _initialized && _connected;
+
+    // Timer callback; a probe still waiting for the connection skips the next tick
+    private void ProbeConnection()
+    {
+        if (Interlocked.Exchange(ref _probing, 1) != 0) return;
+        try
+        {
+            _connected = MT4WrapperApi.MT4_IsConnected() != 0;
+        }
+        catch (Exception ex)
+        {
+            _logger.LogWarning(ex, "Connection probe failed");
+        }
+        finally
+        {
+            Volatile.Write(ref _probing, 0);
         }
     }
 
-    public async Task<bool> ConnectAsync(string server)
+    public async Task<ServiceResult<bool>> ConnectAsync(string server)
     {
         return await Task.Run(() =>
         {
@@ -86,8 +201,7 @@ public class MT4ManagerService : IMT4ManagerService, IDisposable
                 {
                     if (!_initialized)
                     {
-                        _lastError = "Service not initialized";
-                        return false;
+                        return ServiceResult<bool>.Fail("Service not initialized");
                     }
 
                     _logger.LogInformation("Connecting to MT4 server: {Server}", server);
@@ -96,24 +210,25 @@ public class MT4ManagerService : IMT4ManagerService, IDisposable
                     if (result == MT4WrapperApi.MT4_SUCCESS)
                     {
                         _logger.LogInformation("Connected successfully to {Server}", server);
-                        return true;
+                        _server = server;
+                        _connected = true;
+                        return ServiceResult<bool>.Ok(true);
                     }
                     
-                    _lastError = MT4WrapperApi.GetLastErrorString();
-                    _logger.LogError("Connection failed: {Error}", _lastError);
-                    return false;
+                    string error = MT4WrapperApi.GetLastErrorString();
+                    _logger.LogError("Connection failed: {Error}", error);
+                    return ServiceResult<bool>.Fail(error);
                 }
                 catch (Exception ex)
                 {
-                    _lastError = ex.Message;
                     _logger.LogError(ex, "Exception during connection to {Server}", server);
-                    return false;
+                    return ServiceResult<bool>.Fail(ex.Message);
                 }
             }
         });
     }
 
-    public async Task<bool> LoginAsync(int login, string password)
+    public async Task<ServiceResult<bool>> LoginAsync(int login, string password)
     {
         return await Task.Run(() =>
         {
@@ -121,14 +236,12 @@ public class MT4ManagerService : IMT4ManagerService, IDisposable
             {
                 if (!_initialized)
                 {
-                    _lastError = "Service not initialized";
-                    return false;
+                    return ServiceResult<bool>.Fail("Service not initialized");
                 }
 
                 if (!IsConnected)
                 {
-                    _lastError = "Not connected to server";
-                    return false;
+                    return ServiceResult<bool>.Fail("Not connected to server");
                 }
 
 
@@ -138,18 +251,49 @@ public class MT4ManagerService : IMT4ManagerService, IDisposable
                     if (result == MT4WrapperApi.MT4_SUCCESS)
                     {
                         _logger.LogInformation("Logged in successfully with login: {Login}", login);
-                        return true;
+
+                        // Reads fall back to the request connection until the mirror is ready,
+                        // so a mirror that cannot start is not a login failure
+                        if (MT4WrapperApi.MT4_StartMirror(_server, login, password) != MT4WrapperApi.MT4_SUCCESS)
+                        {
+                            _logger.LogWarning("Pumping mirror not started: {Error}", MT4WrapperApi.GetLastErrorString());
+                        }
+
+                        // Likewise without the pool every call uses the request connection
+                        if (_poolSize > 1)
+                        {
+                            if (MT4WrapperApi.MT4_StartPool(_server, login, password, _poolSize, _poolMaxInFlight, _poolAcquireTimeoutMs) == MT4WrapperApi.MT4_SUCCESS)
+                            {
+                                _logger.LogInformation("Connection pool started with {Size} connections", _poolSize);
+                            }
+                            else
+                            {
+                                _logger.LogWarning("Connection pool not started: {Error}", MT4WrapperApi.GetLastErrorString());
+                            }
+                        }
+
+                        if (_dealingConnections > 0)
+                        {
+                            if (MT4WrapperApi.MT4_StartDealing(_server, login, password, _dealingConnections, _dealingAcquireTimeoutMs) == MT4WrapperApi.MT4_SUCCESS)
+                            {
+                                _logger.LogInformation("Dealing started with {Count} connections", _dealingConnections);
+                            }
+                            else
+                            {
+                                _logger.LogWarning("Dealing connections not started: {Error}", MT4WrapperApi.GetLastErrorString());
+                            }
+                        }
+                        return ServiceResult<bool>.Ok(true);
                     }
                     
-                    _lastError = MT4WrapperApi.GetLastErrorString();
-                    _logger.LogError("Login failed for {Login}: {Error}", login, _lastError);
-                    return false;
+                    string error = MT4WrapperApi.GetLastErrorString();
+                    _logger.LogError("Login failed for {Login}: {Error}", login, error);
+                    return ServiceResult<bool>.Fail(error);
                 }
                 catch (Exception ex)
                 {
-                    _lastError = ex.Message;
                     _logger.LogError(ex, "Exception during login for {Login}", login);
-                    return false;
+                    return ServiceResult<bool>.Fail(ex.Message);
                 }
             }
         });
@@ -165,7 +309,11 @@ public class MT4ManagerService : IMT4ManagerService, IDisposable
                 
                 try
                 {
+                    MT4WrapperApi.MT4_StopMirror();
+                    MT4WrapperApi.MT4_StopPool();
+                    MT4WrapperApi.MT4_StopDealing();
                     MT4WrapperApi.MT4_Disconnect();
+                    _connected = false;
                     _logger.LogInformation("Disconnected from MT4 server");
                 }
                 catch (Exception ex)
@@ -180,624 +328,849 @@ public class MT4ManagerService : IMT4ManagerService, IDisposable
     {
         return await Task.Run(() =>
         {
-            lock (_lock)
+            if (!_initialized || !IsConnected) return false;
+            
+            try
             {
-                if (!_initialized || !IsConnected) return false;
-                
-                try
-                {
-                    return MT4WrapperApi.MT4_Ping() == MT4WrapperApi.MT4_SUCCESS;
-                }
-                catch
-                {
-                    return false;
-                }
+                return MT4WrapperApi.MT4_Ping() == MT4WrapperApi.MT4_SUCCESS;
+            }
+            catch
+            {
+                return false;
             }
         });
     }
 
     public async Task<OpenTradeResult> OpenTradeAsync(OpenTradeRequest request)
     {
-        return await Task.Run(() =>
+        if (!_initialized || !IsConnected)
         {
-            lock (_lock)
+            return new OpenTradeResult
             {
-                if (!_initialized || !IsConnected)
-                {
-                    return new OpenTradeResult
-                    {
-                        Success = false,
-                        Message = "Not connected to MT4 server"
-                    };
-                }
-
-                try
-                {
-                    byte[] buffer = new byte[1024];
-                    int result = MT4WrapperApi.MT4_OpenTrade(
-                        request.Login,
-                        request.Symbol,
-                        request.Cmd,
-                        request.Volume,
-                        request.Price,
-                        request.StopLoss,
-                        request.TakeProfit,
-                        request.Comment,
-                        buffer,
-                        buffer.Length
-                    );
+                Success = false,
+                Message = "Not connected to MT4 server"
+            };
+        }
 
-                    if (result == MT4WrapperApi.MT4_SUCCESS)
-                    {
-                        // Parse the order number from response
-                        int jsonEnd = Array.IndexOf(buffer, (byte)0);
-                        if (jsonEnd < 0) jsonEnd = buffer.Length;
-                        string json = Encoding.UTF8.GetString(buffer, 0, jsonEnd);
-                        
-                        var response = JsonSerializer.Deserialize<Dictionary<string, object>>(json, new JsonSerializerOptions 
-                        { 
-                            PropertyNameCaseInsensitive = true 
-                        });
-
-                        int order = 0;
-                        if (response != null && response.ContainsKey("order"))
-                        {
-                            order = response["order"] is JsonElement orderJson ? orderJson.GetInt32() : Convert.ToInt32(response["order"]);
-                        }
+        try
+        {
+            var completion = await SubmitAsync(tag => MT4WrapperApi.MT4_SubmitOpenTrade(
+                tag,
+                request.Login,
+                request.Symbol,
+                request.Cmd,
+                request.Volume,
+                request.Price,
+                request.StopLoss,
+                request.TakeProfit,
+                request.Comment
+            ));
 
-                        return new OpenTradeResult
-                        {
-                            Success = true,
-                            Order = order,
-                            Message = "Trade opened successfully"
-                        };
-                    }
+            if (completion.Result == MT4WrapperApi.MT4_SUCCESS)
+            {
+                // Parse the order number from response
+                var response = JsonSerializer.Deserialize<Dictionary<string, object>>(completion.Data, new JsonSerializerOptions 
+                { 
+                    PropertyNameCaseInsensitive = true 
+                });
 
-                    _lastError = MT4WrapperApi.GetLastErrorString();
-                    return new OpenTradeResult
-                    {
-                        Success = false,
-                        Message = _lastError
-                    };
-                }
-                catch (Exception ex)
+                int order = 0;
+                if (response != null && response.ContainsKey("order"))
                 {
-                    _lastError = ex.Message;
-                    _logger.LogError(ex, "Error opening trade");
-                    return new OpenTradeResult
-                    {
-                        Success = false,
-                        Message = ex.Message
-                    };
+                    order = response["order"] is JsonElement orderJson ? orderJson.GetInt32() : Convert.ToInt32(response["order"]);
                 }
+
+                return new OpenTradeResult
+                {
+                    Success = true,
+                    Order = order,
+                    Message = "Trade opened successfully"
+                };
             }
-        });
-    }
 
-    public async Task<bool> CloseTradeAsync(int order)
-    {
-        return await Task.Run(() =>
+            return new OpenTradeResult
+            {
+                Success = false,
+                Message = completion.Data
+            };
+        }
+        catch (Exception ex)
         {
-            lock (_lock)
+            _logger.LogError(ex, "Error opening trade");
+            return new OpenTradeResult
             {
-                if (!_initialized || !IsConnected)
-                {
-                    _lastError = "Not connected to MT4 server";
-                    return false;
-                }
+                Success = false,
+                Message = ex.Message
+            };
+        }
+    }
 
-                try
-                {
-                    int result = MT4WrapperApi.MT4_CloseTrade(order, 0, 0); // Use market price
-                    
-                    if (result == MT4WrapperApi.MT4_SUCCESS)
-                    {
-                        _logger.LogInformation("Trade {Order} closed successfully", order);
-                        return true;
-                    }
+    public async Task<ServiceResult<bool>> CloseTradeAsync(int order)
+    {
+        if (!_initialized || !IsConnected)
+        {
+            return NotConnected<bool>();
+        }
 
-                    _lastError = MT4WrapperApi.GetLastErrorString();
-                    _logger.LogError("Failed to close trade {Order}: {Error}", order, _lastError);
-                    return false;
-                }
-                catch (Exception ex)
-                {
-                    _lastError = ex.Message;
-                    _logger.LogError(ex, "Error closing trade {Order}", order);
-                    return false;
-                }
+        try
+        {
+            var completion = await SubmitAsync(tag => MT4WrapperApi.MT4_SubmitCloseTrade(tag, order, 0, 0)); // Use market price
+            
+            if (completion.Result == MT4WrapperApi.MT4_SUCCESS)
+            {
+                _logger.LogInformation("Trade {Order} closed successfully", order);
+                return ServiceResult<bool>.Ok(true);
             }
-        });
+
+            _logger.LogError("Failed to close trade {Order}: {Error}", order, completion.Data);
+            return ServiceResult<bool>.Fail(completion.Data);
+        }
+        catch (Exception ex)
+        {
+            _logger.LogError(ex, "Error closing trade {Order}", order);
+            return ServiceResult<bool>.Fail(ex.Message);
+        }
     }
 
     public async Task<CloseTradesResult> CloseAllTradesAsync(int login = 0)
     {
-        return await Task.Run(() =>
+        if (!_initialized || !IsConnected)
         {
-            lock (_lock)
+            return new CloseTradesResult
+            {
+                Success = false,
+                Message = "Not connected to MT4 server"
+            };
+        }
+
+        try
+        {
+            // Open trades only (positions and pending orders), never history
+            var read = await SubmitRecordsAsync<MT4TradeData>(login > 0
+                ? tag => MT4WrapperApi.MT4_SubmitGetTradesByLogin(tag, login)
+                : tag => MT4WrapperApi.MT4_SubmitGetTradesBinary(tag, 0));
+            if (!read.Success)
             {
-                if (!_initialized || !IsConnected)
+                return new CloseTradesResult
                 {
-                    return new CloseTradesResult
-                    {
-                        Success = false,
-                        Message = "Not connected to MT4 server"
-                    };
-                }
+                    Success = false,
+                    Message = read.Error!
+                };
+            }
 
-                try
+            // One batch: the wrapper closes in parallel on the dealing connections
+            var trades = read.Value!;
+            var orders = new int[trades.Length];
+            for (int i = 0; i < trades.Length; i++)
+            {
+                orders[i] = trades[i].order;
+            }
+            var completion = await SubmitAsync(tag => MT4WrapperApi.MT4_SubmitCloseTradesBatch(tag, orders, orders.Length, null));
+            if (completion.Result < 0)
+            {
+                return new CloseTradesResult
                 {
-                    // Get all open trades
-                    var trades = GetTradesAsync(login, true).Result;
-                    var closedOrders = new List<int>();
-                    
-                    foreach (var trade in trades)
-                    {
-                        int result = MT4WrapperApi.MT4_CloseTrade(trade.Order, 0, 0);
-                        if (result == MT4WrapperApi.MT4_SUCCESS)
-                        {
-                            closedOrders.Add(trade.Order);
-                        }
-                    }
+                    Success = false,
+                    Message = completion.Data
+                };
+            }
 
-                    return new CloseTradesResult
-                    {
-                        Success = true,
-                        ClosedCount = closedOrders.Count,
-                        ClosedOrders = closedOrders,
-                        Message = $"Closed {closedOrders.Count} of {trades.Count} trades"
-                    };
-                }
-                catch (Exception ex)
+            using var batch = JsonDocument.Parse(completion.Data);
+            var closedOrders = new List<int>(completion.Result);
+            int index = 0;
+            foreach (var result in batch.RootElement.GetProperty("results").EnumerateArray())
+            {
+                if (result.GetInt32() == MT4WrapperApi.MT4_SUCCESS)
                 {
-                    _lastError = ex.Message;
-                    _logger.LogError(ex, "Error closing all trades");
-                    return new CloseTradesResult
-                    {
-                        Success = false,
-                        Message = ex.Message
-                    };
+                    closedOrders.Add(orders[index]);
                 }
+                index++;
             }
-        });
+
+            string message = $"Closed {closedOrders.Count} of {trades.Length} trades";
+            if (closedOrders.Count < trades.Length)
+            {
+                message += $" (first failure: {batch.RootElement.GetProperty("error").GetString()})";
+            }
+
+            return new CloseTradesResult
+            {
+                Success = true,
+                ClosedCount = closedOrders.Count,
+                ClosedOrders = closedOrders,
+                Message = message
+            };
+        }
+        catch (Exception ex)
+        {
+            _logger.LogError(ex, "Error closing all trades");
+            return new CloseTradesResult
+            {
+                Success = false,
+                Message = ex.Message
+            };
+        }
     }
 
-    public async Task<List<SymbolInfo>> GetSymbolsAsync()
+    public async Task<ServiceResult<List<SymbolInfo>>> GetSymbolsAsync()
     {
-        return await Task.Run(() =>
+        if (!_initialized || !IsConnected)
         {
-            lock (_lock)
-            {
-                if (!_initialized || !IsConnected)
-                {
-                    return new List<SymbolInfo>();
-                }
+            return NotConnected<List<SymbolInfo>>();
+        }
 
-                try
-                {
-                    byte[] buffer = new byte[65536];
-                    int result = MT4WrapperApi.MT4_GetSymbols(buffer, buffer.Length);
-                    
-                    if (result == MT4WrapperApi.MT4_SUCCESS)
-                    {
-                        int jsonEnd = Array.IndexOf(buffer, (byte)0);
-                        if (jsonEnd < 0) jsonEnd = buffer.Length;
-                        string json = Encoding.UTF8.GetString(buffer, 0, jsonEnd);
-                        
-                        var symbols = JsonSerializer.Deserialize<List<Dictionary<string, object>>>(json, new JsonSerializerOptions 
-                        { 
-                            PropertyNameCaseInsensitive = true 
-                        });
-                        
-                        if (symbols != null)
-                        {
-                            return symbols.Select(s =>
-                            {
-                                var symbolInfo = new SymbolInfo
-                                {
-                                    Symbol = s.ContainsKey("symbol") ? s["symbol"].ToString() ?? "" : "",
-                                    Description = s.ContainsKey("description") ? s["description"].ToString() ?? "" : "",
-                                    Bid = s.ContainsKey("bid") ?
-                                        (s["bid"] is JsonElement bidJson ? bidJson.GetDouble() : Convert.ToDouble(s["bid"])) : 0,
-                                    Ask = s.ContainsKey("ask") ?
-                                        (s["ask"] is JsonElement askJson ? askJson.GetDouble() : Convert.ToDouble(s["ask"])) : 0,
-                                    Spread = s.ContainsKey("spread") ?
-                                        (s["spread"] is JsonElement spreadJson ? spreadJson.GetDouble() : Convert.ToDouble(s["spread"])) : 0,
-                                    Digits = s.ContainsKey("digits") ?
-                                        (s["digits"] is JsonElement digitsJson ? digitsJson.GetInt32() : Convert.ToInt32(s["digits"])) : 0,
-                                    ContractSize = s.ContainsKey("contractSize") ?
-                                        (s["contractSize"] is JsonElement contractJson ? contractJson.GetDouble() : Convert.ToDouble(s["contractSize"])) : 0,
-                                    MinLot = s.ContainsKey("minLot") ?
-                                        (s["minLot"] is JsonElement minLotJson ? minLotJson.GetDouble() : Convert.ToDouble(s["minLot"])) : 0,
-                                    MaxLot = s.ContainsKey("maxLot") ?
-                                        (s["maxLot"] is JsonElement maxLotJson ? maxLotJson.GetDouble() : Convert.ToDouble(s["maxLot"])) : 0,
-                                    LotStep = s.ContainsKey("lotStep") ?
-                                        (s["lotStep"] is JsonElement lotStepJson ? lotStepJson.GetDouble() : Convert.ToDouble(s["lotStep"])) : 0
-                                };
-                                symbolInfo.CleanSymbol();
-                                return symbolInfo;
-                            }).ToList();
-                        }
-                    }
+        try
+        {
+            var read = await SubmitRecordsAsync<MT4SymbolData>(MT4WrapperApi.MT4_SubmitGetSymbolsBinary);
+            if (!read.Success)
+            {
+                return ServiceResult<List<SymbolInfo>>.Fail(read.Error!);
+            }
 
-                    _lastError = MT4WrapperApi.GetLastErrorString();
-                    return new List<SymbolInfo>();
-                }
-                catch (Exception ex)
-                {
-                    _lastError = ex.Message;
-                    _logger.LogError(ex, "Error getting symbols");
-                    return new List<SymbolInfo>();
-                }
+            var records = read.Value!;
+            var symbols = new List<SymbolInfo>(records.Length);
+            for (int i = 0; i < records.Length; i++)
+            {
+                symbols.Add(SymbolInfo.FromData(records[i]));
             }
-        });
+            return ServiceResult<List<SymbolInfo>>.Ok(symbols);
+        }
+        catch (Exception ex)
+        {
+            _logger.LogError(ex, "Error getting symbols");
+            return ServiceResult<List<SymbolInfo>>.Fail(ex.Message);
+        }
     }
 
-    public async Task<UserRecord?> GetUserAsync(int login)
+    public async Task<ServiceResult<UserRecord>> GetUserAsync(int login)
     {
-        return await Task.Run(() =>
+        if (!_initialized || !IsConnected) return NotConnected<UserRecord>();
+        
+        
+        try
         {
-            lock (_lock)
+            var completion = await SubmitAsync(tag => MT4WrapperApi.MT4_SubmitGetUserInfo(tag, login));
+            
+            if (completion.Result == MT4WrapperApi.MT4_SUCCESS)
             {
-                if (!_initialized || !IsConnected) return null;
+                var info = JsonSerializer.Deserialize<Dictionary<string, object>>(completion.Data, new JsonSerializerOptions 
+                { 
+                    PropertyNameCaseInsensitive = true 
+                });
                 
-                
-                try
+                if (info != null)
                 {
-                    byte[] buffer = new byte[4096];
-                    int result = MT4WrapperApi.MT4_GetUserInfo(login, buffer, buffer.Length);
-                    
-                    if (result == MT4WrapperApi.MT4_SUCCESS)
+                    var user = new UserRecord
                     {
-                        // Find the actual end of the JSON string
-                        int jsonEnd = Array.IndexOf(buffer, (byte)0);
-                        if (jsonEnd < 0) jsonEnd = buffer.Length;
-                        string json = Encoding.UTF8.GetString(buffer, 0, jsonEnd);
-                        var info = JsonSerializer.Deserialize<Dictionary<string, object>>(json, new JsonSerializerOptions 
-                        { 
-                            PropertyNameCaseInsensitive = true 
-                        });
-                        
-                        if (info != null)
-                        {
-                            var user = new UserRecord
-                            {
-                                Login = login,
-                                Name = info.ContainsKey("name") ? info["name"].ToString() ?? "" : "",
-                                Balance = info.ContainsKey("balance") ? 
-                                    (info["balance"] is JsonElement balanceJson ? balanceJson.GetDouble() : Convert.ToDouble(info["balance"])) : 0
-                            };
-                            return user;
-                        }
-                    }
-                    
-                    _lastError = MT4WrapperApi.GetLastErrorString();
-                    return null;
-                }
-                catch (Exception ex)
-                {
-                    _lastError = ex.Message;
-                    _logger.LogError(ex, "Error getting user info for login {Login}", login);
-                    return null;
+                        Login = login,
+                        Name = info.ContainsKey("name") ? info["name"].ToString() ?? "" : "",
+                        Balance = info.ContainsKey("balance") ? 
+                            (info["balance"] is JsonElement balanceJson ? balanceJson.GetDouble() : Convert.ToDouble(info["balance"])) : 0
+                    };
+                    return ServiceResult<UserRecord>.Ok(user);
                 }
             }
-        });
+            
+            return ServiceResult<UserRecord>.Fail(completion.Data);
+        }
+        catch (Exception ex)
+        {
+            _logger.LogError(ex, "Error getting user info for login {Login}", login);
+            return ServiceResult<UserRecord>.Fail(ex.Message);
+        }
     }
 
-    public async Task<List<UserRecord>> GetUsersAsync()
+    public async Task<ServiceResult<string>> GetUsersJsonAsync(string fields)
     {
-        return await Task.Run(() =>
+        if (!_initialized || !IsConnected)
         {
-            lock (_lock)
+            return NotConnected<string>();
+        }
+
+        try
+        {
+            if (MT4WrapperApi.MT4_ParseFieldMask(MT4WrapperApi.MT4_RECORD_USER, fields, out ulong mask) != MT4WrapperApi.MT4_SUCCESS)
             {
-                if (!_initialized || !IsConnected) return new List<UserRecord>();
-                
-                
-                try
-                {
-                    byte[] buffer = new byte[65536]; // 64KB buffer
-                    int result = MT4WrapperApi.MT4_GetAllUsers(buffer, buffer.Length);
-                    
-                    if (result == MT4WrapperApi.MT4_SUCCESS)
-                    {
-                        // Find the actual end of the JSON string
-                        int jsonEnd = Array.IndexOf(buffer, (byte)0);
-                        if (jsonEnd < 0) jsonEnd = buffer.Length;
-                        string json = Encoding.UTF8.GetString(buffer, 0, jsonEnd);
-                        var users = JsonSerializer.Deserialize<List<Dictionary<string, object>>>(json, new JsonSerializerOptions 
-                        { 
-                            PropertyNameCaseInsensitive = true 
-                        });
-                        
-                        if (users != null)
-                        {
-                            return users.Select(u => new UserRecord
-                            {
-                                Login = u["login"] is JsonElement loginJson ? loginJson.GetInt32() : Convert.ToInt32(u["login"]),
-                                Name = u.ContainsKey("name") ? u["name"].ToString() ?? "" : "",
-                                Balance = u.ContainsKey("balance") ? 
-                                    (u["balance"] is JsonElement balanceJson ? balanceJson.GetDouble() : Convert.ToDouble(u["balance"])) : 0
-                            }).ToList();
-                        }
-                        return new List<UserRecord>();
-                    }
-                    
-                    _lastError = MT4WrapperApi.GetLastErrorString();
-                    return new List<UserRecord>();
-                }
-                catch (Exception ex)
-                {
-                    _lastError = ex.Message;
-                    _logger.LogError(ex, "Error getting all users");
-                    return new List<UserRecord>();
-                }
+                return ServiceResult<string>.Fail(MT4WrapperApi.GetLastErrorString());
             }
-        });
+
+            var completion = await SubmitAsync(tag => MT4WrapperApi.MT4_SubmitGetAllUsers(tag, mask));
+            if (completion.Result < 0)
+            {
+                return ServiceResult<string>.Fail(completion.Data);
+            }
+            return ServiceResult<string>.Ok(completion.Data);
+        }
+        catch (Exception ex)
+        {
+            _logger.LogError(ex, "Error getting projected users ({Fields})", fields);
+            return ServiceResult<string>.Fail(ex.Message);
+        }
     }
 
-    public async Task<bool> CreateUserAsync(UserRecord user)
+    public async Task<ServiceResult<List<UserRecord>>> GetUsersAsync()
     {
-        return await Task.Run(() =>
+        if (!_initialized || !IsConnected) return NotConnected<List<UserRecord>>();
+
+        try
         {
-            lock (_lock)
+            var read = await SubmitRecordsAsync<MT4UserData>(MT4WrapperApi.MT4_SubmitGetUsersBinary);
+            if (!read.Success)
             {
-                if (!_initialized || !IsConnected)
-                {
-                    _lastError = "Not connected to MT4 server";
-                    return false;
-                }
+                return ServiceResult<List<UserRecord>>.Fail(read.Error!);
+            }
 
-                try
-                {
-                    // Prepare JSON data for the user
-                    var jsonData = JsonSerializer.Serialize(new
-                    {
-                        login = user.Login,
-                        password = user.Password ?? "defaultpass123",
-                        group = user.Group ?? "demo",
-                        name = user.Name ?? "New User",
-                        email = user.Email ?? "",
-                        leverage = user.Leverage > 0 ? user.Leverage : 100
-                    });
+            var records = read.Value!;
+            var users = new List<UserRecord>(records.Length);
+            for (int i = 0; i < records.Length; i++)
+            {
+                users.Add(UserRecord.FromData(records[i]));
+            }
+            return ServiceResult<List<UserRecord>>.Ok(users);
+        }
+        catch (Exception ex)
+        {
+            _logger.LogError(ex, "Error getting all users");
+            return ServiceResult<List<UserRecord>>.Fail(ex.Message);
+        }
+    }
 
-                    byte[] buffer = new byte[4096];
-                    int result = MT4WrapperApi.MT4_CreateUser(jsonData, buffer, buffer.Length);
+    public async Task<ServiceResult<bool>> CreateUserAsync(UserRecord user)
+    {
+        if (!_initialized || !IsConnected)
+        {
+            return NotConnected<bool>();
+        }
 
-                    if (result == MT4WrapperApi.MT4_SUCCESS)
-                    {
-                        _lastError = "";
-                        return true;
-                    }
+        try
+        {
+            // Prepare JSON data for the user
+            var jsonData = JsonSerializer.Serialize(ToCreateUserBody(user));
 
-                    _lastError = MT4WrapperApi.GetLastErrorString();
-                    return false;
-                }
-                catch (Exception ex)
-                {
-                    _lastError = ex.Message;
-                    _logger.LogError(ex, "Error creating user");
-                    return false;
-                }
+            var completion = await SubmitAsync(tag => MT4WrapperApi.MT4_SubmitCreateUser(tag, jsonData));
+            if (completion.Result == MT4WrapperApi.MT4_SUCCESS)
+            {
+                return ServiceResult<bool>.Ok(true);
             }
-        });
+
+            return ServiceResult<bool>.Fail(completion.Data);
+        }
+        catch (Exception ex)
+        {
+            _logger.LogError(ex, "Error creating user");
+            return ServiceResult<bool>.Fail(ex.Message);
+        }
     }
 
-    public async Task<bool> UpdateUserAsync(UserRecord user)
+    public async Task<CreateUsersResult> CreateUsersAsync(IReadOnlyList<UserRecord> users)
     {
-        return await Task.Run(() =>
+        if (!_initialized || !IsConnected)
         {
-            lock (_lock)
+            return new CreateUsersResult { Success = false, Message = "Not connected to MT4 server" };
+        }
+
+        try
+        {
+            // One queued call and one lock for the whole batch
+            var jsonData = JsonSerializer.Serialize(users.Select(ToCreateUserBody));
+            var completion = await SubmitAsync(tag => MT4WrapperApi.MT4_SubmitCreateUsersBatch(tag, jsonData, users.Count));
+
+            int created = completion.Result;
+            if (created < 0)
             {
-                if (!_initialized || !IsConnected)
-                {
-                    _lastError = "Not connected to MT4 server";
-                    return false;
-                }
+                return new CreateUsersResult { Success = false, Message = completion.Data };
+            }
 
-                try
-                {
-                    // Prepare JSON data for the update
-                    var jsonData = JsonSerializer.Serialize(new
-                    {
-                        name = user.Name,
-                        email = user.Email,
-                        group = user.Group
-                    });
+            using var batch = JsonDocument.Parse(completion.Data);
+            var results = batch.RootElement.GetProperty("results").EnumerateArray()
+                .Select(r => new CreateUserResult { Login = r.GetProperty("login").GetInt32(), Code = r.GetProperty("code").GetInt32() })
+                .ToList();
 
-                    int result = MT4WrapperApi.MT4_UpdateUser(user.Login, jsonData);
+            return new CreateUsersResult
+            {
+                Success = created == users.Count,
+                CreatedCount = created,
+                Results = results,
+                Message = created == users.Count ? $"Created {created} users" : batch.RootElement.GetProperty("error").GetString() ?? string.Empty
+            };
+        }
+        catch (Exception ex)
+        {
+            _logger.LogError(ex, "Error creating {Count} users", users.Count);
+            return new CreateUsersResult { Success = false, Message = ex.Message };
+        }
+    }
 
-                    if (result == MT4WrapperApi.MT4_SUCCESS)
+    // Request body accepted by MT4_CreateUser and MT4_CreateUsersBatch
+    private static object ToCreateUserBody(UserRecord user)
+    {
+        return new
+        {
+            login = user.Login,
+            password = user.Password ?? "defaultpass123",
+            group = user.Group ?? "demo",
+            name = user.Name ?? "New User",
+            email = user.Email ?? "",
+            country = user.Country ?? "",
+            city = user.City ?? "",
+            phone = user.Phone ?? "",
+            leverage = user.Leverage > 0 ? user.Leverage : 100
+        };
+    }
+
+    public async Task<ServiceResult<bool>> UpdateUserAsync(UserRecord user)
+    {
+        if (!_initialized || !IsConnected)
+        {
+            return NotConnected<bool>();
+        }
+
+        try
+        {
+            // Prepare JSON data for the update
+            var jsonData = JsonSerializer.Serialize(new
+            {
+                name = user.Name,
+                email = user.Email,
+                group = user.Group,
+                country = user.Country,
+                city = user.City,
+                phone = user.Phone,
+                // null leaves the current leverage alone
+                leverage = user.Leverage > 0 ? user.Leverage : (int?)null
+            });
+
+            var completion = await SubmitAsync(tag => MT4WrapperApi.MT4_SubmitUpdateUser(tag, user.Login, jsonData));
+            if (completion.Result == MT4WrapperApi.MT4_SUCCESS)
+            {
+                return ServiceResult<bool>.Ok(true);
+            }
+
+            return ServiceResult<bool>.Fail(completion.Data);
+        }
+        catch (Exception ex)
+        {
+            _logger.LogError(ex, "Error updating user");
+            return ServiceResult<bool>.Fail(ex.Message);
+        }
+    }
+
+    public async Task<ServiceResult<bool>> DeleteUserAsync(int login)
+    {
+        if (!_initialized || !IsConnected)
+        {
+            return NotConnected<bool>();
+        }
+
+        try
+        {
+            var completion = await SubmitAsync(tag => MT4WrapperApi.MT4_SubmitDeleteUser(tag, login));
+            if (completion.Result == MT4WrapperApi.MT4_SUCCESS)
+            {
+                return ServiceResult<bool>.Ok(true);
+            }
+
+            return ServiceResult<bool>.Fail(completion.Data);
+        }
+        catch (Exception ex)
+        {
+            _logger.LogError(ex, "Error deleting user");
+            return ServiceResult<bool>.Fail(ex.Message);
+        }
+    }
+
+    public async Task<ServiceResult<string>> GetTradesJsonAsync(int login, string fields)
+    {
+        if (!_initialized || !IsConnected)
+        {
+            return NotConnected<string>();
+        }
+
+        try
+        {
+            if (MT4WrapperApi.MT4_ParseFieldMask(MT4WrapperApi.MT4_RECORD_TRADE, fields, out ulong mask) != MT4WrapperApi.MT4_SUCCESS)
+            {
+                return ServiceResult<string>.Fail(MT4WrapperApi.GetLastErrorString());
+            }
+
+            var completion = await SubmitAsync(tag => MT4WrapperApi.MT4_SubmitGetTrades(tag, login, mask));
+            if (completion.Result < 0)
+            {
+                return ServiceResult<string>.Fail(completion.Data);
+            }
+            return ServiceResult<string>.Ok(completion.Data);
+        }
+        catch (Exception ex)
+        {
+            _logger.LogError(ex, "Error getting projected trades for login {Login} ({Fields})", login, fields);
+            return ServiceResult<string>.Fail(ex.Message);
+        }
+    }
+
+    public async Task<ServiceResult<string>> GetGroupsJsonAsync(string? fields)
+    {
+        if (!_initialized || !IsConnected)
+        {
+            return NotConnected<string>();
+        }
+
+        try
+        {
+            ulong mask = MT4WrapperApi.MT4_FIELDS_ALL;
+            if (!string.IsNullOrWhiteSpace(fields) &&
+                MT4WrapperApi.MT4_ParseFieldMask(MT4WrapperApi.MT4_RECORD_GROUP, fields, out mask) != MT4WrapperApi.MT4_SUCCESS)
+            {
+                return ServiceResult<string>.Fail(MT4WrapperApi.GetLastErrorString());
+            }
+
+            var completion = await SubmitAsync(tag => MT4WrapperApi.MT4_SubmitGetGroups(tag, mask));
+            if (completion.Result < 0)
+            {
+                return ServiceResult<string>.Fail(completion.Data);
+            }
+            return ServiceResult<string>.Ok(completion.Data);
+        }
+        catch (Exception ex)
+        {
+            _logger.LogError(ex, "Error getting groups");
+            return ServiceResult<string>.Fail(ex.Message);
+        }
+    }
+
+    public Task<ServiceResult<string>> GetUsersSinceJsonAsync(ulong version, string? fields)
+    {
+        return GetDeltaJsonAsync(MT4WrapperApi.MT4_RECORD_USER, version, fields, MT4WrapperApi.MT4_SubmitGetUsersSince);
+    }
+
+    public Task<ServiceResult<string>> GetTradesSinceJsonAsync(ulong version, string? fields)
+    {
+        return GetDeltaJsonAsync(MT4WrapperApi.MT4_RECORD_TRADE, version, fields, MT4WrapperApi.MT4_SubmitGetTradesSince);
+    }
+
+    private delegate long DeltaSubmit(long tag, ulong version, ulong fieldMask);
+
+    private async Task<ServiceResult<string>> GetDeltaJsonAsync(int recordType, ulong version, string? fields, DeltaSubmit submit)
+    {
+        if (!_initialized || !IsConnected)
+        {
+            return NotConnected<string>();
+        }
+
+        try
+        {
+            ulong mask = MT4WrapperApi.MT4_FIELDS_ALL;
+            if (!string.IsNullOrWhiteSpace(fields) &&
+                MT4WrapperApi.MT4_ParseFieldMask(recordType, fields, out mask) != MT4WrapperApi.MT4_SUCCESS)
+            {
+                return ServiceResult<string>.Fail(MT4WrapperApi.GetLastErrorString());
+            }
+
+            var completion = await SubmitAsync(tag => submit(tag, version, mask));
+            if (completion.Result < 0)
+            {
+                return ServiceResult<string>.Fail(completion.Data);
+            }
+            return ServiceResult<string>.Ok(completion.Data);
+        }
+        catch (Exception ex)
+        {
+            _logger.LogError(ex, "Error getting changes since version {Version}", version);
+            return ServiceResult<string>.Fail(ex.Message);
+        }
+    }
+
+    public async Task<ServiceResult<List<TradeRecord>>> GetTradesAsync(int login = 0, bool openOnly = false)
+    {
+        if (!_initialized || !IsConnected) return NotConnected<List<TradeRecord>>();
+
+        try
+        {
+            // Per-login binary reads return history; the login index has just the open ones
+            var read = await SubmitRecordsAsync<MT4TradeData>(openOnly && login > 0
+                ? tag => MT4WrapperApi.MT4_SubmitGetTradesByLogin(tag, login)
+                : tag => MT4WrapperApi.MT4_SubmitGetTradesBinary(tag, login));
+            if (!read.Success)
+            {
+                return ServiceResult<List<TradeRecord>>.Fail(read.Error!);
+            }
+
+            var records = read.Value!;
+            var trades = new List<TradeRecord>(records.Length);
+            for (int i = 0; i < records.Length; i++)
+            {
+                trades.Add(TradeRecord.FromData(records[i]));
+            }
+            return ServiceResult<List<TradeRecord>>.Ok(trades);
+        }
+        catch (Exception ex)
+        {
+            _logger.LogError(ex, "Error getting trades for login {Login}", login);
+            return ServiceResult<List<TradeRecord>>.Fail(ex.Message);
+        }
+    }
+
+    public async Task<int> StreamTradesAsync(int login, Stream destination, CancellationToken cancellationToken = default)
+    {
+        var pipe = new Pipe();
+
+        // The wrapper pushes chunks from a pool thread; the pipe gives it backpressure
+        var producer = Task.Run(() =>
+        {
+            if (!_initialized || !IsConnected)
+            {
+                pipe.Writer.Complete(new InvalidOperationException("Not connected to MT4 server"));
+                return MT4WrapperApi.MT4_ERROR_NOT_CONNECTED;
+            }
+
+            try
+            {
+                MT4WrapperApi.ChunkCallback callback = (data, length, _) =>
+                {
+                    // Runs inside the native call: an exception must not unwind the
+                    // wrapper's frame, so a cancelled or failed flush stops the stream
+                    try
+                    {
+                        unsafe
+                        {
+                            pipe.Writer.Write(new ReadOnlySpan<byte>((void*)data, length));
+                        }
+                        var flush = pipe.Writer.FlushAsync(cancellationToken).AsTask().GetAwaiter().GetResult();
+                        return flush.IsCanceled || flush.IsCompleted ? 1 : 0;
+                    }
+                    catch (OperationCanceledException)
+                    {
+                        return 1;
+                    }
+                    catch (Exception ex)
                     {
-                        _lastError = "";
-                        return true;
+                        _logger.LogWarning(ex, "Trade stream for login {Login} stopped by the consumer", login);
+                        return 1;
                     }
+                };
 
-                    _lastError = MT4WrapperApi.GetLastErrorString();
-                    return false;
-                }
-                catch (Exception ex)
+                int result = MT4WrapperApi.MT4_StreamTrades(login, callback, IntPtr.Zero, 64 * 1024);
+                GC.KeepAlive(callback);
+
+                if (result < 0)
                 {
-                    _lastError = ex.Message;
-                    _logger.LogError(ex, "Error updating user");
-                    return false;
+                    pipe.Writer.Complete(new IOException(MT4WrapperApi.GetLastErrorString()));
+                    return result;
                 }
+
+                pipe.Writer.Complete();
+                return result;
+            }
+            catch (Exception ex)
+            {
+                _logger.LogError(ex, "Error streaming trades for login {Login}", login);
+                pipe.Writer.Complete(ex);
+                return MT4WrapperApi.MT4_ERROR_INTERNAL;
             }
         });
+
+        try
+        {
+            await pipe.Reader.CopyToAsync(destination, cancellationToken);
+        }
+        finally
+        {
+            await pipe.Reader.CompleteAsync();
+        }
+
+        return await producer;
     }
 
-    public async Task<bool> DeleteUserAsync(int login)
+    public async Task<ServiceResult<TradeRecord>> GetTradeAsync(int order)
     {
         return await Task.Run(() =>
         {
-            lock (_lock)
+            if (!_initialized || !IsConnected) return NotConnected<TradeRecord>();
+
+            try
             {
-                if (!_initialized || !IsConnected)
+                int result = MT4WrapperApi.MT4_GetTradeByOrder(order, out MT4TradeData record);
+                if (result == MT4WrapperApi.MT4_SUCCESS)
                 {
-                    _lastError = "Not connected to MT4 server";
-                    return false;
+                    return ServiceResult<TradeRecord>.Ok(TradeRecord.FromData(record));
                 }
 
-                try
-                {
-                    int result = MT4WrapperApi.MT4_DeleteUser(login);
+                return ServiceResult<TradeRecord>.Fail(MT4WrapperApi.GetLastErrorString());
+            }
+            catch (Exception ex)
+            {
+                _logger.LogError(ex, "Error getting trade {Order}", order);
+                return ServiceResult<TradeRecord>.Fail(ex.Message);
+            }
+        });
+    }
 
-                    if (result == MT4WrapperApi.MT4_SUCCESS)
-                    {
-                        _lastError = "";
-                        return true;
-                    }
+    public async Task<ServiceResult<BalanceInfo>> GetBalanceInfoAsync(int login)
+    {
+        return await Task.Run(() =>
+        {
+            if (!_initialized || !IsConnected) return NotConnected<BalanceInfo>();
 
-                    _lastError = MT4WrapperApi.GetLastErrorString();
-                    return false;
-                }
-                catch (Exception ex)
+            try
+            {
+                int result = MT4WrapperApi.MT4_GetAccountState(login, out MT4AccountState state);
+                if (result == MT4WrapperApi.MT4_SUCCESS)
                 {
-                    _lastError = ex.Message;
-                    _logger.LogError(ex, "Error deleting user");
-                    return false;
+                    return ServiceResult<BalanceInfo>.Ok(BalanceInfo.FromState(state));
                 }
+
+                return ServiceResult<BalanceInfo>.Fail(MT4WrapperApi.GetLastErrorString());
+            }
+            catch (Exception ex)
+            {
+                _logger.LogError(ex, "Error getting account state for {Login}", login);
+                return ServiceResult<BalanceInfo>.Fail(ex.Message);
             }
         });
     }
 
-    public async Task<List<TradeRecord>> GetTradesAsync(int login = 0, bool openOnly = false)
+    public async Task<ServiceResult<List<ExposureInfo>>> GetExposureAsync(string? group)
     {
         return await Task.Run(() =>
         {
-            lock (_lock)
+            if (!_initialized || !IsConnected) return NotConnected<List<ExposureInfo>>();
+
+            try
             {
-                if (!_initialized || !IsConnected) return new List<TradeRecord>();
-                
-                
-                try
+                var records = MT4WrapperApi.ReadRecords<MT4ExposureData>(
+                    (Span<MT4ExposureData> span, out int total) => MT4WrapperApi.GetExposure(group, span, out total), 256, out int result);
+                if (result < 0)
                 {
-                    byte[] buffer = new byte[65536]; // 64KB buffer
-                    int result = MT4WrapperApi.MT4_GetTrades(login, buffer, buffer.Length);
-                    
-                    if (result == MT4WrapperApi.MT4_SUCCESS)
-                    {
-                        // Find the actual end of the JSON string
-                        int jsonEnd = Array.IndexOf(buffer, (byte)0);
-                        if (jsonEnd < 0) jsonEnd = buffer.Length;
-                        string json = Encoding.UTF8.GetString(buffer, 0, jsonEnd);
-                        var trades = JsonSerializer.Deserialize<List<Dictionary<string, object>>>(json, new JsonSerializerOptions 
-                        { 
-                            PropertyNameCaseInsensitive = true 
-                        });
-                        
-                        if (trades != null)
-                        {
-                            return trades.Select(t =>
-                            {
-                                var trade = new TradeRecord
-                                {
-                                    Order = t["order"] is JsonElement orderJson ? orderJson.GetInt32() : Convert.ToInt32(t["order"]),
-                                    Login = t["login"] is JsonElement loginJson ? loginJson.GetInt32() : Convert.ToInt32(t["login"]),
-                                    Symbol = t.ContainsKey("symbol") ? t["symbol"].ToString() ?? "" : "",
-                                    Volume = t.ContainsKey("volume") ?
-                                        (t["volume"] is JsonElement volumeJson ? volumeJson.GetInt32() : Convert.ToInt32(t["volume"])) : 0,
-                                    Profit = t.ContainsKey("profit") ?
-                                        (t["profit"] is JsonElement profitJson ? profitJson.GetDouble() : Convert.ToDouble(t["profit"])) : 0
-                                };
-                                trade.CleanSymbol();
-                                return trade;
-                            }).ToList();
-                        }
-                        return new List<TradeRecord>();
-                    }
-                    
-                    _lastError = MT4WrapperApi.GetLastErrorString();
-                    return new List<TradeRecord>();
+                    return ServiceResult<List<ExposureInfo>>.Fail(MT4WrapperApi.GetLastErrorString());
                 }
-                catch (Exception ex)
+
+                var exposure = new List<ExposureInfo>(records.Length);
+                foreach (ref readonly var record in records.AsSpan())
                 {
-                    _lastError = ex.Message;
-                    _logger.LogError(ex, "Error getting trades for login {Login}", login);
-                    return new List<TradeRecord>();
+                    exposure.Add(ExposureInfo.FromData(record));
                 }
+                return ServiceResult<List<ExposureInfo>>.Ok(exposure);
+            }
+            catch (Exception ex)
+            {
+                _logger.LogError(ex, "Error getting exposure for group {Group}", group ?? "(all)");
+                return ServiceResult<List<ExposureInfo>>.Fail(ex.Message);
             }
         });
     }
 
-    public async Task<TradeRecord?> GetTradeAsync(int order)
+    public async Task<ServiceResult<List<MarginLevelChange>>> ScanMarginLevelsAsync()
     {
-        // Not implemented in wrapper yet - could filter from GetTradesAsync
-        var trades = await GetTradesAsync();
-        return trades.FirstOrDefault(t => t.Order == order);
-    }
-
-    public async Task<BalanceInfo> GetBalanceInfoAsync(int login)
-    {
-        var user = await GetUserAsync(login);
-        if (user != null)
+        return await Task.Run(() =>
         {
-            return new BalanceInfo
+            if (!_initialized || !IsConnected) return NotConnected<List<MarginLevelChange>>();
+
+            try
             {
-                Login = login,
-                Balance = user.Balance,
-                Equity = user.Balance,  // Would need more data for accurate equity
-                Margin = 0,
-                FreeMargin = user.Balance
-            };
-        }
-        
-        return new BalanceInfo { Login = login };
+                var records = MT4WrapperApi.ReadRecords<MT4MarginEvent>(MT4WrapperApi.ScanMarginLevels, 64, out int result);
+                if (result < 0)
+                {
+                    return ServiceResult<List<MarginLevelChange>>.Fail(MT4WrapperApi.GetLastErrorString());
+                }
+
+                var changes = new List<MarginLevelChange>(records.Length);
+                foreach (ref readonly var record in records.AsSpan())
+                {
+                    changes.Add(MarginLevelChange.FromEvent(record));
+                }
+                return ServiceResult<List<MarginLevelChange>>.Ok(changes);
+            }
+            catch (Exception ex)
+            {
+                _logger.LogError(ex, "Error scanning margin levels");
+                return ServiceResult<List<MarginLevelChange>>.Fail(ex.Message);
+            }
+        });
     }
 
-    public async Task<PriceQuote?> GetQuoteAsync(string symbol)
+    private delegate int PoolStatsReader(Span<MT4PoolStats> records, out int total, out long rejected);
+
+    public Task<ServiceResult<PoolStatus>> GetPoolStatusAsync() =>
+        ReadPoolStatusAsync(MT4WrapperApi.GetPoolStats, _poolSize);
+
+    public Task<ServiceResult<PoolStatus>> GetDealingStatusAsync() =>
+        ReadPoolStatusAsync(MT4WrapperApi.GetDealingStats, _dealingConnections);
+
+    private async Task<ServiceResult<PoolStatus>> ReadPoolStatusAsync(PoolStatsReader reader, int expected)
     {
         return await Task.Run(() =>
         {
-            lock (_lock)
+            if (!_initialized) return ServiceResult<PoolStatus>.Fail("Service not initialized");
+
+            try
             {
-                if (!_initialized || !IsConnected)
+                long rejected = 0;
+                var records = MT4WrapperApi.ReadRecords<MT4PoolStats>(
+                    (Span<MT4PoolStats> span, out int total) => reader(span, out total, out rejected),
+                    Math.Max(expected, 1), out int result);
+                if (result < 0)
                 {
-                    _lastError = "Not connected to MT4 server";
-                    return null;
+                    return ServiceResult<PoolStatus>.Fail(MT4WrapperApi.GetLastErrorString());
                 }
 
-                try
+                var connections = new List<PoolConnectionInfo>(records.Length);
+                foreach (ref readonly var record in records.AsSpan())
                 {
-                    byte[] buffer = new byte[1024];
-                    int result = MT4WrapperApi.MT4_GetQuote(symbol, buffer, buffer.Length);
+                    connections.Add(PoolConnectionInfo.FromStats(record));
+                }
+                return ServiceResult<PoolStatus>.Ok(new PoolStatus { Connections = connections, Rejected = rejected });
+            }
+            catch (Exception ex)
+            {
+                _logger.LogError(ex, "Error getting pool stats");
+                return ServiceResult<PoolStatus>.Fail(ex.Message);
+            }
+        });
+    }
 
-                    if (result == MT4WrapperApi.MT4_SUCCESS)
-                    {
-                        int jsonEnd = Array.IndexOf(buffer, (byte)0);
-                        if (jsonEnd < 0) jsonEnd = buffer.Length;
-                        string json = Encoding.UTF8.GetString(buffer, 0, jsonEnd);
-                        
-                        var quoteData = JsonSerializer.Deserialize<JsonNode>(json);
-                        if (quoteData != null)
-                        {
-                            return new PriceQuote
-                            {
-                                Symbol = symbol,
-                                Bid = quoteData["bid"]?.GetValue<double>() ?? 0,
-                                Ask = quoteData["ask"]?.GetValue<double>() ?? 0,
-                                Spread = quoteData["spread"]?.GetValue<double>() ?? 0,
-                                Digits = quoteData["digits"]?.GetValue<int>() ?? 0,
-                                Timestamp = DateTime.UtcNow
-                            };
-                        }
-                    }
+    public async Task<ServiceResult<PriceQuote>> GetQuoteAsync(string symbol)
+    {
+        if (!_initialized || !IsConnected)
+        {
+            return NotConnected<PriceQuote>();
+        }
 
-                    _lastError = MT4WrapperApi.GetLastErrorString();
-                    return null;
-                }
-                catch (Exception ex)
+        try
+        {
+            var completion = await SubmitAsync(tag => MT4WrapperApi.MT4_SubmitGetQuote(tag, symbol));
+
+            if (completion.Result == MT4WrapperApi.MT4_SUCCESS)
+            {
+                var quoteData = JsonSerializer.Deserialize<JsonNode>(completion.Data);
+                if (quoteData != null)
                 {
-                    _lastError = ex.Message;
-                    _logger.LogError(ex, "Error getting quote for {Symbol}", symbol);
-                    return null;
+                    // Mirrored quotes report how long ago they arrived
+                    long ageMs = quoteData["age"]?.GetValue<long>() ?? 0;
+                    return ServiceResult<PriceQuote>.Ok(new PriceQuote
+                    {
+                        Symbol = symbol,
+                        Bid = quoteData["bid"]?.GetValue<double>() ?? 0,
+                        Ask = quoteData["ask"]?.GetValue<double>() ?? 0,
+                        Spread = quoteData["spread"]?.GetValue<double>() ?? 0,
+                        Digits = quoteData["digits"]?.GetValue<int>() ?? 0,
+                        Timestamp = DateTime.UtcNow.AddMilliseconds(-ageMs)
+                    });
                 }
             }
-        });
+
+            return ServiceResult<PriceQuote>.Fail(completion.Data);
+        }
+        catch (Exception ex)
+        {
+            _logger.LogError(ex, "Error getting quote for {Symbol}", symbol);
+            return ServiceResult<PriceQuote>.Fail(ex.Message);
+        }
     }
 
+    private static ServiceResult<T> NotConnected<T>() => ServiceResult<T>.Fail("Not connected to MT4 server");
+
     public string GetLastError()
     {
-        return _lastError;
+        return _initError;
     }
 
     public void Dispose()
@@ -812,6 +1185,7 @@ public class MT4ManagerService : IMT4ManagerService, IDisposable
         {
             if (disposing)
             {
+                _connectionProbe?.Dispose();
                 lock (_lock)
                 {
                     if (_initialized)
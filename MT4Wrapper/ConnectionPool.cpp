@@ -0,0 +1,243 @@
+#include <windows.h>
+#include "MT4Wrapper.h"
+#include "../MT4ManagerAPI.h"
+#include "ConnectionPool.h"
+#include <cstring>
+
+ConnectionPool g_pool;
+ConnectionPool g_dealing;
+
+static void ReleaseConnection(MT4_Context& connection) {
+    if (connection.manager) {
+        connection.manager->Disconnect();
+        connection.manager->Release();
+        connection.manager = nullptr;
+    }
+}
+
+static long long SteadyMillis() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static bool IsUp(CManagerInterface* manager) {
+    try {
+        return manager->IsConnected() ? true : false;
+    }
+    catch (...) {
+        return false;
+    }
+}
+
+static int LoginConnection(char* server, int login, const char* password,
+    CManagerInterface* manager, std::string& error) {
+    int result = manager->Connect(server);
+    if (result != RET_OK) {
+        const char* errorDesc = manager->ErrorDescription(result);
+        error = errorDesc ? errorDesc : "Connection failed";
+        return MT4_ERROR_CONNECTION_FAILED;
+    }
+
+    result = manager->Login(login, password);
+    if (result != RET_OK) {
+        const char* errorDesc = manager->ErrorDescription(result);
+        error = errorDesc ? errorDesc : "Login failed";
+        return MT4_ERROR_LOGIN_FAILED;
+    }
+    return MT4_SUCCESS;
+}
+
+static int OpenConnection(CManagerFactory* factory, char* server, int login, const char* password,
+    MT4_Context& connection, std::string& error) {
+    connection.manager = factory->Create(ManAPIVersion);
+    if (!connection.manager) {
+        error = "Failed to create manager instance";
+        return MT4_ERROR_INTERNAL;
+    }
+    return LoginConnection(server, login, password, connection.manager, error);
+}
+
+int ConnectionPool::Start(CManagerFactory* factory, const char* server, int login, const char* password,
+    int size, int maxInFlight, int acquireTimeoutMs, std::string& error) {
+    {
+        std::shared_lock<std::shared_mutex> lifetime(m_lifetime);
+        if (!m_connections.empty()) {
+            error = "Pool already running";
+            return MT4_ERROR_ALREADY_INITIALIZED;
+        }
+    }
+
+    // Connect outside the lifetime lock; calls keep using the default
+    // connection until the pool is swapped in
+    std::vector<std::unique_ptr<MT4_Context>> connections;
+    char serverCopy[256] = {0};
+    strncpy_s(serverCopy, sizeof(serverCopy), server, _TRUNCATE);
+
+    for (int i = 0; i < size; i++) {
+        std::unique_ptr<MT4_Context> connection(new MT4_Context());
+        int rc = OpenConnection(factory, serverCopy, login, password, *connection, error);
+        if (rc != MT4_SUCCESS) {
+            ReleaseConnection(*connection);
+            for (auto& opened : connections) {
+                ReleaseConnection(*opened);
+            }
+            return rc;
+        }
+        connections.push_back(std::move(connection));
+    }
+
+    std::unique_lock<std::shared_mutex> lifetime(m_lifetime);
+    if (!m_connections.empty()) {
+        lifetime.unlock();
+        for (auto& opened : connections) {
+            ReleaseConnection(*opened);
+        }
+        error = "Pool already running";
+        return MT4_ERROR_ALREADY_INITIALIZED;
+    }
+    m_connections.swap(connections);
+    strncpy_s(m_server, sizeof(m_server), server, _TRUNCATE);
+    m_login = login;
+    m_password = password;
+    m_maxInFlight = maxInFlight;
+    m_acquireTimeout = std::chrono::milliseconds(acquireTimeoutMs);
+    m_rejected = 0;
+
+    error.clear();
+    return MT4_SUCCESS;
+}
+
+void ConnectionPool::Stop(void (*beforeRelease)(CManagerInterface* manager)) {
+    std::vector<std::unique_ptr<MT4_Context>> connections;
+    {
+        std::unique_lock<std::shared_mutex> lifetime(m_lifetime);
+        connections.swap(m_connections);
+        m_password.clear();
+    }
+
+    for (auto& connection : connections) {
+        if (beforeRelease && connection->manager) {
+            beforeRelease(connection->manager);
+        }
+        ReleaseConnection(*connection);
+    }
+}
+
+MT4_Context* ConnectionPool::Acquire(bool& busy) {
+    busy = false;
+    m_lifetime.lock_shared();
+    if (m_connections.empty()) {
+        m_lifetime.unlock_shared();
+        return nullptr;
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + m_acquireTimeout;
+    std::unique_lock<std::mutex> lock(m_slotLock);
+    for (;;) {
+        // Down connections are due another reconnect attempt once retryAt passes
+        long long now = SteadyMillis();
+        auto usable = [now](const MT4_Context* connection) {
+            return !connection->down || now >= connection->retryAt;
+        };
+
+        size_t count = m_connections.size();
+        size_t start = m_next++ % count;
+        MT4_Context* best = nullptr;
+        for (size_t i = 0; i < count; i++) {
+            MT4_Context* connection = m_connections[(start + i) % count].get();
+            if (usable(connection) && (!best || connection->inFlight < best->inFlight)) {
+                best = connection;
+            }
+        }
+
+        if (!best) {
+            lock.unlock();
+            m_lifetime.unlock_shared();
+            return nullptr;
+        }
+
+        if (best->inFlight < m_maxInFlight) {
+            best->inFlight++;
+            return best;
+        }
+
+        if (m_slotFree.wait_until(lock, deadline) == std::cv_status::timeout) {
+            // Last look: a slot may have freed as the wait expired
+            for (auto& connection : m_connections) {
+                if (usable(connection.get()) && connection->inFlight < m_maxInFlight) {
+                    connection->inFlight++;
+                    return connection.get();
+                }
+            }
+            lock.unlock();
+            m_rejected++;
+            busy = true;
+            m_lifetime.unlock_shared();
+            return nullptr;
+        }
+    }
+}
+
+void ConnectionPool::Release(MT4_Context* context) {
+    {
+        std::lock_guard<std::mutex> lock(m_slotLock);
+        context->inFlight--;
+    }
+    m_slotFree.notify_one();
+    m_lifetime.unlock_shared();
+}
+
+bool ConnectionPool::Revive(MT4_Context* context) {
+    CManagerInterface* manager = context->manager;
+    if (IsUp(manager)) {
+        context->down = false;
+        return true;
+    }
+    // Calls queued behind a failed attempt give up without retrying it
+    if (context->down && SteadyMillis() < context->retryAt) {
+        return false;
+    }
+
+    char serverCopy[256] = {0};
+    strncpy_s(serverCopy, sizeof(serverCopy), m_server, _TRUNCATE);
+    std::string error;
+    bool revived = false;
+    try {
+        manager->Disconnect();
+        revived = LoginConnection(serverCopy, m_login, m_password.c_str(), manager, error) == MT4_SUCCESS;
+    }
+    catch (...) {
+    }
+    context->retryAt = SteadyMillis() + RETRY_MS;
+    context->down = !revived;
+    return revived;
+}
+
+int ConnectionPool::Size() const {
+    std::shared_lock<std::shared_mutex> lifetime(m_lifetime);
+    return (int)m_connections.size();
+}
+
+bool ConnectionPool::Stats(std::vector<MT4PoolStats>& rows, long long& rejected) const {
+    std::shared_lock<std::shared_mutex> lifetime(m_lifetime);
+    if (m_connections.empty()) {
+        return false;
+    }
+
+    rows.clear();
+    rows.reserve(m_connections.size());
+    for (size_t i = 0; i < m_connections.size(); i++) {
+        const MT4_Context& connection = *m_connections[i];
+        MT4PoolStats row = {};
+        row.calls = connection.calls;
+        row.wait_us_total = connection.waitMicros;
+        row.wait_us_max = connection.maxWaitMicros;
+        row.index = (int)i;
+        row.in_flight = connection.inFlight;
+        row.max_in_flight = m_maxInFlight;
+        row.acquire_timeout_ms = (int)m_acquireTimeout.count();
+        rows.push_back(row);
+    }
+    rejected = m_rejected;
+    return true;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+// Include after MT4ManagerAPI.h and MT4Wrapper.h.
+
+// One manager connection. A CManagerInterface takes one call at a time, so every
+// export holds its context's lock for the whole call; calls on different
+// contexts run in parallel. The counters feed routing and MT4_GetPoolStats.
+struct MT4_Context {
+    CManagerInterface* manager = nullptr;
+    std::mutex lock;
+    std::atomic<int> inFlight{ 0 };            // routed here and not finished
+    std::atomic<long long> calls{ 0 };
+    std::atomic<long long> waitMicros{ 0 };    // total time calls queued for the lock
+    std::atomic<long long> maxWaitMicros{ 0 };
+    // MT4_CreateContext contexts only: one for the owner list, one per thread
+    // bound to it or call captured on it; the last release deletes the context
+    std::atomic<int> references{ 1 };
+    // Pool connections only: set when a reconnect failed, so Acquire passes the
+    // connection over until retryAt (steady clock milliseconds)
+    std::atomic<bool> down{ false };
+    std::atomic<long long> retryAt{ 0 };
+
+    void RecordWait(long long micros) {
+        calls++;
+        waitMicros += micros;
+        long long seen = maxWaitMicros.load();
+        while (micros > seen && !maxWaitMicros.compare_exchange_weak(seen, micros)) {
+        }
+    }
+};
+
+// N connections to the same server, each logged in separately. Calls not bound
+// to a context go to the connection with the fewest calls in flight, so one slow
+// request only holds up the calls queued on its own connection. A connection
+// takes at most maxInFlight calls; when all are full, Acquire waits up to the
+// acquire timeout for one to finish and then gives up. A connection that drops
+// is reconnected by the next call routed to it; one that fails to reconnect is
+// skipped for the retry interval.
+class ConnectionPool {
+public:
+    int Start(CManagerFactory* factory, const char* server, int login, const char* password,
+        int size, int maxInFlight, int acquireTimeoutMs, std::string& error);
+
+    // Waits for calls in flight; beforeRelease runs for each connection's manager
+    void Stop(void (*beforeRelease)(CManagerInterface* manager));
+
+    // Counts a call against the least loaded connection. Returns nullptr when the
+    // pool is not running or every connection is down, or with busy set when no
+    // connection freed up in time. Every non-null result must be handed back to
+    // Release.
+    MT4_Context* Acquire(bool& busy);
+    void Release(MT4_Context* context);
+
+    // Caller holds context->lock. True when the connection is up, reconnecting it
+    // first if it dropped; false marks it down until the retry interval passes.
+    bool Revive(MT4_Context* context);
+
+    // Number of connections; 0 when the pool is not running
+    int Size() const;
+
+    // One row per connection; false when the pool is not running
+    bool Stats(std::vector<MT4PoolStats>& rows, long long& rejected) const;
+
+private:
+    // Shared by every call between Acquire and Release, exclusive for Start/Stop,
+    // so connections are never released under a running call
+    mutable std::shared_mutex m_lifetime;
+    std::vector<std::unique_ptr<MT4_Context>> m_connections;
+    char m_server[256] = {0};   // what Revive reconnects with
+    int m_login = 0;
+    std::string m_password;
+    int m_maxInFlight = 1;
+    std::chrono::milliseconds m_acquireTimeout{ 0 };
+
+    std::mutex m_slotLock;   // guards inFlight changes made by routing
+    std::condition_variable m_slotFree;
+    unsigned m_next = 0;     // rotates the tie-break between idle connections
+    std::atomic<long long> m_rejected{ 0 };
+
+    enum { RETRY_MS = 5000 };
+};
+
+extern ConnectionPool g_pool;      // read and report traffic
+extern ConnectionPool g_dealing;   // trade transactions only
@@ -0,0 +1,82 @@
+#include <windows.h>
+#include "../MT4ManagerAPI.h"
+#include "GroupCache.h"
+#include <algorithm>
+
+GroupCache g_groups;
+
+void GroupCache::Assign(const ConGroup* groups, int count) {
+    if (!groups || count < 0) {
+        count = 0;
+    }
+
+    // m_groups is indexed by group id, so a repeated name keeps only its first entry
+    GroupIndex index;
+    index.Build(groups, count, &ConGroup::group);
+    std::vector<ConGroup> unique;
+    unique.reserve(index.Count());
+    for (int i = 0; i < count; i++) {
+        if (index.Find(GroupKey::Make(groups[i].group)) == (int)unique.size()) {
+            unique.push_back(groups[i]);
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(m_lock);
+    m_groups.swap(unique);
+    m_index = std::move(index);
+    m_loaded = true;
+    m_version++;
+    lock.unlock();
+
+    std::lock_guard<std::mutex> listeners(m_listenerLock);
+    for (const auto& listener : m_listeners) {
+        listener.second();
+    }
+}
+
+void GroupCache::Clear() {
+    std::unique_lock<std::shared_mutex> lock(m_lock);
+    m_groups.clear();
+    m_index.Clear();
+    m_loaded = false;
+    m_version++;
+}
+
+bool GroupCache::Loaded() const {
+    std::shared_lock<std::shared_mutex> lock(m_lock);
+    return m_loaded;
+}
+
+int GroupCache::Count() const {
+    std::shared_lock<std::shared_mutex> lock(m_lock);
+    return (int)m_groups.size();
+}
+
+unsigned long long GroupCache::Version() const {
+    std::shared_lock<std::shared_mutex> lock(m_lock);
+    return m_version;
+}
+
+bool GroupCache::Find(const char* name, ConGroup& group) const {
+    std::shared_lock<std::shared_mutex> lock(m_lock);
+    int id = m_index.Find(name);
+    if (id == GroupIndex::NOT_FOUND) {
+        return false;
+    }
+    group = m_groups[id];
+    return true;
+}
+
+int GroupCache::Subscribe(Listener listener) {
+    std::lock_guard<std::mutex> lock(m_listenerLock);
+    int token = ++m_nextToken;
+    m_listeners.emplace_back(token, std::move(listener));
+    return token;
+}
+
+void GroupCache::Unsubscribe(int token) {
+    std::lock_guard<std::mutex> lock(m_listenerLock);
+    m_listeners.erase(std::remove_if(m_listeners.begin(), m_listeners.end(),
+        [token](const std::pair<int, Listener>& listener) { return listener.first == token; }),
+        m_listeners.end());
+}
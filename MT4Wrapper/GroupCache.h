@@ -0,0 +1,63 @@
+#pragma once
+
+#include "NameIndex.h"
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <utility>
+#include <vector>
+
+// Include after MT4ManagerAPI.h.
+
+// Process-wide copy of the group configuration: leverage, currency, margin call
+// and stop out levels, per-security commissions and margin dividers. The request
+// path loads it once with GroupsRequest; while the mirror is pumping, every
+// PUMP_UPDATE_GROUPS replaces it. Anything that needs group settings reads them
+// from here instead of asking the server.
+//
+// Each Assign bumps the version and then calls the listeners, outside the cache
+// lock, on the thread that assigned.
+class GroupCache {
+public:
+    typedef std::function<void()> Listener;
+
+    void Assign(const ConGroup* groups, int count);
+    void Clear();
+
+    bool Loaded() const;
+    int Count() const;
+    unsigned long long Version() const;
+
+    // Copies one group out. False when the cache is empty or the group unknown.
+    bool Find(const char* name, ConGroup& group) const;
+
+    // reader(groups, total) under the shared lock; false without calling it
+    // when nothing has been loaded yet
+    template <typename Reader>
+    bool Read(Reader reader) const {
+        std::shared_lock<std::shared_mutex> lock(m_lock);
+        if (!m_loaded) {
+            return false;
+        }
+        reader(m_groups.data(), (int)m_groups.size());
+        return true;
+    }
+
+    // Returns a token for Unsubscribe. Unsubscribe waits for a notification in
+    // progress, so it must not be called from inside a listener.
+    int Subscribe(Listener listener);
+    void Unsubscribe(int token);
+
+private:
+    mutable std::shared_mutex m_lock;
+    std::vector<ConGroup> m_groups;
+    GroupIndex m_index;
+    bool m_loaded = false;
+    unsigned long long m_version = 0;
+
+    std::mutex m_listenerLock;   // held while listeners run
+    std::vector<std::pair<int, Listener>> m_listeners;
+    int m_nextToken = 0;
+};
+
+extern GroupCache g_groups;
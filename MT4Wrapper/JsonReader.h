@@ -0,0 +1,359 @@
+#pragma once
+
+#include <charconv>
+#include <cstring>
+
+// One-pass pull parser for the small JSON objects the REST API sends in.
+// It walks the input once, hands out keys as (pointer, length) into the input
+// and converts values straight into their destination; nothing is allocated.
+// The first problem stops the parse and is reported by Error().
+class JsonReader {
+public:
+    explicit JsonReader(const char* text)
+        : m_pos(text),
+          m_error(nullptr),
+          m_first(true) {
+    }
+
+    bool BeginObject() {
+        SkipSpace();
+        if (*m_pos != '{') {
+            return Fail("Expected JSON object");
+        }
+        m_pos++;
+        m_first = true;
+        return true;
+    }
+
+    bool BeginArray() {
+        SkipSpace();
+        if (*m_pos != '[') {
+            return Fail("Expected JSON array");
+        }
+        m_pos++;
+        return true;
+    }
+
+    // Moves to element index of the current array, or returns false at the closing
+    // bracket. The caller tracks the index because element values may be objects.
+    bool NextElement(int index) {
+        if (m_error) {
+            return false;
+        }
+        SkipSpace();
+        if (*m_pos == ']') {
+            m_pos++;
+            return false;
+        }
+        if (index > 0) {
+            if (*m_pos != ',') {
+                return Fail("Expected ',' or ']'");
+            }
+            m_pos++;
+            SkipSpace();
+        }
+        return true;
+    }
+
+    // Advances to the next member and returns its key, or false at the closing
+    // brace (check Error() to tell the end from a syntax error)
+    bool NextMember(const char*& key, size_t& length) {
+        if (m_error) {
+            return false;
+        }
+        SkipSpace();
+        if (*m_pos == '}') {
+            m_pos++;
+            return false;
+        }
+        if (!m_first) {
+            if (*m_pos != ',') {
+                return Fail("Expected ',' or '}'");
+            }
+            m_pos++;
+            SkipSpace();
+        }
+        m_first = false;
+
+        if (*m_pos != '"') {
+            return Fail("Expected member name");
+        }
+        key = ++m_pos;
+        while (*m_pos && *m_pos != '"') {
+            if (*m_pos == '\\' && m_pos[1]) {
+                m_pos++;
+            }
+            m_pos++;
+        }
+        if (*m_pos != '"') {
+            return Fail("Unterminated member name");
+        }
+        length = (size_t)(m_pos - key);
+        m_pos++;
+
+        SkipSpace();
+        if (*m_pos != ':') {
+            return Fail("Expected ':'");
+        }
+        m_pos++;
+        SkipSpace();
+        return true;
+    }
+
+    // Only whitespace may follow the top-level value
+    bool End() {
+        if (m_error) {
+            return false;
+        }
+        SkipSpace();
+        return *m_pos == '\0' || Fail("Unexpected data after JSON value");
+    }
+
+    bool IsNull() {
+        if (strncmp(m_pos, "null", 4) == 0) {
+            m_pos += 4;
+            return true;
+        }
+        return false;
+    }
+
+    // Integers; true/false are accepted as 1/0 for flag fields
+    bool ReadInt(int& value) {
+        if (Literal("true", 4)) {
+            value = 1;
+            return true;
+        }
+        if (Literal("false", 5)) {
+            value = 0;
+            return true;
+        }
+        const char* end = NumberEnd();
+        std::from_chars_result result = std::from_chars(m_pos, end, value);
+        if (result.ec != std::errc() || result.ptr != end) {
+            return Fail("Invalid integer");
+        }
+        m_pos = end;
+        return true;
+    }
+
+    bool ReadDouble(double& value) {
+        const char* end = NumberEnd();
+        std::from_chars_result result = std::from_chars(m_pos, end, value);
+        if (result.ec != std::errc() || result.ptr != end) {
+            return Fail("Invalid number");
+        }
+        m_pos = end;
+        return true;
+    }
+
+    // Unescapes into a fixed char array; fails instead of truncating. \u escapes
+    // are written as UTF-8, surrogate pairs joined into one code point.
+    bool ReadString(char* destination, size_t size) {
+        if (*m_pos != '"') {
+            return Fail("Expected string");
+        }
+        m_pos++;
+
+        size_t length = 0;
+        for (;;) {
+            const char* run = m_pos;
+            while (*m_pos && *m_pos != '"' && *m_pos != '\\') {
+                m_pos++;
+            }
+            size_t runLength = (size_t)(m_pos - run);
+            if (length + runLength >= size) {
+                return Fail("String too long");
+            }
+            memcpy(destination + length, run, runLength);
+            length += runLength;
+
+            if (*m_pos == '"') {
+                m_pos++;
+                break;
+            }
+            if (*m_pos == '\0') {
+                return Fail("Unterminated string");
+            }
+
+            char bytes[4];
+            size_t count = Unescape(bytes);
+            if (count == 0) {
+                return false;
+            }
+            if (length + count >= size) {
+                return Fail("String too long");
+            }
+            memcpy(destination + length, bytes, count);
+            length += count;
+        }
+        destination[length] = '\0';
+        return true;
+    }
+
+    // Skips any value, including nested objects and arrays
+    bool SkipValue() {
+        int depth = 0;
+        do {
+            SkipSpace();
+            char c = *m_pos;
+            if (c == '"') {
+                m_pos++;
+                while (*m_pos && *m_pos != '"') {
+                    if (*m_pos == '\\' && m_pos[1]) {
+                        m_pos++;
+                    }
+                    m_pos++;
+                }
+                if (*m_pos != '"') {
+                    return Fail("Unterminated string");
+                }
+                m_pos++;
+            } else if (c == '{' || c == '[') {
+                depth++;
+                m_pos++;
+            } else if (c == '}' || c == ']') {
+                if (depth == 0) {
+                    return Fail("Unexpected closing bracket");
+                }
+                depth--;
+                m_pos++;
+            } else if (c == ',' || c == ':') {
+                if (depth == 0) {
+                    return Fail("Expected value");
+                }
+                m_pos++;
+            } else if (c == '\0') {
+                return Fail("Unexpected end of JSON");
+            } else {
+                const char* start = m_pos;
+                while (*m_pos && !strchr(",:]} \t\r\n", *m_pos)) {
+                    m_pos++;
+                }
+                if (m_pos == start) {
+                    return Fail("Expected value");
+                }
+            }
+        } while (depth > 0);
+        return true;
+    }
+
+    bool Fail(const char* error) {
+        if (!m_error) {
+            m_error = error;
+        }
+        return false;
+    }
+
+    const char* Error() const { return m_error; }
+
+private:
+    void SkipSpace() {
+        while (*m_pos == ' ' || *m_pos == '\t' || *m_pos == '\r' || *m_pos == '\n') {
+            m_pos++;
+        }
+    }
+
+    bool Literal(const char* text, size_t length) {
+        if (strncmp(m_pos, text, length) == 0) {
+            m_pos += length;
+            return true;
+        }
+        return false;
+    }
+
+    const char* NumberEnd() const {
+        const char* end = m_pos;
+        while ((*end >= '0' && *end <= '9') || *end == '-' || *end == '+' || *end == '.' || *end == 'e' || *end == 'E') {
+            end++;
+        }
+        return end;
+    }
+
+    static int HexDigit(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    // Four hex digits at m_pos, or -1
+    int HexQuad() {
+        int code = 0;
+        for (int i = 0; i < 4; i++) {
+            int digit = HexDigit(m_pos[i]);
+            if (digit < 0) {
+                return -1;
+            }
+            code = code * 16 + digit;
+        }
+        m_pos += 4;
+        return code;
+    }
+
+    static size_t EncodeUtf8(unsigned code, char* out) {
+        if (code < 0x80) {
+            out[0] = (char)code;
+            return 1;
+        }
+        if (code < 0x800) {
+            out[0] = (char)(0xC0 | (code >> 6));
+            out[1] = (char)(0x80 | (code & 0x3F));
+            return 2;
+        }
+        if (code < 0x10000) {
+            out[0] = (char)(0xE0 | (code >> 12));
+            out[1] = (char)(0x80 | ((code >> 6) & 0x3F));
+            out[2] = (char)(0x80 | (code & 0x3F));
+            return 3;
+        }
+        out[0] = (char)(0xF0 | (code >> 18));
+        out[1] = (char)(0x80 | ((code >> 12) & 0x3F));
+        out[2] = (char)(0x80 | ((code >> 6) & 0x3F));
+        out[3] = (char)(0x80 | (code & 0x3F));
+        return 4;
+    }
+
+    // m_pos is on the backslash. Writes up to 4 bytes to out and returns how
+    // many, or 0 after Fail.
+    size_t Unescape(char* out) {
+        m_pos++;
+        switch (*m_pos++) {
+        case '"': out[0] = '"'; return 1;
+        case '\\': out[0] = '\\'; return 1;
+        case '/': out[0] = '/'; return 1;
+        case 'b': out[0] = '\b'; return 1;
+        case 'f': out[0] = '\f'; return 1;
+        case 'n': out[0] = '\n'; return 1;
+        case 'r': out[0] = '\r'; return 1;
+        case 't': out[0] = '\t'; return 1;
+        case 'u': {
+            int code = HexQuad();
+            if (code < 0) {
+                Fail("Invalid \\u escape");
+                return 0;
+            }
+            if (code >= 0xDC00 && code <= 0xDFFF) {
+                Fail("Unpaired surrogate in \\u escape");
+                return 0;
+            }
+            if (code >= 0xD800 && code <= 0xDBFF) {
+                // A high surrogate must be followed by an escaped low surrogate
+                int low = m_pos[0] == '\\' && m_pos[1] == 'u' ? (m_pos += 2, HexQuad()) : -1;
+                if (low < 0xDC00 || low > 0xDFFF) {
+                    Fail("Unpaired surrogate in \\u escape");
+                    return 0;
+                }
+                code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+            }
+            return EncodeUtf8((unsigned)code, out);
+        }
+        default:
+            Fail("Invalid escape");
+            return 0;
+        }
+    }
+
+    const char* m_pos;
+    const char* m_error;
+    bool m_first;
+};
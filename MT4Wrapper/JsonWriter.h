@@ -0,0 +1,300 @@
+#pragma once
+
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define JSONWRITER_AVX2 1
+#endif
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define JSONWRITER_SSE2 1
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Appends JSON straight into the caller's buffer.
+// Numbers are formatted with std::to_chars (no locale, no temporaries). When the
+// buffer fills up the writer stops writing and only measures the rest, so exports
+// check once in Finish() and can report the exact size a retry needs.
+// Strings are escaped: a vector scan finds the clean prefix of each string, which
+// is bulk-copied, and only the bytes that need it ('"', '\\', < 0x20) are rewritten.
+class JsonWriter {
+public:
+    JsonWriter(char* buffer, int bufferSize)
+        : m_begin(buffer),
+          m_pos(buffer),
+          m_end(buffer + (bufferSize > 0 ? bufferSize - 1 : 0)),  // keep one byte for the terminator
+          m_writable(buffer && bufferSize > 0),
+          m_overflow(!m_writable),
+          m_needComma(false),
+          m_spilled(0) {
+    }
+
+    JsonWriter& BeginObject() { Separate(); Put('{'); m_needComma = false; return *this; }
+    JsonWriter& EndObject() { Put('}'); m_needComma = true; return *this; }
+    JsonWriter& BeginArray() { Separate(); Put('['); m_needComma = false; return *this; }
+    JsonWriter& EndArray() { Put(']'); m_needComma = true; return *this; }
+
+    // Object key, including the trailing colon
+    template <size_t N>
+    JsonWriter& Key(const char (&name)[N]) {
+        return Key(name, N - 1);
+    }
+
+    JsonWriter& Key(const char* name, size_t length) {
+        Separate();
+        Put('"');
+        Raw(name, length);
+        Put('"');
+        Put(':');
+        m_needComma = false;
+        return *this;
+    }
+
+    JsonWriter& Int(long long value) {
+        Separate();
+        Number([value](char* first, char* last) {
+            return std::to_chars(first, last, value);
+        });
+        m_needComma = true;
+        return *this;
+    }
+
+    // digits < 0 writes the shortest round-trip form, otherwise fixed decimals
+    JsonWriter& Double(double value, int digits = -1) {
+        Separate();
+        if (!std::isfinite(value)) {
+            value = 0.0;  // JSON has no NaN/Infinity
+        }
+        if (digits > 17) {
+            digits = 17;
+        }
+        Number([value, digits](char* first, char* last) {
+            return digits < 0
+                ? std::to_chars(first, last, value)
+                : std::to_chars(first, last, value, std::chars_format::fixed, digits);
+        });
+        m_needComma = true;
+        return *this;
+    }
+
+    JsonWriter& Bool(bool value) {
+        Separate();
+        if (value) {
+            Raw("true", 4);
+        } else {
+            Raw("false", 5);
+        }
+        m_needComma = true;
+        return *this;
+    }
+
+    // Fixed-size MT4 char arrays are not guaranteed to be terminated
+    template <size_t N>
+    JsonWriter& String(const char (&text)[N]) {
+        return String(text, strnlen(text, N));
+    }
+
+    JsonWriter& String(const char* text) {
+        return String(text, text ? strlen(text) : 0);
+    }
+
+    JsonWriter& String(const char* text, size_t length) {
+        Separate();
+        Put('"');
+        const char* p = text;
+        const char* end = text + length;
+        while (p < end) {
+            size_t clean = CleanPrefix(p, (size_t)(end - p));
+            Raw(p, clean);
+            p += clean;
+            if (p == end) {
+                break;
+            }
+            Escape(*p++);
+        }
+        Put('"');
+        m_needComma = true;
+        return *this;
+    }
+
+    // Rollback point, used to emit whole records only
+    struct Mark {
+        char* pos;
+        size_t spilled;
+        bool overflow;
+        bool needComma;
+    };
+
+    Mark Save() const { return Mark{ m_pos, m_spilled, m_overflow, m_needComma }; }
+
+    void Restore(const Mark& mark) {
+        m_pos = mark.pos;
+        m_spilled = mark.spilled;
+        m_overflow = mark.overflow;
+        m_needComma = mark.needComma;
+    }
+
+    // Drops the written bytes but keeps the separator state, so one document
+    // can be delivered in consecutive chunks of the same buffer
+    void Rewind() {
+        m_pos = m_begin;
+        m_spilled = 0;
+        m_overflow = !m_writable;
+    }
+
+    bool Overflow() const { return m_overflow; }
+    int Length() const { return (int)(m_pos - m_begin); }
+    size_t Remaining() const { return m_overflow ? 0 : (size_t)(m_end - m_pos); }
+
+    // Buffer size the whole document needs, including the terminator
+    int Required() const { return (int)(m_pos - m_begin + m_spilled + 1); }
+
+    // Terminates the output. On overflow the buffer is left as an empty string
+    // so a caller never sees half a document.
+    bool Finish() {
+        if (m_overflow) {
+            if (m_writable) {
+                *m_begin = '\0';
+            }
+            return false;
+        }
+        *m_pos = '\0';
+        return true;
+    }
+
+private:
+    void Separate() {
+        if (m_needComma) {
+            Put(',');
+        }
+    }
+
+    void Put(char c) {
+        if (m_overflow || m_pos == m_end) {
+            m_overflow = true;
+            m_spilled++;
+            return;
+        }
+        *m_pos++ = c;
+    }
+
+    void Raw(const char* data, size_t length) {
+        if (m_overflow || (size_t)(m_end - m_pos) < length) {
+            m_overflow = true;
+            m_spilled += length;
+            return;
+        }
+        memcpy(m_pos, data, length);
+        m_pos += length;
+    }
+
+    static bool NeedsEscape(unsigned char c) {
+        return c < 0x20 || c == '"' || c == '\\';
+    }
+
+    static unsigned FirstBit(unsigned mask) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return (unsigned)index;
+#else
+        return (unsigned)__builtin_ctz(mask);
+#endif
+    }
+
+    // Number of leading bytes that can be copied without escaping
+    static size_t CleanPrefix(const char* text, size_t length) {
+        size_t i = 0;
+#if defined(JSONWRITER_AVX2)
+        const __m256i quote32 = _mm256_set1_epi8('"');
+        const __m256i slash32 = _mm256_set1_epi8('\\');
+        const __m256i ctrl32 = _mm256_set1_epi8(0x1F);
+        for (; i + 32 <= length; i += 32) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i));
+            // unsigned v <= 0x1F  <=>  max(v, 0x1F) == 0x1F
+            __m256i dirty = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(v, quote32), _mm256_cmpeq_epi8(v, slash32)),
+                _mm256_cmpeq_epi8(_mm256_max_epu8(v, ctrl32), ctrl32));
+            unsigned mask = (unsigned)_mm256_movemask_epi8(dirty);
+            if (mask) {
+                return i + FirstBit(mask);
+            }
+        }
+#endif
+#if defined(JSONWRITER_SSE2)
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i slash = _mm_set1_epi8('\\');
+        const __m128i ctrl = _mm_set1_epi8(0x1F);
+        for (; i + 16 <= length; i += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+            __m128i dirty = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, slash)),
+                _mm_cmpeq_epi8(_mm_max_epu8(v, ctrl), ctrl));
+            unsigned mask = (unsigned)_mm_movemask_epi8(dirty);
+            if (mask) {
+                return i + FirstBit(mask);
+            }
+        }
+#endif
+        for (; i < length; i++) {
+            if (NeedsEscape((unsigned char)text[i])) {
+                break;
+            }
+        }
+        return i;
+    }
+
+    void Escape(char c) {
+        char sequence[6] = { '\\', c, 0, 0, 0, 0 };
+        size_t length = 2;
+        switch (c) {
+        case '"': break;
+        case '\\': break;
+        case '\b': sequence[1] = 'b'; break;
+        case '\f': sequence[1] = 'f'; break;
+        case '\n': sequence[1] = 'n'; break;
+        case '\r': sequence[1] = 'r'; break;
+        case '\t': sequence[1] = 't'; break;
+        default: {
+            static const char hex[] = "0123456789abcdef";
+            unsigned char code = (unsigned char)c;
+            sequence[1] = 'u';
+            sequence[2] = '0';
+            sequence[3] = '0';
+            sequence[4] = hex[code >> 4];
+            sequence[5] = hex[code & 0x0F];
+            length = 6;
+            break;
+        }
+        }
+        Raw(sequence, length);
+    }
+
+    // Formats in place; once out of room, formats into scratch space only to measure
+    template <typename Format>
+    void Number(Format format) {
+        if (!m_overflow) {
+            std::to_chars_result result = format(m_pos, m_end);
+            if (result.ec == std::errc()) {
+                m_pos = result.ptr;
+                return;
+            }
+        }
+        char scratch[512];  // fits any fixed-notation double
+        std::to_chars_result result = format(scratch, scratch + sizeof(scratch));
+        Raw(scratch, result.ptr - scratch);
+    }
+
+    char* m_begin;
+    char* m_pos;
+    char* m_end;
+    bool m_writable;
+    bool m_overflow;
+    bool m_needComma;
+    size_t m_spilled;  // bytes that did not fit after the overflow
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+// Dense slot array over the login range, split into 1024-login pages that are
+// allocated on first use. Logins are handed out in runs, so a few pages cover a
+// server, and a lookup is two dependent loads with no hashing or probing.
+class LoginSlots {
+public:
+    int Find(int login) const {
+        size_t page = (size_t)login >> PAGE_BITS;
+        if (login < 0 || page >= m_pages.size() || !m_pages[page]) {
+            return -1;
+        }
+        return m_pages[page][login & PAGE_MASK];
+    }
+
+    void Set(int login, int slot) {
+        if (login < 0) {
+            return;
+        }
+        size_t page = (size_t)login >> PAGE_BITS;
+        if (page >= m_pages.size()) {
+            m_pages.resize(page + 1);
+        }
+        if (!m_pages[page]) {
+            m_pages[page].reset(new int[PAGE_SIZE]);
+            std::fill(m_pages[page].get(), m_pages[page].get() + PAGE_SIZE, -1);
+        }
+        m_pages[page][login & PAGE_MASK] = slot;
+    }
+
+    void Erase(int login) {
+        if (Find(login) >= 0) {
+            m_pages[(size_t)login >> PAGE_BITS][login & PAGE_MASK] = -1;
+        }
+    }
+
+    void Reserve(size_t) {}
+
+    // Pages are kept; a reload usually refills the same login range
+    void Clear() {
+        for (auto& page : m_pages) {
+            if (page) {
+                std::fill(page.get(), page.get() + PAGE_SIZE, -1);
+            }
+        }
+    }
+
+private:
+    enum {
+        PAGE_BITS = 10,
+        PAGE_SIZE = 1 << PAGE_BITS,
+        PAGE_MASK = PAGE_SIZE - 1
+    };
+
+    std::vector<std::unique_ptr<int[]>> m_pages;
+};
@@ -3,38 +3,230 @@
 #include <time.h>
 #include "MT4Wrapper.h"
 #include "../MT4ManagerAPI.h"
+#include "JsonWriter.h"
+#include "RecordFields.h"
+#include "Mirror.h"
+#include "ConnectionPool.h"
+#include "RequestQueue.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <string>
-#include <sstream>
 #include <memory>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include <cmath>
 #include <cstring>
+#include <climits>
 
-// Global manager instance
-static CManagerInterface* g_pManager = nullptr;
 static CManagerFactory* g_pFactory = nullptr;  // MUST keep factory alive!
-static std::string g_lastError;
-static bool g_initialized = false;
+static MT4_Context g_defaultContext;           // what MT4_Initialize creates
+static std::mutex g_contextLock;               // guards g_contexts
+static std::vector<MT4_Context*> g_contexts;   // from MT4_CreateContext
+static std::atomic<bool> g_initialized{ false };   // read by pool callers, workers and helpers
 static bool g_bypassMode = false;  // Bypass mode to prevent crashes
 static bool g_mockConnected = false;  // Mock connection state
 
+// Per thread, so concurrent callers never see each other's errors and the
+// pointer MT4_GetLastError returns stays valid until the thread's next call
+static thread_local std::string t_lastError;
+static thread_local MT4_Context* t_context = nullptr;   // NULL: the default context
+
+static void CloseAllCursors();
+static void CloseCursors(CManagerInterface* owner);
+
+// MT4_CreateContext contexts outlive MT4_DestroyContext and MT4_Shutdown while
+// a thread is still bound to them: those only release the manager, and a bound
+// thread's calls fail until it binds another context or none.
+static void RetainContext(MT4_Context* context) {
+    if (context) {
+        context->references++;
+    }
+}
+
+static void ReleaseContext(MT4_Context* context) {
+    if (context && --context->references == 0) {
+        delete context;
+    }
+}
+
+// Caller holds a reference to context (or it is NULL), which becomes the thread's
+static void BindThread(MT4_Context* context) {
+    MT4_Context* previous = t_context;
+    t_context = context;
+    ReleaseContext(previous);
+}
+
 // Helper to set error message
 static void SetError(const char* error) {
-    g_lastError = error ? error : "";
+    t_lastError = error ? error : "";
 }
 
 // Safe wrapper for IsConnected check
-static bool SafeIsConnected() {
-    if (!g_initialized || !g_pManager) {
+static bool SafeIsConnected(CManagerInterface* manager) {
+    if (!g_initialized || !manager) {
         return false;
     }
     try {
-        return g_pManager->IsConnected() ? true : false;
+        return manager->IsConnected() ? true : false;
     }
     catch (...) {
         return false;
     }
 }
 
+// The context one export call runs on, locked for the lifetime of the object:
+// the thread's bound context, else a pooled connection while the pool runs, else
+// the default one. BOUND calls (connection management) never go to the pool;
+// DEALING calls (trade transactions) take a dealing connection when there are any.
+// A pooled connection that dropped is reconnected or passed over; any other call
+// whose context is not connected gets no manager, so it fails with
+// MT4_ERROR_NOT_CONNECTED rather than reading an empty result.
+// Exports the mirror can answer construct one only on their server fallback.
+class ContextCall {
+public:
+    enum Route {
+        POOLED,
+        DEALING,
+        BOUND
+    };
+
+    explicit ContextCall(Route route = POOLED) {
+        auto start = std::chrono::steady_clock::now();
+        if (!t_context && route == DEALING) {
+            TakePooled(g_dealing);
+        }
+        if (!t_context && route != BOUND && !m_pooled && !m_busy) {
+            TakePooled(g_pool);
+        }
+        if (m_busy) {
+            return;
+        }
+        m_context = m_pooled ? m_pooled : (t_context ? t_context : &g_defaultContext);
+        if (!m_lock.owns_lock()) {
+            m_lock = std::unique_lock<std::mutex>(m_context->lock);
+        }
+        m_context->RecordWait(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count());
+        m_offline = route != BOUND && g_initialized && m_context->manager
+            && !SafeIsConnected(m_context->manager);
+    }
+
+    ~ContextCall() {
+        if (m_lock.owns_lock()) {
+            m_lock.unlock();
+        }
+        if (m_pooled) {
+            m_pool->Release(m_pooled);
+        }
+    }
+
+    ContextCall(const ContextCall&) = delete;
+    ContextCall& operator=(const ContextCall&) = delete;
+
+    CManagerInterface* Manager() const { return m_context && !m_offline ? m_context->manager : nullptr; }
+
+    // Error for a call that got no manager
+    int Unavailable() const {
+        if (m_busy) {
+            SetError(m_pool == &g_dealing ? "All dealing connections busy" : "All pool connections busy");
+            return MT4_ERROR_BUSY;
+        }
+        if (m_offline) {
+            SetError("Not connected to MT4 server");
+            return MT4_ERROR_NOT_CONNECTED;
+        }
+        if (m_context && m_context == t_context) {
+            SetError("Thread context was destroyed");
+            return MT4_ERROR_NOT_INITIALIZED;
+        }
+        SetError("Not initialized");
+        return MT4_ERROR_NOT_INITIALIZED;
+    }
+
+private:
+    enum { REVIVE_ATTEMPTS = 3 };
+
+    // Leaves m_pooled acquired and locked, or null once the pool has no live
+    // connection to offer (each failed one is marked down, so Acquire moves on)
+    void TakePooled(ConnectionPool& pool) {
+        m_pool = &pool;
+        for (int attempt = 0; attempt < REVIVE_ATTEMPTS; attempt++) {
+            m_pooled = pool.Acquire(m_busy);
+            if (!m_pooled) {
+                return;
+            }
+            m_lock = std::unique_lock<std::mutex>(m_pooled->lock);
+            if (pool.Revive(m_pooled)) {
+                return;
+            }
+            m_lock.unlock();
+            pool.Release(m_pooled);
+            m_pooled = nullptr;
+        }
+    }
+
+    MT4_Context* m_context = nullptr;
+    MT4_Context* m_pooled = nullptr;
+    ConnectionPool* m_pool = nullptr;
+    bool m_busy = false;
+    bool m_offline = false;
+    std::unique_lock<std::mutex> m_lock;
+};
+
+// Terminates writer output and maps an overflow to the buffer error code.
+// requiredSize (optional) receives the exact buffer size the document needs.
+static int FinishJson(JsonWriter& json, int* requiredSize = nullptr, const char* overflowError = "Buffer too small") {
+    if (requiredSize) {
+        *requiredSize = json.Required();
+    }
+    if (!json.Finish()) {
+        SetError(overflowError);
+        return MT4_ERROR_BUFFER_TOO_SMALL;
+    }
+    SetError("");
+    return MT4_SUCCESS;
+}
+
+// Writes "[]" for list exports that found nothing
+static int EmptyJsonArray(char* buffer, int bufferSize, int* requiredSize) {
+    JsonWriter json(buffer, bufferSize);
+    json.BeginArray().EndArray();
+    return FinishJson(json, requiredSize);
+}
+
+// Owns an array the manager API allocated and MemFrees it on scope exit, so a
+// throw between the request and the release does not leak it
+template <typename Record>
+class ManagerArray {
+public:
+    ManagerArray(CManagerInterface* manager, Record* records)
+        : m_manager(manager),
+          m_records(records) {
+    }
+    ~ManagerArray() {
+        if (m_records) {
+            m_manager->MemFree(m_records);
+        }
+    }
+    ManagerArray(const ManagerArray&) = delete;
+    ManagerArray& operator=(const ManagerArray&) = delete;
+
+    Record* Get() const { return m_records; }
+
+private:
+    CManagerInterface* m_manager;
+    Record* m_records;
+};
+
+// What the mirror holds as a trade: a position or pending order not yet closed.
+// Server lookups by ticket also return closed trades and balance operations.
+static bool IsOpenTrade(const TradeRecord& trade) {
+    return trade.cmd <= OP_SELL_STOP && trade.close_time == 0;
+}
+
 MT4WRAPPER_API int MT4_Initialize() {
     if (g_initialized) {
         SetError("Already initialized");
@@ -67,9 +259,9 @@ MT4WRAPPER_API int MT4_Initialize() {
         g_pFactory->WinsockStartup();
         
         // Create the manager instance
-        g_pManager = g_pFactory->Create(ManAPIVersion);
+        g_defaultContext.manager = g_pFactory->Create(ManAPIVersion);
         
-        if (!g_pManager) {
+        if (!g_defaultContext.manager) {
             delete g_pFactory;
             g_pFactory = nullptr;
             WSACleanup();
@@ -102,12 +294,45 @@ MT4WRAPPER_API int MT4_Initialize() {
 }
 
 MT4WRAPPER_API void MT4_Shutdown() {
-    if (g_pManager) {
-        g_pManager->Release();
-        g_pManager = nullptr;
+    // Calls starting from here fail as not initialized
+    g_initialized = false;
+
+    // Queued calls run on the connections released below
+    g_requests.Stop();
+    g_requests.ClearCompletions();
+
+    // Cursors hold manager-allocated arrays
+    CloseAllCursors();
+
+    // The mirror's pumping connection and the pool come from the same factory
+    g_mirror.Stop();
+    g_pool.Stop(nullptr);
+    g_dealing.Stop(nullptr);
+    g_groups.Clear();
+
+    // Threads still bound keep their context allocated, without a manager
+    std::unique_lock<std::mutex> contexts(g_contextLock);
+    std::vector<MT4_Context*> owned;
+    owned.swap(g_contexts);
+    contexts.unlock();
+    BindThread(nullptr);
+    for (MT4_Context* context : owned) {
+        {
+            std::lock_guard<std::mutex> lock(context->lock);
+            if (context->manager) {
+                context->manager->Release();
+                context->manager = nullptr;
+            }
+        }
+        ReleaseContext(context);
+    }
+
+    if (g_defaultContext.manager) {
+        g_defaultContext.manager->Release();
+        g_defaultContext.manager = nullptr;
     }
     
-    // Clean up the factory AFTER releasing the manager
+    // Clean up the factory AFTER releasing the managers
     // The factory destructor will unload the DLL
     if (g_pFactory) {
         g_pFactory->WinsockCleanup();
@@ -115,7 +340,6 @@ MT4WRAPPER_API void MT4_Shutdown() {
         g_pFactory = nullptr;
     }
     
-    g_initialized = false;
     g_mockConnected = false;
     SetError("");
     
@@ -124,9 +348,10 @@ MT4WRAPPER_API void MT4_Shutdown() {
 }
 
 MT4WRAPPER_API int MT4_Connect(const char* server) {
-    if (!g_initialized || !g_pManager) {
-        SetError("Not initialized");
-        return MT4_ERROR_NOT_INITIALIZED;
+    ContextCall call(ContextCall::BOUND);
+    CManagerInterface* manager = call.Manager();
+    if (!g_initialized || !manager) {
+        return call.Unavailable();
     }
 
     if (!server) {
@@ -143,20 +368,20 @@ MT4WRAPPER_API int MT4_Connect(const char* server) {
         // Set working directory first (may be required by some MT4 Manager versions)
         char currentPath[MAX_PATH] = {0};
         if (GetCurrentDirectoryA(MAX_PATH, currentPath) > 0) {
-            g_pManager->WorkingDirectory(currentPath);
+            manager->WorkingDirectory(currentPath);
         }
         
         // Add a small delay to ensure initialization is complete
         Sleep(100);
         
         // MT4 Manager API expects just IP:port format
-        int result = g_pManager->Connect(serverCopy);
+        int result = manager->Connect(serverCopy);
         if (result == RET_OK) {
             SetError("");
             return MT4_SUCCESS;
         }
 
-        const char* errorDesc = g_pManager->ErrorDescription(result);
+        const char* errorDesc = manager->ErrorDescription(result);
         SetError(errorDesc ? errorDesc : "Connection failed");
         return MT4_ERROR_CONNECTION_FAILED;
     }
@@ -171,9 +396,10 @@ MT4WRAPPER_API int MT4_Connect(const char* server) {
 }
 
 MT4WRAPPER_API int MT4_Login(int login, const char* password) {
-    if (!g_initialized || !g_pManager) {
-        SetError("Not initialized");
-        return MT4_ERROR_NOT_INITIALIZED;
+    ContextCall call(ContextCall::BOUND);
+    CManagerInterface* manager = call.Manager();
+    if (!g_initialized || !manager) {
+        return call.Unavailable();
     }
 
     if (!password) {
@@ -182,13 +408,13 @@ MT4WRAPPER_API int MT4_Login(int login, const char* password) {
     }
 
     try {
-        int result = g_pManager->Login(login, const_cast<char*>(password));
+        int result = manager->Login(login, const_cast<char*>(password));
         if (result == RET_OK) {
             SetError("");
             return MT4_SUCCESS;
         }
 
-        const char* errorDesc = g_pManager->ErrorDescription(result);
+        const char* errorDesc = manager->ErrorDescription(result);
         SetError(errorDesc ? errorDesc : "Login failed");
         return MT4_ERROR_LOGIN_FAILED;
     }
@@ -203,13 +429,14 @@ MT4WRAPPER_API int MT4_Login(int login, const char* password) {
 }
 
 MT4WRAPPER_API int MT4_Disconnect() {
-    if (!g_initialized || !g_pManager) {
-        SetError("Not initialized");
-        return MT4_ERROR_NOT_INITIALIZED;
+    ContextCall call(ContextCall::BOUND);
+    CManagerInterface* manager = call.Manager();
+    if (!g_initialized || !manager) {
+        return call.Unavailable();
     }
 
     try {
-        int result = g_pManager->Disconnect();
+        int result = manager->Disconnect();
         SetError("");
         return (result == RET_OK) ? MT4_SUCCESS : MT4_ERROR_INTERNAL;
     }
@@ -220,26 +447,28 @@ MT4WRAPPER_API int MT4_Disconnect() {
 }
 
 MT4WRAPPER_API int MT4_IsConnected() {
-    return SafeIsConnected() ? 1 : 0;
+    ContextCall call(ContextCall::BOUND);
+    return SafeIsConnected(call.Manager()) ? 1 : 0;
 }
 
 MT4WRAPPER_API const char* MT4_GetLastError() {
-    return g_lastError.c_str();
+    return t_lastError.c_str();
 }
 
 MT4WRAPPER_API int MT4_Ping() {
-    if (!g_initialized || !g_pManager) {
-        SetError("Not initialized");
-        return MT4_ERROR_NOT_INITIALIZED;
+    ContextCall call(ContextCall::BOUND);
+    CManagerInterface* manager = call.Manager();
+    if (!g_initialized || !manager) {
+        return call.Unavailable();
     }
 
-    if (!SafeIsConnected()) {
+    if (!SafeIsConnected(manager)) {
         SetError("Not connected");
         return MT4_ERROR_NOT_CONNECTED;
     }
 
     try {
-        int result = g_pManager->Ping();
+        int result = manager->Ping();
         return (result == RET_OK) ? MT4_SUCCESS : MT4_ERROR_INTERNAL;
     }
     catch (...) {
@@ -248,8 +477,87 @@ MT4WRAPPER_API int MT4_Ping() {
     }
 }
 
+MT4WRAPPER_API MT4_Context* MT4_CreateContext() {
+    if (!g_initialized || !g_pFactory) {
+        SetError("Not initialized");
+        return nullptr;
+    }
+
+    try {
+        CManagerInterface* manager = g_pFactory->Create(ManAPIVersion);
+        if (!manager) {
+            SetError("Failed to create manager instance");
+            return nullptr;
+        }
+
+        MT4_Context* context = new MT4_Context();
+        context->manager = manager;
+
+        std::lock_guard<std::mutex> guard(g_contextLock);
+        g_contexts.push_back(context);
+        SetError("");
+        return context;
+    }
+    catch (const std::exception& e) {
+        SetError(e.what());
+        return nullptr;
+    }
+    catch (...) {
+        SetError("Unknown error creating context");
+        return nullptr;
+    }
+}
+
+MT4WRAPPER_API int MT4_DestroyContext(MT4_Context* context) {
+    std::unique_lock<std::mutex> contexts(g_contextLock);
+    auto it = std::find(g_contexts.begin(), g_contexts.end(), context);
+    if (it == g_contexts.end()) {
+        SetError("Unknown context");
+        return MT4_ERROR_INVALID_PARAMETER;
+    }
+    g_contexts.erase(it);
+    contexts.unlock();
+
+    if (t_context == context) {
+        BindThread(nullptr);
+    }
+
+    {
+        // Waits out a call still running on the context
+        std::lock_guard<std::mutex> lock(context->lock);
+        CloseCursors(context->manager);
+        try {
+            context->manager->Disconnect();
+        }
+        catch (...) {
+        }
+        context->manager->Release();
+        context->manager = nullptr;
+    }
+    // Other threads bound to it keep it until they rebind
+    ReleaseContext(context);
+
+    SetError("");
+    return MT4_SUCCESS;
+}
+
+MT4WRAPPER_API int MT4_SetThreadContext(MT4_Context* context) {
+    if (context) {
+        // Listed contexts hold their owner reference, so taking one here is safe
+        std::lock_guard<std::mutex> guard(g_contextLock);
+        if (std::find(g_contexts.begin(), g_contexts.end(), context) == g_contexts.end()) {
+            SetError("Unknown context");
+            return MT4_ERROR_INVALID_PARAMETER;
+        }
+        RetainContext(context);
+    }
+    BindThread(context);
+    SetError("");
+    return MT4_SUCCESS;
+}
+
 MT4WRAPPER_API int MT4_GetUserInfo(int login, char* buffer, int bufferSize) {
-    if (!g_initialized || !g_pManager) {
+    if (!g_initialized) {
         SetError("Not initialized");
         return MT4_ERROR_NOT_INITIALIZED;
     }
@@ -260,34 +568,33 @@ MT4WRAPPER_API int MT4_GetUserInfo(int login, char* buffer, int bufferSize) {
     }
 
     try {
+        UserRecord cached;
+        bool found = false;
+        if (g_mirror.FindUser(login, cached, found)) {
+            if (!found) {
+                SetError("User not found");
+                return MT4_ERROR_INTERNAL;
+            }
+            JsonWriter json(buffer, bufferSize);
+            WriteRecord(json, cached);
+            return FinishJson(json);
+        }
+
+        ContextCall call;
+        CManagerInterface* manager = call.Manager();
+        if (!manager) {
+            return call.Unavailable();
+        }
+
         int logins[] = { login };
         int total = 0;
-        UserRecord* users = g_pManager->UserRecordsRequest(logins, &total);
-        
-        if (users && total > 0) {
-            // Convert to JSON
-            std::stringstream json;
-            json << "{\"login\":" << users[0].login
-                 << ",\"name\":\"" << users[0].name << "\""
-                 << ",\"email\":\"" << users[0].email << "\""
-                 << ",\"balance\":" << users[0].balance
-                 << ",\"credit\":" << users[0].credit
-                 << ",\"leverage\":" << users[0].leverage
-                 << ",\"group\":\"" << users[0].group << "\"}";
-            
-            std::string result = json.str();
-            if (result.length() >= (size_t)bufferSize) {
-                g_pManager->MemFree(users);
-                SetError("Buffer too small");
-                return MT4_ERROR_BUFFER_TOO_SMALL;
-            }
-            
-            strcpy_s(buffer, bufferSize, result.c_str());
-            g_pManager->MemFree(users);
-            SetError("");
-            return MT4_SUCCESS;
+        ManagerArray<UserRecord> users(manager, manager->UserRecordsRequest(logins, &total));
+        if (users.Get() && total > 0) {
+            JsonWriter json(buffer, bufferSize);
+            WriteRecord(json, users.Get()[0]);
+            return FinishJson(json);
         }
-        
+
         SetError("User not found");
         return MT4_ERROR_INTERNAL;
     }
@@ -301,52 +608,206 @@ MT4WRAPPER_API int MT4_GetUserInfo(int login, char* buffer, int bufferSize) {
     }
 }
 
-MT4WRAPPER_API int MT4_GetAllUsers(char* buffer, int bufferSize) {
-    if (!g_initialized || !g_pManager) {
+// Builds a field mask for the list exports from a comma-separated key list
+template <typename Record>
+static int ParseFieldMask(const char* fields, unsigned long long* mask) {
+    const char* badKey = nullptr;
+    size_t badLength = 0;
+    if (!ParseFieldList<Record>(fields, *mask, &badKey, &badLength)) {
+        SetError(("Unknown field: " + std::string(badKey, badLength)).c_str());
+        return MT4_ERROR_INVALID_PARAMETER;
+    }
+    if (*mask == 0) {
+        SetError("Empty field list");
+        return MT4_ERROR_INVALID_PARAMETER;
+    }
+    SetError("");
+    return MT4_SUCCESS;
+}
+
+MT4WRAPPER_API int MT4_ParseFieldMask(int recordType, const char* fields, unsigned long long* mask) {
+    if (!fields || !mask) {
+        SetError("Invalid parameters");
+        return MT4_ERROR_INVALID_PARAMETER;
+    }
+
+    switch (recordType) {
+    case MT4_RECORD_USER:
+        return ParseFieldMask<UserRecord>(fields, mask);
+    case MT4_RECORD_TRADE:
+        return ParseFieldMask<TradeRecord>(fields, mask);
+    case MT4_RECORD_SYMBOL:
+        return ParseFieldMask<ConSymbol>(fields, mask);
+    case MT4_RECORD_GROUP:
+        return ParseFieldMask<ConGroup>(fields, mask);
+    default:
+        SetError("Unknown record type");
+        return MT4_ERROR_INVALID_PARAMETER;
+    }
+}
+
+// Record counts of the last full lists the server returned, by MT4_RECORD_*, for
+// size estimates while the mirror is not answering
+static std::atomic<int> g_listCounts[MT4_RECORD_GROUP + 1];
+
+static void RememberListCount(int recordType, int total) {
+    g_listCounts[recordType] = total > 0 ? total : 0;
+}
+
+// Records of recordType a full list holds right now, as far as the wrapper knows
+static int KnownListCount(int recordType) {
+    int users = -1;
+    int trades = -1;
+    int symbols = -1;
+    if (g_mirror.GetState() == PumpingMirror::READY) {
+        g_mirror.Counts(&users, &trades, &symbols, nullptr);
+    }
+
+    switch (recordType) {
+    case MT4_RECORD_USER:
+        return users >= 0 ? users : g_listCounts[recordType].load();
+    case MT4_RECORD_TRADE:
+        return trades >= 0 ? trades : g_listCounts[recordType].load();
+    case MT4_RECORD_SYMBOL:
+        return symbols >= 0 ? symbols : g_listCounts[recordType].load();
+    case MT4_RECORD_GROUP:
+        return g_groups.Count();
+    default:
+        return 0;
+    }
+}
+
+// Estimated list size in bytes, terminator included; 0 for an unknown type
+static long long EstimateListJson(int recordType, unsigned long long fieldMask) {
+    size_t perRecord = 0;
+    switch (recordType) {
+    case MT4_RECORD_USER:
+        perRecord = EstimateRecordJson<UserRecord>(fieldMask);
+        break;
+    case MT4_RECORD_TRADE:
+        perRecord = EstimateRecordJson<TradeRecord>(fieldMask);
+        break;
+    case MT4_RECORD_SYMBOL:
+        perRecord = EstimateRecordJson<ConSymbol>(fieldMask);
+        break;
+    case MT4_RECORD_GROUP:
+        perRecord = EstimateRecordJson<ConGroup>(fieldMask);
+        break;
+    default:
+        return 0;
+    }
+    return (long long)KnownListCount(recordType) * (long long)perRecord + 3;
+}
+
+MT4WRAPPER_API int MT4_EstimateJsonSize(int recordType, unsigned long long fieldMask, int* estimatedSize) {
+    if (!estimatedSize) {
+        SetError("Invalid parameters");
+        return MT4_ERROR_INVALID_PARAMETER;
+    }
+
+    long long estimate = EstimateListJson(recordType, fieldMask);
+    if (estimate <= 0) {
+        SetError("Unknown record type");
+        return MT4_ERROR_INVALID_PARAMETER;
+    }
+    *estimatedSize = (int)std::min<long long>(estimate, INT_MAX);
+    SetError("");
+    return MT4_SUCCESS;
+}
+
+// JSON array body shared by the manager- and mirror-backed list exports
+template <typename Record>
+static int WriteJsonArray(const Record* records, int total, unsigned long long fieldMask,
+    char* buffer, int bufferSize, int* requiredSize) {
+    if (!records || total <= 0) {
+        return EmptyJsonArray(buffer, bufferSize, requiredSize);
+    }
+
+    JsonWriter json(buffer, bufferSize);
+    json.BeginArray();
+    for (int i = 0; i < total; i++) {
+        WriteRecord(json, records[i], fieldMask);
+    }
+    json.EndArray();
+    return FinishJson(json, requiredSize);
+}
+
+// Delta document: {"version":N,"full":bool,"changed":[records],"removed":[keys]}
+template <typename Record>
+static int WriteDeltaJson(const RecordDelta<Record>& delta, unsigned long long fieldMask,
+    char* buffer, int bufferSize, int* requiredSize) {
+    JsonWriter json(buffer, bufferSize);
+    json.BeginObject()
+        .Key("version").Int((long long)delta.version)
+        .Key("full").Bool(delta.full)
+        .Key("changed").BeginArray();
+    for (const Record* record : delta.changed) {
+        WriteRecord(json, *record, fieldMask);
+    }
+    json.EndArray().Key("removed").BeginArray();
+    for (int key : delta.removed) {
+        json.Int(key);
+    }
+    json.EndArray().EndObject();
+    return FinishJson(json, requiredSize);
+}
+
+// Without the mirror there is no change history: a full snapshot at version 0
+template <typename Record>
+static int WriteSnapshotDelta(const Record* records, int total, unsigned long long fieldMask,
+    char* buffer, int bufferSize, int* requiredSize) {
+    RecordDelta<Record> delta;
+    delta.full = true;
+    for (int i = 0; records && i < total; i++) {
+        delta.changed.push_back(records + i);
+    }
+    return WriteDeltaJson(delta, fieldMask, buffer, bufferSize, requiredSize);
+}
+
+// User record shared by user cursors and streams
+static void WriteUserListItem(JsonWriter& json, const UserRecord& user) {
+    WriteRecord(json, user);
+}
+
+// Trade record shared by trade cursors and streams
+static void WriteTradeItem(JsonWriter& json, const TradeRecord& trade) {
+    WriteRecord(json, trade);
+}
+
+MT4WRAPPER_API int MT4_GetAllUsers(unsigned long long fieldMask, char* buffer, int bufferSize, int* requiredSize) {
+    if (!g_initialized) {
         SetError("Not initialized");
         return MT4_ERROR_NOT_INITIALIZED;
     }
 
-    if (!buffer || bufferSize <= 0) {
+    if (bufferSize < 0 || (!buffer && bufferSize > 0)) {
         SetError("Invalid buffer parameter");
         return MT4_ERROR_INVALID_PARAMETER;
     }
 
     try {
+        int rc = MT4_SUCCESS;
+        if (g_mirror.ReadUsers([&](const UserRecord* users, int total) {
+                rc = WriteJsonArray(users, total, fieldMask, buffer, bufferSize, requiredSize);
+            })) {
+            return rc;
+        }
+
+        ContextCall call;
+        CManagerInterface* manager = call.Manager();
+        if (!manager) {
+            return call.Unavailable();
+        }
+
         int total = 0;
-        UserRecord* users = g_pManager->UsersRequest(&total);
+        UserRecord* users = manager->UsersRequest(&total);
+        RememberListCount(MT4_RECORD_USER, total);
+        rc = WriteJsonArray(users, total, fieldMask, buffer, bufferSize, requiredSize);
         
-        if (users && total > 0) {
-            // Convert to JSON array
-            std::stringstream json;
-            json << "[";
-            
-            for (int i = 0; i < total && i < 100; i++) { // Limit to 100 users for safety
-                if (i > 0) json << ",";
-                json << "{\"login\":" << users[i].login
-                     << ",\"name\":\"" << users[i].name << "\""
-                     << ",\"balance\":" << users[i].balance << "}";
-            }
-            
-            json << "]";
-            
-            std::string result = json.str();
-            if (result.length() >= (size_t)bufferSize) {
-                g_pManager->MemFree(users);
-                SetError("Buffer too small");
-                return MT4_ERROR_BUFFER_TOO_SMALL;
-            }
-            
-            strcpy_s(buffer, bufferSize, result.c_str());
-            g_pManager->MemFree(users);
-            SetError("");
-            return MT4_SUCCESS;
+        if (users) {
+            manager->MemFree(users);
         }
-        
-        // Return empty array if no users
-        strcpy_s(buffer, bufferSize, "[]");
-        SetError("");
-        return MT4_SUCCESS;
+        return rc;
     }
     catch (const std::exception& e) {
         SetError(e.what());
@@ -358,62 +819,51 @@ MT4WRAPPER_API int MT4_GetAllUsers(char* buffer, int bufferSize) {
     }
 }
 
-MT4WRAPPER_API int MT4_GetTrades(int login, char* buffer, int bufferSize) {
-    if (!g_initialized || !g_pManager) {
+MT4WRAPPER_API int MT4_GetTrades(int login, unsigned long long fieldMask, char* buffer, int bufferSize, int* requiredSize) {
+    if (!g_initialized) {
         SetError("Not initialized");
         return MT4_ERROR_NOT_INITIALIZED;
     }
 
-    if (!buffer || bufferSize <= 0) {
+    if (bufferSize < 0 || (!buffer && bufferSize > 0)) {
         SetError("Invalid buffer parameter");
         return MT4_ERROR_INVALID_PARAMETER;
     }
 
     try {
+        int rc = MT4_SUCCESS;
+
+        // The mirror holds open trades only; per-user history still comes from the server
+        if (login <= 0 && g_mirror.ReadTrades([&](const TradeRecord* trades, int total) {
+                rc = WriteJsonArray(trades, total, fieldMask, buffer, bufferSize, requiredSize);
+            })) {
+            return rc;
+        }
+
+        ContextCall call;
+        CManagerInterface* manager = call.Manager();
+        if (!manager) {
+            return call.Unavailable();
+        }
+
         int total = 0;
         TradeRecord* trades = nullptr;
         
         if (login > 0) {
             // Get trades for specific user - using correct method name
-            trades = g_pManager->TradesUserHistory(login, 0, time(NULL), &total);
+            trades = manager->TradesUserHistory(login, 0, time(NULL), &total);
         } else {
             // Get all trades
-            trades = g_pManager->TradesRequest(&total);
+            trades = manager->TradesRequest(&total);
+            RememberListCount(MT4_RECORD_TRADE, total);
         }
         
-        if (trades && total > 0) {
-            // Convert to JSON array
-            std::stringstream json;
-            json << "[";
-            
-            for (int i = 0; i < total && i < 100; i++) { // Limit to 100 trades for safety
-                if (i > 0) json << ",";
-                json << "{\"order\":" << trades[i].order
-                     << ",\"login\":" << trades[i].login
-                     << ",\"symbol\":\"" << trades[i].symbol << "\""
-                     << ",\"volume\":" << trades[i].volume
-                     << ",\"profit\":" << trades[i].profit << "}";
-            }
-            
-            json << "]";
-            
-            std::string result = json.str();
-            if (result.length() >= (size_t)bufferSize) {
-                g_pManager->MemFree(trades);
-                SetError("Buffer too small");
-                return MT4_ERROR_BUFFER_TOO_SMALL;
-            }
-            
-            strcpy_s(buffer, bufferSize, result.c_str());
-            g_pManager->MemFree(trades);
-            SetError("");
-            return MT4_SUCCESS;
-        }
+        rc = WriteJsonArray(trades, total, fieldMask, buffer, bufferSize, requiredSize);
         
-        // Return empty array if no trades
-        strcpy_s(buffer, bufferSize, "[]");
-        SetError("");
-        return MT4_SUCCESS;
+        if (trades) {
+            manager->MemFree(trades);
+        }
+        return rc;
     }
     catch (const std::exception& e) {
         SetError(e.what());
@@ -425,205 +875,478 @@ MT4WRAPPER_API int MT4_GetTrades(int login, char* buffer, int bufferSize) {
     }
 }
 
-MT4WRAPPER_API int MT4_OpenTrade(int login, const char* symbol, int cmd, double volume, 
-    double price, double stoploss, double takeprofit, const char* comment, char* buffer, int bufferSize) {
-    
-    if (!g_initialized || !g_pManager) {
+MT4WRAPPER_API int MT4_GetUsersSince(unsigned long long version, unsigned long long fieldMask,
+    char* buffer, int bufferSize, int* requiredSize) {
+    if (!g_initialized) {
         SetError("Not initialized");
         return MT4_ERROR_NOT_INITIALIZED;
     }
 
-    if (!symbol || !buffer || bufferSize <= 0) {
-        SetError("Invalid parameters");
+    if (bufferSize < 0 || (!buffer && bufferSize > 0)) {
+        SetError("Invalid buffer parameter");
         return MT4_ERROR_INVALID_PARAMETER;
     }
 
-    if (!SafeIsConnected()) {
-        SetError("Not connected");
-        return MT4_ERROR_NOT_CONNECTED;
-    }
-
     try {
-        TradeTransInfo trade = {0};
-        trade.type = cmd;
-        trade.cmd = cmd;
-        strcpy_s(trade.symbol, symbol);
-        trade.volume = (int)(volume * 100); // Convert lots to volume
-        // Note: login is not a member of TradeTransInfo in this API version
-        trade.price = price;
-        trade.sl = stoploss;
-        trade.tp = takeprofit;
-        if (comment) {
-            strncpy_s(trade.comment, comment, sizeof(trade.comment) - 1);
+        int rc = MT4_SUCCESS;
+        if (g_mirror.ReadUsersSince(version, [&](const RecordDelta<UserRecord>& delta) {
+                rc = WriteDeltaJson(delta, fieldMask, buffer, bufferSize, requiredSize);
+            })) {
+            return rc;
         }
 
-        int result = g_pManager->TradeTransaction(&trade);
-        
-        if (result == RET_OK) {
-            // Return the order number in JSON format
-            std::stringstream json;
-            json << "{\"order\":" << trade.order << "}";
-            
-            std::string resultStr = json.str();
-            if (resultStr.length() >= (size_t)bufferSize) {
-                SetError("Buffer too small");
-                return MT4_ERROR_BUFFER_TOO_SMALL;
-            }
-            
-            strcpy_s(buffer, bufferSize, resultStr.c_str());
-            SetError("");
-            return MT4_SUCCESS;
+        ContextCall call;
+        CManagerInterface* manager = call.Manager();
+        if (!manager) {
+            return call.Unavailable();
         }
 
-        const char* errorDesc = g_pManager->ErrorDescription(result);
-        SetError(errorDesc ? errorDesc : "Trade transaction failed");
-        return MT4_ERROR_INTERNAL;
+        int total = 0;
+        UserRecord* users = manager->UsersRequest(&total);
+        rc = WriteSnapshotDelta(users, total, fieldMask, buffer, bufferSize, requiredSize);
+
+        if (users) {
+            manager->MemFree(users);
+        }
+        return rc;
     }
     catch (const std::exception& e) {
         SetError(e.what());
         return MT4_ERROR_INTERNAL;
     }
     catch (...) {
-        SetError("Unknown error opening trade");
+        SetError("Unknown error");
         return MT4_ERROR_INTERNAL;
     }
 }
 
-MT4WRAPPER_API int MT4_CloseTrade(int order, double lots, double price) {
-    if (!g_initialized || !g_pManager) {
+MT4WRAPPER_API int MT4_GetTradesSince(unsigned long long version, unsigned long long fieldMask,
+    char* buffer, int bufferSize, int* requiredSize) {
+    if (!g_initialized) {
         SetError("Not initialized");
         return MT4_ERROR_NOT_INITIALIZED;
     }
 
-    if (!SafeIsConnected()) {
-        SetError("Not connected");
-        return MT4_ERROR_NOT_CONNECTED;
+    if (bufferSize < 0 || (!buffer && bufferSize > 0)) {
+        SetError("Invalid buffer parameter");
+        return MT4_ERROR_INVALID_PARAMETER;
     }
 
     try {
-        // First get the trade info
-        TradeRecord trade = {0};
-        int result = g_pManager->TradeRecordGet(order, &trade);
-        if (result != RET_OK) {
-            SetError("Trade not found");
-            return MT4_ERROR_INTERNAL;
+        int rc = MT4_SUCCESS;
+        if (g_mirror.ReadTradesSince(version, [&](const RecordDelta<TradeRecord>& delta) {
+                rc = WriteDeltaJson(delta, fieldMask, buffer, bufferSize, requiredSize);
+            })) {
+            return rc;
         }
 
-        TradeTransInfo closeTrade = {0};
-        closeTrade.type = TT_ORDER_CLOSE_BY;
-        closeTrade.cmd = OP_BUY;  // Will be adjusted based on trade type
-        closeTrade.order = order;
-        closeTrade.orderby = order;
-        closeTrade.volume = (lots > 0) ? (int)(lots * 100) : trade.volume;
-        closeTrade.price = (price > 0) ? price : trade.close_price;
-        strcpy_s(closeTrade.symbol, trade.symbol);
-
-        result = g_pManager->TradeTransaction(&closeTrade);
-        
-        if (result == RET_OK) {
-            SetError("");
-            return MT4_SUCCESS;
+        ContextCall call;
+        CManagerInterface* manager = call.Manager();
+        if (!manager) {
+            return call.Unavailable();
         }
 
-        const char* errorDesc = g_pManager->ErrorDescription(result);
-        SetError(errorDesc ? errorDesc : "Close trade failed");
-        return MT4_ERROR_INTERNAL;
+        int total = 0;
+        TradeRecord* trades = manager->TradesRequest(&total);
+        rc = WriteSnapshotDelta(trades, total, fieldMask, buffer, bufferSize, requiredSize);
+
+        if (trades) {
+            manager->MemFree(trades);
+        }
+        return rc;
     }
     catch (const std::exception& e) {
         SetError(e.what());
         return MT4_ERROR_INTERNAL;
     }
     catch (...) {
-        SetError("Unknown error closing trade");
+        SetError("Unknown error");
         return MT4_ERROR_INTERNAL;
     }
 }
 
-MT4WRAPPER_API int MT4_CreateUser(const char* jsonData, char* buffer, int bufferSize) {
-    if (!g_initialized || !g_pManager) {
-        SetError("Not initialized");
-        return MT4_ERROR_NOT_INITIALIZED;
+MT4WRAPPER_API int MT4_OpenTrade(int login, const char* symbol, int cmd, double volume, 
+    double price, double stoploss, double takeprofit, const char* comment, char* buffer, int bufferSize) {
+    
+    ContextCall call(ContextCall::DEALING);
+    CManagerInterface* manager = call.Manager();
+    if (!g_initialized || !manager) {
+        return call.Unavailable();
     }
 
-    if (!jsonData || !buffer || bufferSize <= 0) {
+    if (!symbol || !buffer || bufferSize <= 0) {
         SetError("Invalid parameters");
         return MT4_ERROR_INVALID_PARAMETER;
     }
 
-    if (!SafeIsConnected()) {
-        SetError("Not connected");
-        return MT4_ERROR_NOT_CONNECTED;
+    try {
+        TradeTransInfo trade = {0};
+        trade.type = cmd;
+        trade.cmd = cmd;
+        strcpy_s(trade.symbol, symbol);
+        trade.volume = (int)(volume * 100); // Convert lots to volume
+        // Note: login is not a member of TradeTransInfo in this API version
+        trade.price = price;
+        trade.sl = stoploss;
+        trade.tp = takeprofit;
+        if (comment) {
+            strncpy_s(trade.comment, comment, sizeof(trade.comment) - 1);
+        }
+
+        int result = manager->TradeTransaction(&trade);
+        
+        if (result == RET_OK) {
+            // Return the order number in JSON format
+            JsonWriter json(buffer, bufferSize);
+            json.BeginObject().Key("order").Int(trade.order).EndObject();
+            return FinishJson(json);
+        }
+
+        const char* errorDesc = manager->ErrorDescription(result);
+        SetError(errorDesc ? errorDesc : "Trade transaction failed");
+        return MT4_ERROR_INTERNAL;
+    }
+    catch (const std::exception& e) {
+        SetError(e.what());
+        return MT4_ERROR_INTERNAL;
+    }
+    catch (...) {
+        SetError("Unknown error opening trade");
+        return MT4_ERROR_INTERNAL;
+    }
+}
+
+// Mirrored quotes older than this are not used to price a close
+static const long long MAX_CLOSE_QUOTE_AGE_MS = 5000;
+
+// Open positions close at a price; pending orders are deleted
+static bool IsPosition(const TradeRecord& trade) {
+    return trade.cmd == OP_BUY || trade.cmd == OP_SELL;
+}
+
+// Looks the trades up in the mirror, found[i] false for tickets that are not
+// open. Its records are not repriced per tick, so a position's close_price comes
+// from its latest quote. Returns the indexes the server has to answer: all of
+// them while the mirror is not ready, else the positions without a fresh quote.
+static std::vector<int> FindMirroredTrades(const int* orders, int count,
+    std::vector<TradeRecord>& trades, std::vector<char>& found) {
+    trades.assign(count, TradeRecord());
+    found.assign(count, 0);
+
+    std::vector<int> unanswered;
+    for (int i = 0; i < count; i++) {
+        bool exists = false;
+        if (!g_mirror.FindTrade(orders[i], trades[i], exists)) {
+            unanswered.clear();
+            for (int all = 0; all < count; all++) {
+                unanswered.push_back(all);
+            }
+            return unanswered;
+        }
+        found[i] = exists;
+        if (exists && IsPosition(trades[i])) {
+            SymbolInfo quote;
+            long long ageMs = 0;
+            if (g_mirror.FindQuote(trades[i].symbol, quote, ageMs) && ageMs <= MAX_CLOSE_QUOTE_AGE_MS) {
+                trades[i].close_price = trades[i].cmd == OP_BUY ? quote.bid : quote.ask;
+            } else {
+                unanswered.push_back(i);
+            }
+        }
+    }
+    return unanswered;
+}
+
+// Reads the trades at indexes with one TradeRecordsRequest on manager; the
+// server keeps close_price current on open trades
+static void RequestTradesToClose(CManagerInterface* manager, const int* orders, const std::vector<int>& indexes,
+    std::vector<TradeRecord>& trades, std::vector<char>& found) {
+    std::vector<int> tickets;
+    tickets.reserve(indexes.size());
+    for (int i : indexes) {
+        tickets.push_back(orders[i]);
+        found[i] = 0;
+    }
+    int total = (int)tickets.size();   // in: tickets, out: records returned
+    ManagerArray<TradeRecord> records(manager, manager->TradeRecordsRequest(tickets.data(), &total));
+    if (!records.Get()) {
+        return;
+    }
+    // The request also returns closed and balance tickets
+    std::map<int, int> byOrder;
+    for (int r = 0; r < total; r++) {
+        if (IsOpenTrade(records.Get()[r])) {
+            byOrder[records.Get()[r].order] = r;
+        }
+    }
+    for (int i : indexes) {
+        auto record = byOrder.find(orders[i]);
+        if (record != byOrder.end()) {
+            trades[i] = records.Get()[record->second];
+            found[i] = 1;
+        }
+    }
+}
+
+// Open trades for a close: the mirror, then the server for what it cannot answer
+static void FindTradesToClose(CManagerInterface* manager, const int* orders, int count,
+    std::vector<TradeRecord>& trades, std::vector<char>& found) {
+    std::vector<int> unanswered = FindMirroredTrades(orders, count, trades, found);
+    if (!unanswered.empty()) {
+        RequestTradesToClose(manager, orders, unanswered, trades, found);
+    }
+}
+
+// A dealer close is not repriced by the server, so a position is never sent
+// without a price: price, else its close_price
+static bool HasClosePrice(const TradeRecord& trade, double price) {
+    return !IsPosition(trade) || price > 0 || trade.close_price > 0;
+}
+
+// Sends the dealer close for trade: a position closes at price (0: its
+// close_price), lots 0 closing it in full; a pending order is deleted.
+// Returns the server's RET_* code.
+static int SendClose(CManagerInterface* manager, const TradeRecord& trade, double lots, double price) {
+    TradeTransInfo closeTrade = {0};
+    closeTrade.type = IsPosition(trade) ? TT_BR_ORDER_CLOSE : TT_BR_ORDER_DELETE;
+    closeTrade.cmd = trade.cmd;
+    closeTrade.order = trade.order;
+    closeTrade.volume = (lots > 0) ? (int)(lots * 100) : trade.volume;
+    closeTrade.price = (price > 0) ? price : trade.close_price;
+    strcpy_s(closeTrade.symbol, trade.symbol);
+    return manager->TradeTransaction(&closeTrade);
+}
+
+MT4WRAPPER_API int MT4_CloseTrade(int order, double lots, double price) {
+    ContextCall call(ContextCall::DEALING);
+    CManagerInterface* manager = call.Manager();
+    if (!g_initialized || !manager) {
+        return call.Unavailable();
     }
 
     try {
-        // Parse JSON data to extract user fields
-        // For simplicity, we'll expect specific format
-        UserRecord user = {0};
-        
-        // Simple parsing - in production, use a proper JSON parser
-        std::string json(jsonData);
-        
-        // Extract login
-        size_t pos = json.find("\"login\":");
-        if (pos != std::string::npos) {
-            user.login = atoi(json.c_str() + pos + 8);
+        std::vector<TradeRecord> trades;
+        std::vector<char> found;
+        FindTradesToClose(manager, &order, 1, trades, found);
+        if (!found[0]) {
+            SetError("Trade not found");
+            return MT4_ERROR_INVALID_PARAMETER;
         }
+        if (!HasClosePrice(trades[0], price)) {
+            SetError("No current price for the trade's symbol");
+            return MT4_ERROR_NO_PRICE;
+        }
+
+        int result = SendClose(manager, trades[0], lots, price);
         
-        // Extract password
-        pos = json.find("\"password\":\"");
-        if (pos != std::string::npos) {
-            size_t endPos = json.find("\"", pos + 12);
-            if (endPos != std::string::npos) {
-                std::string pwd = json.substr(pos + 12, endPos - pos - 12);
-                strcpy_s(user.password, pwd.c_str());
+        if (result == RET_OK) {
+            SetError("");
+            return MT4_SUCCESS;
+        }
+
+        const char* errorDesc = manager->ErrorDescription(result);
+        SetError(errorDesc ? errorDesc : "Close trade failed");
+        return MT4_ERROR_INTERNAL;
+    }
+    catch (const std::exception& e) {
+        SetError(e.what());
+        return MT4_ERROR_INTERNAL;
+    }
+    catch (...) {
+        SetError("Unknown error closing trade");
+        return MT4_ERROR_INTERNAL;
+    }
+}
+
+MT4WRAPPER_API int MT4_CloseTradesBatch(const int* orders, int count, const double* prices, int* results) {
+    if (!g_initialized) {
+        SetError("Not initialized");
+        return MT4_ERROR_NOT_INITIALIZED;
+    }
+
+    if (count < 0 || (count > 0 && (!orders || !results))) {
+        SetError("Invalid parameters");
+        return MT4_ERROR_INVALID_PARAMETER;
+    }
+
+    for (int i = 0; i < count; i++) {
+        results[i] = MT4_ERROR_CANCELLED;
+    }
+
+    try {
+        std::vector<TradeRecord> trades;
+        std::vector<char> found;
+        std::vector<int> unanswered = FindMirroredTrades(orders, count, trades, found);
+        if (!unanswered.empty()) {
+            // A read, so it goes to the pool rather than a dealing connection
+            ContextCall call;
+            CManagerInterface* manager = call.Manager();
+            if (!manager) {
+                return call.Unavailable();
             }
+            RequestTradesToClose(manager, orders, unanswered, trades, found);
         }
-        
-        // Extract group
-        pos = json.find("\"group\":\"");
-        if (pos != std::string::npos) {
-            size_t endPos = json.find("\"", pos + 9);
-            if (endPos != std::string::npos) {
-                std::string grp = json.substr(pos + 9, endPos - pos - 9);
-                strcpy_s(user.group, grp.c_str());
+
+        std::mutex errorLock;
+        std::string firstError;
+        auto fail = [&](int index, const char* reason) {
+            std::lock_guard<std::mutex> lock(errorLock);
+            if (firstError.empty()) {
+                firstError = "Order " + std::to_string(orders[index]) + ": " + (reason ? reason : "Close trade failed");
+            }
+        };
+
+        std::vector<int> pending;
+        for (int i = 0; i < count; i++) {
+            if (!found[i]) {
+                results[i] = MT4_ERROR_INVALID_PARAMETER;
+                fail(i, "Trade not found");
+            } else if (!HasClosePrice(trades[i], prices ? prices[i] : 0)) {
+                results[i] = MT4_ERROR_NO_PRICE;
+                fail(i, "No current price for the trade's symbol");
+            } else {
+                pending.push_back(i);
             }
         }
-        
-        // Extract name
-        pos = json.find("\"name\":\"");
-        if (pos != std::string::npos) {
-            size_t endPos = json.find("\"", pos + 8);
-            if (endPos != std::string::npos) {
-                std::string nm = json.substr(pos + 8, endPos - pos - 8);
-                strcpy_s(user.name, nm.c_str());
+
+        // One lane per connection a close can run on; a thread bound to a
+        // context has only that one, and extra lanes would queue on its lock
+        int lanes = g_dealing.Size();
+        if (lanes == 0) {
+            lanes = g_pool.Size();
+        }
+        if (lanes == 0 || t_context) {
+            lanes = 1;
+        }
+        lanes = std::min(lanes, (int)pending.size());
+
+        MT4_Context* bound = t_context;
+        std::atomic<size_t> next{ 0 };
+        std::atomic<int> closed{ 0 };
+        std::atomic<bool> disconnected{ false };
+        auto lane = [&]() {
+            t_context = bound;
+            for (size_t k = next++; k < pending.size() && !disconnected; k = next++) {
+                int i = pending[k];
+                try {
+                    ContextCall call(ContextCall::DEALING);
+                    CManagerInterface* manager = call.Manager();
+                    if (!manager) {
+                        results[i] = call.Unavailable();
+                        fail(i, MT4_GetLastError());
+                        continue;
+                    }
+
+                    int result = SendClose(manager, trades[i], 0, prices ? prices[i] : 0);
+                    results[i] = result;
+                    if (result == RET_OK) {
+                        closed++;
+                        continue;
+                    }
+                    fail(i, manager->ErrorDescription(result));
+                    if (result == RET_NO_CONNECT) {
+                        disconnected = true;
+                    }
+                }
+                catch (...) {
+                    // Helper threads must not throw; the order just fails
+                    results[i] = MT4_ERROR_INTERNAL;
+                    fail(i, "Unknown error closing trade");
+                }
+            }
+        };
+
+        // The helpers use this frame's locals, so they are joined on every exit
+        struct Helpers {
+            std::vector<std::thread> threads;
+            ~Helpers() {
+                for (auto& thread : threads) {
+                    if (thread.joinable()) {
+                        thread.join();
+                    }
+                }
+            }
+        } helpers;
+        for (int l = 1; l < lanes; l++) {
+            try {
+                helpers.threads.emplace_back(lane);
+            }
+            catch (const std::exception&) {
+                break;   // fewer lanes; the running ones take the rest
             }
         }
-        
-        // Set defaults
+        lane();
+        for (auto& helper : helpers.threads) {
+            helper.join();
+        }
+
+        SetError(firstError.c_str());
+        return closed;
+    }
+    catch (const std::exception& e) {
+        SetError(e.what());
+        return MT4_ERROR_INTERNAL;
+    }
+    catch (...) {
+        SetError("Unknown error closing trades");
+        return MT4_ERROR_INTERNAL;
+    }
+}
+
+// Parses a CreateUser/UpdateUser body over user, naming the failing key in the error
+static bool ParseUserJson(const char* jsonData, UserRecord& user) {
+    JsonReader reader(jsonData);
+    const char* badKey = nullptr;
+    size_t badLength = 0;
+    if (ReadRecord(reader, user, &badKey, &badLength) && reader.End()) {
+        return true;
+    }
+
+    std::string error = reader.Error() ? reader.Error() : "Invalid JSON";
+    if (badKey) {
+        error += " (field: " + std::string(badKey, badLength) + ")";
+    }
+    SetError(error.c_str());
+    return false;
+}
+
+MT4WRAPPER_API int MT4_CreateUser(const char* jsonData, char* buffer, int bufferSize) {
+    ContextCall call;
+    CManagerInterface* manager = call.Manager();
+    if (!g_initialized || !manager) {
+        return call.Unavailable();
+    }
+
+    if (!jsonData || !buffer || bufferSize <= 0) {
+        SetError("Invalid parameters");
+        return MT4_ERROR_INVALID_PARAMETER;
+    }
+
+    try {
+        // Defaults first, so the request only has to carry what it changes
+        UserRecord user = {0};
         user.enable = 1;
         user.enable_change_password = 1;
         user.leverage = 100;
+
+        if (!ParseUserJson(jsonData, user)) {
+            return MT4_ERROR_INVALID_PARAMETER;
+        }
         
         // Create the user
-        int result = g_pManager->UserRecordNew(&user);
+        int result = manager->UserRecordNew(&user);
         
         if (result == RET_OK) {
             // Return success with the login
-            std::stringstream response;
-            response << "{\"success\":true,\"login\":" << user.login << "}";
-            
-            std::string resultStr = response.str();
-            if (resultStr.length() >= (size_t)bufferSize) {
-                SetError("Buffer too small");
-                return MT4_ERROR_BUFFER_TOO_SMALL;
-            }
-            
-            strcpy_s(buffer, bufferSize, resultStr.c_str());
-            SetError("");
-            return MT4_SUCCESS;
+            JsonWriter json(buffer, bufferSize);
+            json.BeginObject()
+                .Key("success").Bool(true)
+                .Key("login").Int(user.login)
+                .EndObject();
+            return FinishJson(json);
         }
         
-        const char* errorDesc = g_pManager->ErrorDescription(result);
+        const char* errorDesc = manager->ErrorDescription(result);
         SetError(errorDesc ? errorDesc : "Failed to create user");
         return MT4_ERROR_INTERNAL;
     }
@@ -638,9 +1361,10 @@ MT4WRAPPER_API int MT4_CreateUser(const char* jsonData, char* buffer, int buffer
 }
 
 MT4WRAPPER_API int MT4_UpdateUser(int login, const char* jsonData) {
-    if (!g_initialized || !g_pManager) {
-        SetError("Not initialized");
-        return MT4_ERROR_NOT_INITIALIZED;
+    ContextCall call;
+    CManagerInterface* manager = call.Manager();
+    if (!g_initialized || !manager) {
+        return call.Unavailable();
     }
 
     if (!jsonData) {
@@ -648,63 +1372,53 @@ MT4WRAPPER_API int MT4_UpdateUser(int login, const char* jsonData) {
         return MT4_ERROR_INVALID_PARAMETER;
     }
 
-    if (!SafeIsConnected()) {
-        SetError("Not connected");
-        return MT4_ERROR_NOT_CONNECTED;
-    }
-
     try {
         // First get the existing user
         UserRecord user = {0};
-        int result = g_pManager->UserRecordGet(login, &user);
+        int result = manager->UserRecordGet(login, &user);
         if (result != RET_OK) {
             SetError("User not found");
             return MT4_ERROR_INTERNAL;
         }
         
-        // Parse JSON and update fields
-        std::string json(jsonData);
-        
-        // Update name if provided
-        size_t pos = json.find("\"name\":\"");
-        if (pos != std::string::npos) {
-            size_t endPos = json.find("\"", pos + 8);
-            if (endPos != std::string::npos) {
-                std::string nm = json.substr(pos + 8, endPos - pos - 8);
-                strcpy_s(user.name, nm.c_str());
-            }
-        }
-        
-        // Update email if provided
-        pos = json.find("\"email\":\"");
-        if (pos != std::string::npos) {
-            size_t endPos = json.find("\"", pos + 9);
-            if (endPos != std::string::npos) {
-                std::string em = json.substr(pos + 9, endPos - pos - 9);
-                strcpy_s(user.email, em.c_str());
-            }
+        // Apply the provided fields; the login is fixed by the argument.
+        // UserRecordUpdate leaves the passwords alone, so they are cleared here to
+        // see which ones the body sets.
+        UserRecord passwords = user;
+        user.password[0] = user.password_investor[0] = user.password_phone[0] = '\0';
+        if (!ParseUserJson(jsonData, user)) {
+            return MT4_ERROR_INVALID_PARAMETER;
         }
-        
-        // Update group if provided
-        pos = json.find("\"group\":\"");
-        if (pos != std::string::npos) {
-            size_t endPos = json.find("\"", pos + 9);
-            if (endPos != std::string::npos) {
-                std::string grp = json.substr(pos + 9, endPos - pos - 9);
-                strcpy_s(user.group, grp.c_str());
-            }
+        if (user.password_phone[0]) {
+            SetError("passwordPhone cannot be changed by an update");
+            return MT4_ERROR_INVALID_PARAMETER;
         }
+        std::swap(user.password, passwords.password);
+        std::swap(user.password_investor, passwords.password_investor);
+        strcpy_s(user.password_phone, passwords.password_phone);
+        user.login = login;
         
         // Update the user
-        result = g_pManager->UserRecordUpdate(&user);
+        result = manager->UserRecordUpdate(&user);
         
+        // Then the passwords, through the call that changes them
+        const char* failed = "Failed to update user";
+        if (result == RET_OK && passwords.password[0]) {
+            result = manager->UserPasswordSet(login, passwords.password, 0, 0);
+            failed = "User updated, but not its password";
+        }
+        if (result == RET_OK && passwords.password_investor[0]) {
+            result = manager->UserPasswordSet(login, passwords.password_investor, 1, 0);
+            failed = "User updated, but not its investor password";
+        }
         if (result == RET_OK) {
             SetError("");
             return MT4_SUCCESS;
         }
         
-        const char* errorDesc = g_pManager->ErrorDescription(result);
-        SetError(errorDesc ? errorDesc : "Failed to update user");
+        const char* errorDesc = manager->ErrorDescription(result);
+        std::string error = std::string(failed) + (errorDesc ? std::string(": ") + errorDesc : "");
+        SetError(error.c_str());
         return MT4_ERROR_INTERNAL;
     }
     catch (const std::exception& e) {
@@ -717,22 +1431,114 @@ MT4WRAPPER_API int MT4_UpdateUser(int login, const char* jsonData) {
     }
 }
 
-MT4WRAPPER_API int MT4_DeleteUser(int login) {
-    if (!g_initialized || !g_pManager) {
+MT4WRAPPER_API int MT4_CreateUsersBatch(const char* jsonArray, int count, MT4CreateUserResult* results) {
+    if (!g_initialized) {
         SetError("Not initialized");
         return MT4_ERROR_NOT_INITIALIZED;
     }
 
-    if (!SafeIsConnected()) {
-        SetError("Not connected");
-        return MT4_ERROR_NOT_CONNECTED;
+    if (!jsonArray || count < 0 || (!results && count > 0)) {
+        SetError("Invalid parameters");
+        return MT4_ERROR_INVALID_PARAMETER;
+    }
+
+    for (int i = 0; i < count; i++) {
+        results[i].login = 0;
+        results[i].code = MT4_ERROR_CANCELLED;
+    }
+
+    try {
+        // The whole array is parsed before the first UserRecordNew, so a bad
+        // record or count leaves nothing half-created on the server
+        std::vector<UserRecord> users;
+        users.reserve(count);
+        JsonReader reader(jsonArray);
+        int index = 0;
+        if (reader.BeginArray()) {
+            for (; reader.NextElement(index); index++) {
+                UserRecord user = {0};
+                user.enable = 1;
+                user.enable_change_password = 1;
+                user.leverage = 100;
+
+                const char* badKey = nullptr;
+                size_t badLength = 0;
+                if (!ReadRecord(reader, user, &badKey, &badLength)) {
+                    if (index < count) {
+                        results[index].code = MT4_ERROR_INVALID_PARAMETER;
+                    }
+                    std::string error = "Record " + std::to_string(index) + ": " + reader.Error();
+                    if (badKey) {
+                        error += " (field: " + std::string(badKey, badLength) + ")";
+                    }
+                    SetError(error.c_str());
+                    return MT4_ERROR_INVALID_PARAMETER;
+                }
+                users.push_back(user);
+            }
+            reader.End();
+        }
+        if (reader.Error()) {
+            SetError(reader.Error());
+            return MT4_ERROR_INVALID_PARAMETER;
+        }
+        if ((int)users.size() != count) {
+            std::string error = std::to_string(users.size()) + " records for count " + std::to_string(count);
+            SetError(error.c_str());
+            return MT4_ERROR_INVALID_PARAMETER;
+        }
+
+        ContextCall call;
+        CManagerInterface* manager = call.Manager();
+        if (!manager) {
+            return call.Unavailable();
+        }
+
+        std::string firstError;
+        int created = 0;
+        for (int i = 0; i < count; i++) {
+            int result = manager->UserRecordNew(&users[i]);
+            results[i].login = users[i].login;
+            results[i].code = result;
+            if (result == RET_OK) {
+                created++;
+                continue;
+            }
+
+            if (firstError.empty()) {
+                const char* errorDesc = manager->ErrorDescription(result);
+                firstError = "Record " + std::to_string(i) + ": " + (errorDesc ? errorDesc : "Failed to create user");
+            }
+            if (result == RET_NO_CONNECT) {
+                break;
+            }
+        }
+
+        SetError(firstError.c_str());
+        return created;
+    }
+    catch (const std::exception& e) {
+        SetError(e.what());
+        return MT4_ERROR_INTERNAL;
+    }
+    catch (...) {
+        SetError("Unknown error creating users");
+        return MT4_ERROR_INTERNAL;
+    }
+}
+
+MT4WRAPPER_API int MT4_DeleteUser(int login) {
+    ContextCall call;
+    CManagerInterface* manager = call.Manager();
+    if (!g_initialized || !manager) {
+        return call.Unavailable();
     }
 
     try {
         // Note: MT4 Manager API doesn't have a direct delete function
         // We can disable the user instead
         UserRecord user = {0};
-        int result = g_pManager->UserRecordGet(login, &user);
+        int result = manager->UserRecordGet(login, &user);
         if (result != RET_OK) {
             SetError("User not found");
             return MT4_ERROR_INTERNAL;
@@ -740,14 +1546,14 @@ MT4WRAPPER_API int MT4_DeleteUser(int login) {
         
         // Disable the user account
         user.enable = 0;
-        result = g_pManager->UserRecordUpdate(&user);
+        result = manager->UserRecordUpdate(&user);
         
         if (result == RET_OK) {
             SetError("");
             return MT4_SUCCESS;
         }
         
-        const char* errorDesc = g_pManager->ErrorDescription(result);
+        const char* errorDesc = manager->ErrorDescription(result);
         SetError(errorDesc ? errorDesc : "Failed to disable user");
         return MT4_ERROR_INTERNAL;
     }
@@ -761,60 +1567,43 @@ MT4WRAPPER_API int MT4_DeleteUser(int login) {
     }
 }
 
-MT4WRAPPER_API int MT4_GetSymbols(char* buffer, int bufferSize) {
-    if (!g_initialized || !g_pManager) {
+MT4WRAPPER_API int MT4_GetSymbols(unsigned long long fieldMask, char* buffer, int bufferSize, int* requiredSize) {
+    if (!g_initialized) {
         SetError("Not initialized");
         return MT4_ERROR_NOT_INITIALIZED;
     }
 
-    if (!buffer || bufferSize <= 0) {
+    if (bufferSize < 0 || (!buffer && bufferSize > 0)) {
         SetError("Invalid buffer parameter");
         return MT4_ERROR_INVALID_PARAMETER;
     }
 
     try {
+        int rc = MT4_SUCCESS;
+        if (g_mirror.ReadSymbols([&](const ConSymbol* symbols, int total) {
+                rc = WriteJsonArray(symbols, total, fieldMask, buffer, bufferSize, requiredSize);
+            })) {
+            return rc;
+        }
+
+        ContextCall call;
+        CManagerInterface* manager = call.Manager();
+        if (!manager) {
+            return call.Unavailable();
+        }
+
         // Refresh symbols from server first
-        g_pManager->SymbolsRefresh();
+        manager->SymbolsRefresh();
         
-        ConSymbol* symbols = nullptr;
         int total = 0;
+        ConSymbol* symbols = manager->SymbolsGetAll(&total);
+        RememberListCount(MT4_RECORD_SYMBOL, total);
+        rc = WriteJsonArray(symbols, total, fieldMask, buffer, bufferSize, requiredSize);
         
-        symbols = g_pManager->SymbolsGetAll(&total);
-        
-        if (symbols && total > 0) {
-            // Convert to JSON array
-            std::stringstream json;
-            json << "[";
-            
-            for (int i = 0; i < total && i < 50; i++) { // Limit to 50 symbols for safety
-                if (i > 0) json << ",";
-                json << "{\"symbol\":\"" << symbols[i].symbol << "\""
-                     << ",\"description\":\"" << symbols[i].description << "\""
-                     << ",\"digits\":" << symbols[i].digits
-                     << ",\"contractSize\":" << symbols[i].contract_size
-                     << ",\"currency\":\"" << symbols[i].currency << "\""
-                     << ",\"type\":" << symbols[i].type << "}";
-            }
-            
-            json << "]";
-            
-            std::string result = json.str();
-            if (result.length() >= (size_t)bufferSize) {
-                g_pManager->MemFree(symbols);
-                SetError("Buffer too small");
-                return MT4_ERROR_BUFFER_TOO_SMALL;
-            }
-            
-            strcpy_s(buffer, bufferSize, result.c_str());
-            g_pManager->MemFree(symbols);
-            SetError("");
-            return MT4_SUCCESS;
+        if (symbols) {
+            manager->MemFree(symbols);
         }
-        
-        // Return empty array if no symbols
-        strcpy_s(buffer, bufferSize, "[]");
-        SetError("");
-        return MT4_SUCCESS;
+        return rc;
     }
     catch (const std::exception& e) {
         SetError(e.what());
@@ -826,15 +1615,91 @@ MT4WRAPPER_API int MT4_GetSymbols(char* buffer, int bufferSize) {
     }
 }
 
-MT4WRAPPER_API int MT4_GetQuote(const char* symbol, char* buffer, int bufferSize) {
-    if (!g_initialized || !g_pManager) {
+// Loads the group cache from the server the first time it is needed. While the
+// mirror pumps, it keeps the cache current and this never has to ask.
+static bool EnsureGroups(CManagerInterface* manager) {
+    if (g_groups.Loaded()) {
+        return true;
+    }
+    int total = 0;
+    ConGroup* groups = manager->GroupsRequest(&total);
+    if (!groups) {
+        return false;
+    }
+    g_groups.Assign(groups, total);
+    manager->MemFree(groups);
+    return true;
+}
+
+MT4WRAPPER_API int MT4_GetGroups(unsigned long long fieldMask, char* buffer, int bufferSize, int* requiredSize) {
+    if (!g_initialized) {
         SetError("Not initialized");
         return MT4_ERROR_NOT_INITIALIZED;
     }
 
-    if (!SafeIsConnected()) {
-        SetError("Not connected to MT4 server");
-        return MT4_ERROR_NOT_CONNECTED;
+    if (bufferSize < 0 || (!buffer && bufferSize > 0)) {
+        SetError("Invalid buffer parameter");
+        return MT4_ERROR_INVALID_PARAMETER;
+    }
+
+    try {
+        int rc = MT4_SUCCESS;
+        auto write = [&](const ConGroup* groups, int total) {
+            rc = WriteJsonArray(groups, total, fieldMask, buffer, bufferSize, requiredSize);
+        };
+        if (g_groups.Read(write)) {
+            return rc;
+        }
+
+        ContextCall call;
+        CManagerInterface* manager = call.Manager();
+        if (!manager) {
+            return call.Unavailable();
+        }
+        if (!EnsureGroups(manager)) {
+            SetError("Failed to request groups");
+            return MT4_ERROR_INTERNAL;
+        }
+        if (!g_groups.Read(write)) {
+            // Cleared by a concurrent shutdown
+            SetError("Failed to request groups");
+            return MT4_ERROR_INTERNAL;
+        }
+        return rc;
+    }
+    catch (const std::exception& e) {
+        SetError(e.what());
+        return MT4_ERROR_INTERNAL;
+    }
+    catch (...) {
+        SetError("Unknown error getting groups");
+        return MT4_ERROR_INTERNAL;
+    }
+}
+
+// Quote JSON shared by all MT4_GetQuote price sources; prices use the symbol's digits.
+// ageMs (how long ago the mirror received the quote) is only known for mirrored quotes.
+static int WriteQuoteJson(char* buffer, int bufferSize, const char* symbol,
+    double bid, double ask, int spread, int digits, long long quoteTime, long long ageMs = -1) {
+    JsonWriter json(buffer, bufferSize);
+    json.BeginObject()
+        .Key("symbol").String(symbol)
+        .Key("bid").Double(bid, digits > 0 ? digits : -1)
+        .Key("ask").Double(ask, digits > 0 ? digits : -1)
+        .Key("spread").Int(spread)
+        .Key("digits").Int(digits)
+        .Key("time").Int(quoteTime);
+    if (ageMs >= 0) {
+        json.Key("age").Int(ageMs);
+    }
+    json.EndObject();
+    return FinishJson(json, nullptr, "Buffer too small for quote data");
+}
+
+MT4WRAPPER_API int MT4_GetQuote(const char* symbol, char* buffer, int bufferSize) {
+    if (!g_initialized) {
+        SetError("Not initialized");
+        return MT4_ERROR_NOT_INITIALIZED;
     }
 
     if (!symbol || !buffer || bufferSize <= 0) {
@@ -843,50 +1708,27 @@ MT4WRAPPER_API int MT4_GetQuote(const char* symbol, char* buffer, int bufferSize
     }
 
     try {
-        // First, try to get updated symbol info with latest prices
-        SymbolInfo symbolsInfo[128];
-        int updated = g_pManager->SymbolInfoUpdated(symbolsInfo, 128);
+        // The mirror's drain thread keeps every pumped quote; no server round trip
+        SymbolInfo mirrored;
+        long long ageMs = 0;
+        if (g_mirror.FindQuote(symbol, mirrored, ageMs) && (mirrored.bid > 0 || mirrored.ask > 0)) {
+            return WriteQuoteJson(buffer, bufferSize, symbol, mirrored.bid, mirrored.ask,
+                mirrored.spread, mirrored.digits, mirrored.lasttime, ageMs);
+        }
         
-        // Look for our symbol in the updated list
-        SymbolInfo* targetSymbol = nullptr;
-        for (int i = 0; i < updated; i++) {
-            if (strcmp(symbolsInfo[i].symbol, symbol) == 0) {
-                targetSymbol = &symbolsInfo[i];
-                break;
-            }
+        ContextCall call;
+        CManagerInterface* manager = call.Manager();
+        if (!manager) {
+            return call.Unavailable();
         }
-        
-        // If found in updated symbols and has prices
-        if (targetSymbol && (targetSymbol->bid > 0 || targetSymbol->ask > 0)) {
-            std::ostringstream json;
-            json << "{";
-            json << "\"symbol\":\"" << symbol << "\",";
-            json << "\"bid\":" << targetSymbol->bid << ",";
-            json << "\"ask\":" << targetSymbol->ask << ",";
-            json << "\"spread\":" << targetSymbol->spread << ",";
-            json << "\"digits\":" << targetSymbol->digits << ",";
-            json << "\"time\":" << targetSymbol->lasttime;
-            json << "}";
-            
-            std::string result_str = json.str();
-            if (result_str.length() >= (size_t)bufferSize) {
-                SetError("Buffer too small for quote data");
-                return MT4_ERROR_BUFFER_TOO_SMALL;
-            }
-            
-            strcpy_s(buffer, bufferSize, result_str.c_str());
-            SetError("");
-            return MT4_SUCCESS;
-        }
-        
-        // Try to get last tick info for real-time prices
-        int total = 0;
-        TickInfo* ticks = g_pManager->TickInfoLast(symbol, &total);
+        // Try to get last tick info for real-time prices
+        int total = 0;
+        TickInfo* ticks = manager->TickInfoLast(symbol, &total);
         
         if (!ticks || total == 0) {
             // If no tick data, try SymbolInfoGet as last fallback
             SymbolInfo symbolInfo = {0};
-            int result = g_pManager->SymbolInfoGet(symbol, &symbolInfo);
+            int result = manager->SymbolInfoGet(symbol, &symbolInfo);
             
             if (result != RET_OK) {
                 SetError("No price data available for symbol");
@@ -894,25 +1736,8 @@ MT4WRAPPER_API int MT4_GetQuote(const char* symbol, char* buffer, int bufferSize
             }
             
             // Use SymbolInfo data
-            std::ostringstream json;
-            json << "{";
-            json << "\"symbol\":\"" << symbol << "\",";
-            json << "\"bid\":" << symbolInfo.bid << ",";
-            json << "\"ask\":" << symbolInfo.ask << ",";
-            json << "\"spread\":" << symbolInfo.spread << ",";
-            json << "\"digits\":" << symbolInfo.digits << ",";
-            json << "\"time\":" << time(NULL);
-            json << "}";
-            
-            std::string result_str = json.str();
-            if (result_str.length() >= (size_t)bufferSize) {
-                SetError("Buffer too small for quote data");
-                return MT4_ERROR_BUFFER_TOO_SMALL;
-            }
-            
-            strcpy_s(buffer, bufferSize, result_str.c_str());
-            SetError("");
-            return MT4_SUCCESS;
+            return WriteQuoteJson(buffer, bufferSize, symbol, symbolInfo.bid, symbolInfo.ask,
+                symbolInfo.spread, symbolInfo.digits, time(NULL));
         }
         
         // Use the most recent tick
@@ -920,32 +1745,249 @@ MT4WRAPPER_API int MT4_GetQuote(const char* symbol, char* buffer, int bufferSize
         
         // Get symbol info for digits
         SymbolInfo symbolInfo = {0};
-        g_pManager->SymbolInfoGet(symbol, &symbolInfo);
+        manager->SymbolInfoGet(symbol, &symbolInfo);
         
         // Create JSON response with tick data
-        std::ostringstream json;
-        json << "{";
-        json << "\"symbol\":\"" << symbol << "\",";
-        json << "\"bid\":" << tick.bid << ",";
-        json << "\"ask\":" << tick.ask << ",";
-        json << "\"spread\":" << (int)((tick.ask - tick.bid) * pow(10, symbolInfo.digits)) << ",";
-        json << "\"digits\":" << symbolInfo.digits << ",";
-        json << "\"time\":" << tick.ctm;
-        json << "}";
-
-        std::string result_str = json.str();
-        if (result_str.length() >= (size_t)bufferSize) {
-            SetError("Buffer too small for quote data");
-            return MT4_ERROR_BUFFER_TOO_SMALL;
-        }
-
-        strcpy_s(buffer, bufferSize, result_str.c_str());
+        int rc = WriteQuoteJson(buffer, bufferSize, symbol, tick.bid, tick.ask,
+            (int)((tick.ask - tick.bid) * pow(10, symbolInfo.digits)), symbolInfo.digits, tick.ctm);
         
         // Free tick memory
         if (ticks) {
-            g_pManager->MemFree(ticks);
+            manager->MemFree(ticks);
         }
         
+        return rc;
+    }
+    catch (const std::exception& e) {
+        SetError(e.what());
+        return MT4_ERROR_INTERNAL;
+    }
+    catch (...) {
+        SetError("Unknown error getting quote");
+        return MT4_ERROR_INTERNAL;
+    }
+}
+// Binary record layouts are mirrored by C# structs; keep them in sync
+static_assert(sizeof(MT4TradeData) == 136, "MT4TradeData layout changed");
+static_assert(sizeof(MT4UserData) == 448, "MT4UserData layout changed");
+static_assert(sizeof(MT4SymbolData) == 224, "MT4SymbolData layout changed");
+static_assert(sizeof(MT4QuoteData) == 72, "MT4QuoteData layout changed");
+static_assert(sizeof(MT4CreateUserResult) == 8, "MT4CreateUserResult layout changed");
+static_assert(sizeof(MT4AccountState) == 88, "MT4AccountState layout changed");
+static_assert(sizeof(MT4ExposureData) == 80, "MT4ExposureData layout changed");
+static_assert(sizeof(MT4MarginEvent) == 48, "MT4MarginEvent layout changed");
+static_assert(sizeof(MT4PoolStats) == 40, "MT4PoolStats layout changed");
+
+// Copies a fixed MT4 char array into a record field, always terminated
+template <size_t N, size_t M>
+static void CopyFixed(char (&dst)[N], const char (&src)[M]) {
+    size_t length = strnlen(src, M);
+    if (length >= N) length = N - 1;
+    memcpy(dst, src, length);
+    memset(dst + length, 0, N - length);
+}
+
+// Size negotiation shared by the binary exports
+static int CheckRecordCapacity(int available, const void* records, int maxRecords, int* total) {
+    if (total) {
+        *total = available;
+    }
+    if (available > 0 && (!records || maxRecords < available)) {
+        SetError("Buffer too small");
+        return MT4_ERROR_BUFFER_TOO_SMALL;
+    }
+    return MT4_SUCCESS;
+}
+
+// Converts source records (manager- or mirror-owned) into a binary export's array
+template <typename Out, typename In>
+static int CopyRecords(const In* source, int count, Out* records, int maxRecords, int* total,
+    void (*fill)(Out&, const In&)) {
+    if (!source) {
+        count = 0;
+    }
+    int rc = CheckRecordCapacity(count, records, maxRecords, total);
+    if (rc != MT4_SUCCESS) {
+        return rc;
+    }
+    for (int i = 0; i < count; i++) {
+        fill(records[i], source[i]);
+    }
+    SetError("");
+    return count;
+}
+
+static void FillTradeData(MT4TradeData& out, const TradeRecord& in) {
+    out.open_price = in.open_price;
+    out.close_price = in.close_price;
+    out.sl = in.sl;
+    out.tp = in.tp;
+    out.commission = in.commission;
+    out.storage = in.storage;
+    out.profit = in.profit;
+    out.order = in.order;
+    out.login = in.login;
+    out.cmd = in.cmd;
+    out.volume = in.volume;
+    out.digits = in.digits;
+    out.open_time = (int)in.open_time;
+    out.close_time = (int)in.close_time;
+    out.expiration = (int)in.expiration;
+    out.magic = in.magic;
+    CopyFixed(out.symbol, in.symbol);
+    CopyFixed(out.comment, in.comment);
+}
+
+static void FillUserData(MT4UserData& out, const UserRecord& in) {
+    out.balance = in.balance;
+    out.credit = in.credit;
+    out.prevbalance = in.prevbalance;
+    out.prevmonthbalance = in.prevmonthbalance;
+    out.prevequity = in.prevequity;
+    out.prevmonthequity = in.prevmonthequity;
+    out.login = in.login;
+    out.leverage = in.leverage;
+    out.enable = in.enable;
+    out.enable_read_only = in.enable_read_only;
+    out.agent_account = in.agent_account;
+    out.regdate = (int)in.regdate;
+    out.lastdate = (int)in.lastdate;
+    out.timestamp = (int)in.timestamp;
+    CopyFixed(out.group, in.group);
+    CopyFixed(out.name, in.name);
+    CopyFixed(out.email, in.email);
+    CopyFixed(out.country, in.country);
+    CopyFixed(out.city, in.city);
+    CopyFixed(out.phone, in.phone);
+    CopyFixed(out.status, in.status);
+    CopyFixed(out.comment, in.comment);
+}
+
+static void FillSymbolData(MT4SymbolData& out, const ConSymbol& in) {
+    out.contract_size = in.contract_size;
+    out.tick_value = in.tick_value;
+    out.tick_size = in.tick_size;
+    out.point = in.point;
+    out.margin_initial = in.margin_initial;
+    out.margin_maintenance = in.margin_maintenance;
+    out.margin_hedged = in.margin_hedged;
+    out.margin_divider = in.margin_divider;
+    out.swap_long = in.swap_long;
+    out.swap_short = in.swap_short;
+    out.type = in.type;
+    out.digits = in.digits;
+    out.trade = in.trade;
+    out.spread = in.spread;
+    out.stops_level = in.stops_level;
+    out.freeze_level = in.freeze_level;
+    out.margin_mode = in.margin_mode;
+    out.profit_mode = in.profit_mode;
+    out.swap_type = in.swap_type;
+    out.exemode = in.exemode;
+    out.long_only = in.long_only;
+    CopyFixed(out.symbol, in.symbol);
+    CopyFixed(out.description, in.description);
+    CopyFixed(out.currency, in.currency);
+    CopyFixed(out.margin_currency, in.margin_currency);
+}
+
+static void FillQuoteData(MT4QuoteData& out, const SymbolInfo& in) {
+    out.bid = in.bid;
+    out.ask = in.ask;
+    out.high = in.high;
+    out.low = in.low;
+    out.point = in.point;
+    out.digits = in.digits;
+    out.spread = in.spread;
+    out.direction = in.direction;
+    out.type = in.type;
+    out.time = (int)in.lasttime;
+    CopyFixed(out.symbol, in.symbol);
+}
+
+MT4WRAPPER_API int MT4_GetTradesBinary(int login, MT4TradeData* records, int maxRecords, int* total) {
+    if (!g_initialized) {
+        SetError("Not initialized");
+        return MT4_ERROR_NOT_INITIALIZED;
+    }
+
+    if (maxRecords < 0) {
+        SetError("Invalid buffer parameter");
+        return MT4_ERROR_INVALID_PARAMETER;
+    }
+
+    try {
+        int rc = MT4_SUCCESS;
+        if (login <= 0 && g_mirror.ReadTrades([&](const TradeRecord* trades, int count) {
+                rc = CopyRecords(trades, count, records, maxRecords, total, FillTradeData);
+            })) {
+            return rc;
+        }
+
+        ContextCall call;
+        CManagerInterface* manager = call.Manager();
+        if (!manager) {
+            return call.Unavailable();
+        }
+
+        int count = 0;
+        TradeRecord* trades = (login > 0)
+            ? manager->TradesUserHistory(login, 0, time(NULL), &count)
+            : manager->TradesRequest(&count);
+        rc = CopyRecords(trades, count, records, maxRecords, total, FillTradeData);
+
+        if (trades) {
+            manager->MemFree(trades);
+        }
+        return rc;
+    }
+    catch (const std::exception& e) {
+        SetError(e.what());
+        return MT4_ERROR_INTERNAL;
+    }
+    catch (...) {
+        SetError("Unknown error getting trades");
+        return MT4_ERROR_INTERNAL;
+    }
+}
+
+MT4WRAPPER_API int MT4_GetTradeByOrder(int order, MT4TradeData* record) {
+    if (!g_initialized) {
+        SetError("Not initialized");
+        return MT4_ERROR_NOT_INITIALIZED;
+    }
+
+    if (!record) {
+        SetError("Invalid buffer parameter");
+        return MT4_ERROR_INVALID_PARAMETER;
+    }
+
+    try {
+        TradeRecord trade;
+        bool found = false;
+        if (!g_mirror.FindTrade(order, trade, found)) {
+            ContextCall call;
+            CManagerInterface* manager = call.Manager();
+            if (!manager) {
+                return call.Unavailable();
+            }
+            int orders[] = { order };
+            int count = 1;   // in: tickets, out: records returned
+            TradeRecord* trades = manager->TradeRecordsRequest(orders, &count);
+            found = trades && count > 0 && IsOpenTrade(trades[0]);
+            if (found) {
+                trade = trades[0];
+            }
+            if (trades) {
+                manager->MemFree(trades);
+            }
+        }
+
+        if (!found) {
+            SetError("Trade not found");
+            return MT4_ERROR_INVALID_PARAMETER;
+        }
+        FillTradeData(*record, trade);
         SetError("");
         return MT4_SUCCESS;
     }
@@ -954,7 +1996,1347 @@ MT4WRAPPER_API int MT4_GetQuote(const char* symbol, char* buffer, int bufferSize
         return MT4_ERROR_INTERNAL;
     }
     catch (...) {
-        SetError("Unknown error getting quote");
+        SetError("Unknown error getting trade");
+        return MT4_ERROR_INTERNAL;
+    }
+}
+
+// Open trades matching a filter, straight from the server; used while the
+// mirror is not READY
+template <typename Match>
+static int CopyServerTrades(CManagerInterface* manager, Match match, MT4TradeData* records, int maxRecords, int* total) {
+    int count = 0;
+    TradeRecord* trades = manager->TradesRequest(&count);
+    std::vector<TradeRecord> matched;
+    for (int i = 0; trades && i < count; i++) {
+        if (IsOpenTrade(trades[i]) && match(trades[i])) {
+            matched.push_back(trades[i]);
+        }
+    }
+    if (trades) {
+        manager->MemFree(trades);
+    }
+    return CopyRecords(matched.data(), (int)matched.size(), records, maxRecords, total, FillTradeData);
+}
+
+MT4WRAPPER_API int MT4_GetTradesByLogin(int login, MT4TradeData* records, int maxRecords, int* total) {
+    if (!g_initialized) {
+        SetError("Not initialized");
+        return MT4_ERROR_NOT_INITIALIZED;
+    }
+
+    if (maxRecords < 0) {
+        SetError("Invalid buffer parameter");
+        return MT4_ERROR_INVALID_PARAMETER;
+    }
+
+    try {
+        std::vector<TradeRecord> trades;
+        if (g_mirror.TradesByLogin(login, trades)) {
+            return CopyRecords(trades.data(), (int)trades.size(), records, maxRecords, total, FillTradeData);
+        }
+        ContextCall call;
+        CManagerInterface* manager = call.Manager();
+        if (!manager) {
+            return call.Unavailable();
+        }
+
+        return CopyServerTrades(manager, [login](const TradeRecord& trade) { return trade.login == login; },
+            records, maxRecords, total);
+    }
+    catch (const std::exception& e) {
+        SetError(e.what());
+        return MT4_ERROR_INTERNAL;
+    }
+    catch (...) {
+        SetError("Unknown error getting trades");
+        return MT4_ERROR_INTERNAL;
+    }
+}
+
+MT4WRAPPER_API int MT4_GetTradesBySymbol(const char* symbol, MT4TradeData* records, int maxRecords, int* total) {
+    if (!g_initialized) {
+        SetError("Not initialized");
+        return MT4_ERROR_NOT_INITIALIZED;
+    }
+
+    if (!symbol || maxRecords < 0) {
+        SetError("Invalid parameters");
+        return MT4_ERROR_INVALID_PARAMETER;
+    }
+
+    try {
+        std::vector<TradeRecord> trades;
+        if (g_mirror.TradesBySymbol(symbol, trades)) {
+            return CopyRecords(trades.data(), (int)trades.size(), records, maxRecords, total, FillTradeData);
+        }
+        ContextCall call;
+        CManagerInterface* manager = call.Manager();
+        if (!manager) {
+            return call.Unavailable();
+        }
+
+        return CopyServerTrades(manager, [symbol](const TradeRecord& trade) { return strcmp(trade.symbol, symbol) == 0; },
+            records, maxRecords, total);
+    }
+    catch (const std::exception& e) {
+        SetError(e.what());
+        return MT4_ERROR_INTERNAL;
+    }
+    catch (...) {
+        SetError("Unknown error getting trades");
+        return MT4_ERROR_INTERNAL;
+    }
+}
+
+MT4WRAPPER_API int MT4_GetUsersBinary(MT4UserData* records, int maxRecords, int* total) {
+    if (!g_initialized) {
+        SetError("Not initialized");
+        return MT4_ERROR_NOT_INITIALIZED;
+    }
+
+    if (maxRecords < 0) {
+        SetError("Invalid buffer parameter");
+        return MT4_ERROR_INVALID_PARAMETER;
+    }
+
+    try {
+        int rc = MT4_SUCCESS;
+        if (g_mirror.ReadUsers([&](const UserRecord* users, int count) {
+                rc = CopyRecords(users, count, records, maxRecords, total, FillUserData);
+            })) {
+            return rc;
+        }
+
+        ContextCall call;
+        CManagerInterface* manager = call.Manager();
+        if (!manager) {
+            return call.Unavailable();
+        }
+
+        int count = 0;
+        UserRecord* users = manager->UsersRequest(&count);
+        rc = CopyRecords(users, count, records, maxRecords, total, FillUserData);
+
+        if (users) {
+            manager->MemFree(users);
+        }
+        return rc;
+    }
+    catch (const std::exception& e) {
+        SetError(e.what());
+        return MT4_ERROR_INTERNAL;
+    }
+    catch (...) {
+        SetError("Unknown error getting users");
+        return MT4_ERROR_INTERNAL;
+    }
+}
+
+MT4WRAPPER_API int MT4_GetSymbolsBinary(MT4SymbolData* records, int maxRecords, int* total) {
+    if (!g_initialized) {
+        SetError("Not initialized");
+        return MT4_ERROR_NOT_INITIALIZED;
+    }
+
+    if (maxRecords < 0) {
+        SetError("Invalid buffer parameter");
+        return MT4_ERROR_INVALID_PARAMETER;
+    }
+
+    try {
+        int rc = MT4_SUCCESS;
+        if (g_mirror.ReadSymbols([&](const ConSymbol* symbols, int count) {
+                rc = CopyRecords(symbols, count, records, maxRecords, total, FillSymbolData);
+            })) {
+            return rc;
+        }
+
+        ContextCall call;
+        CManagerInterface* manager = call.Manager();
+        if (!manager) {
+            return call.Unavailable();
+        }
+
+        // Refresh symbols from server first
+        manager->SymbolsRefresh();
+
+        int count = 0;
+        ConSymbol* symbols = manager->SymbolsGetAll(&count);
+        rc = CopyRecords(symbols, count, records, maxRecords, total, FillSymbolData);
+
+        if (symbols) {
+            manager->MemFree(symbols);
+        }
+        return rc;
+    }
+    catch (const std::exception& e) {
+        SetError(e.what());
+        return MT4_ERROR_INTERNAL;
+    }
+    catch (...) {
+        SetError("Unknown error getting symbols");
+        return MT4_ERROR_INTERNAL;
+    }
+}
+
+MT4WRAPPER_API int MT4_GetQuotesBinary(MT4QuoteData* records, int maxRecords, int* total) {
+    if (!g_initialized) {
+        SetError("Not initialized");
+        return MT4_ERROR_NOT_INITIALIZED;
+    }
+
+    if (maxRecords < 0) {
+        SetError("Invalid buffer parameter");
+        return MT4_ERROR_INVALID_PARAMETER;
+    }
+
+    try {
+        int rc = MT4_SUCCESS;
+        if (g_mirror.ReadQuotes([&](const QuoteEntry* quotes, int count) {
+                rc = CheckRecordCapacity(count, records, maxRecords, total);
+                if (rc == MT4_SUCCESS) {
+                    int written = 0;
+                    for (int i = 0; i < count; i++) {
+                        if (quotes[i].info.symbol[0]) {
+                            FillQuoteData(records[written++], quotes[i].info);
+                        }
+                    }
+                    SetError("");
+                    rc = written;
+                }
+            })) {
+            return rc;
+        }
+
+        ContextCall call;
+        CManagerInterface* manager = call.Manager();
+        if (!manager) {
+            return call.Unavailable();
+        }
+        // One quote slot per configured symbol
+        int count = 0;
+        ConSymbol* symbols = manager->SymbolsGetAll(&count);
+        if (!symbols) {
+            count = 0;
+        }
+
+        rc = CheckRecordCapacity(count, records, maxRecords, total);
+        if (rc == MT4_SUCCESS) {
+            int written = 0;
+            for (int i = 0; i < count; i++) {
+                SymbolInfo info = {0};
+                if (manager->SymbolInfoGet(symbols[i].symbol, &info) == RET_OK) {
+                    FillQuoteData(records[written++], info);
+                }
+            }
+            SetError("");
+            rc = written;
+        }
+
+        if (symbols) {
+            manager->MemFree(symbols);
+        }
+        return rc;
+    }
+    catch (const std::exception& e) {
+        SetError(e.what());
+        return MT4_ERROR_INTERNAL;
+    }
+    catch (...) {
+        SetError("Unknown error getting quotes");
+        return MT4_ERROR_INTERNAL;
+    }
+}
+
+// Cursors: one UsersRequest/TradesRequest, then pages sliced from the held array
+enum CursorKind {
+    CURSOR_USERS,
+    CURSOR_TRADES
+};
+
+struct Cursor {
+    CursorKind kind;
+    CManagerInterface* owner;   // the context's manager that allocated records
+    void* records;      // MemFree-able array from the owner
+    int total;
+    int position;
+    unsigned long long lastUsed;
+};
+
+static const size_t MAX_OPEN_CURSORS = 16;
+static std::mutex g_cursorLock;
+static std::map<int, Cursor> g_cursors;
+static int g_nextCursor = 1;
+static unsigned long long g_cursorClock = 0;
+
+static void FreeCursor(Cursor& cursor) {
+    if (cursor.records && cursor.owner) {
+        cursor.owner->MemFree(cursor.records);
+    }
+    cursor.records = nullptr;
+}
+
+static void CloseAllCursors() {
+    std::lock_guard<std::mutex> guard(g_cursorLock);
+    for (auto& entry : g_cursors) {
+        FreeCursor(entry.second);
+    }
+    g_cursors.clear();
+}
+
+// Before a context's manager is released
+static void CloseCursors(CManagerInterface* owner) {
+    std::lock_guard<std::mutex> guard(g_cursorLock);
+    for (auto it = g_cursors.begin(); it != g_cursors.end();) {
+        if (it->second.owner == owner) {
+            FreeCursor(it->second);
+            it = g_cursors.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+// Registers a fetched array; evicts the least recently used cursor when full
+static int RegisterCursor(CursorKind kind, CManagerInterface* owner, void* records, int total) {
+    std::lock_guard<std::mutex> guard(g_cursorLock);
+    if (g_cursors.size() >= MAX_OPEN_CURSORS) {
+        auto oldest = g_cursors.begin();
+        for (auto it = g_cursors.begin(); it != g_cursors.end(); ++it) {
+            if (it->second.lastUsed < oldest->second.lastUsed) {
+                oldest = it;
+            }
+        }
+        FreeCursor(oldest->second);
+        g_cursors.erase(oldest);
+    }
+
+    int handle = g_nextCursor++;
+    if (g_nextCursor <= 0) {
+        g_nextCursor = 1;
+    }
+    g_cursors[handle] = Cursor{ kind, owner, records, total, 0, ++g_cursorClock };
+    return handle;
+}
+
+MT4WRAPPER_API int MT4_OpenUsersCursor(int* total) {
+    ContextCall call;
+    CManagerInterface* manager = call.Manager();
+    if (!g_initialized || !manager) {
+        return call.Unavailable();
+    }
+
+    try {
+        int count = 0;
+        UserRecord* users = manager->UsersRequest(&count);
+        if (!users) {
+            count = 0;
+        }
+        if (total) {
+            *total = count;
+        }
+        SetError("");
+        return RegisterCursor(CURSOR_USERS, manager, users, count);
+    }
+    catch (const std::exception& e) {
+        SetError(e.what());
         return MT4_ERROR_INTERNAL;
     }
-}
\ No newline at end of file
+    catch (...) {
+        SetError("Unknown error opening users cursor");
+        return MT4_ERROR_INTERNAL;
+    }
+}
+
+MT4WRAPPER_API int MT4_OpenTradesCursor(int login, int* total) {
+    ContextCall call;
+    CManagerInterface* manager = call.Manager();
+    if (!g_initialized || !manager) {
+        return call.Unavailable();
+    }
+
+    try {
+        int count = 0;
+        TradeRecord* trades = (login > 0)
+            ? manager->TradesUserHistory(login, 0, time(NULL), &count)
+            : manager->TradesRequest(&count);
+        if (!trades) {
+            count = 0;
+        }
+        if (total) {
+            *total = count;
+        }
+        SetError("");
+        return RegisterCursor(CURSOR_TRADES, manager, trades, count);
+    }
+    catch (const std::exception& e) {
+        SetError(e.what());
+        return MT4_ERROR_INTERNAL;
+    }
+    catch (...) {
+        SetError("Unknown error opening trades cursor");
+        return MT4_ERROR_INTERNAL;
+    }
+}
+
+MT4WRAPPER_API int MT4_CursorNext(int cursor, int maxRecords, char* buffer, int bufferSize, int* requiredSize) {
+    if (maxRecords <= 0 || bufferSize < 0 || (!buffer && bufferSize > 0)) {
+        SetError("Invalid parameters");
+        return MT4_ERROR_INVALID_PARAMETER;
+    }
+
+    std::lock_guard<std::mutex> guard(g_cursorLock);
+    auto it = g_cursors.find(cursor);
+    if (it == g_cursors.end()) {
+        SetError("Invalid cursor");
+        return MT4_ERROR_INVALID_PARAMETER;
+    }
+
+    Cursor& state = it->second;
+    state.lastUsed = ++g_cursorClock;
+
+    // Only whole records go into a page; the first record that does not fit ends it
+    JsonWriter json(buffer, bufferSize);
+    json.BeginArray();
+    int written = 0;
+    while (written < maxRecords && state.position + written < state.total) {
+        JsonWriter::Mark mark = json.Save();
+        int index = state.position + written;
+        if (state.kind == CURSOR_USERS) {
+            WriteUserListItem(json, static_cast<UserRecord*>(state.records)[index]);
+        } else {
+            WriteTradeItem(json, static_cast<TradeRecord*>(state.records)[index]);
+        }
+        // Keep room for the closing bracket
+        if (json.Overflow() || json.Remaining() < 1) {
+            if (written > 0) {
+                json.Restore(mark);
+            }
+            break;
+        }
+        written++;
+    }
+    json.EndArray();
+
+    // Not even one record fits: report the size a one-record page needs
+    int rc = FinishJson(json, requiredSize);
+    if (rc != MT4_SUCCESS) {
+        return rc;
+    }
+
+    state.position += written;
+    return written;
+}
+
+MT4WRAPPER_API int MT4_CursorSeek(int cursor, int position) {
+    std::lock_guard<std::mutex> guard(g_cursorLock);
+    auto it = g_cursors.find(cursor);
+    if (it == g_cursors.end() || position < 0) {
+        SetError("Invalid cursor");
+        return MT4_ERROR_INVALID_PARAMETER;
+    }
+
+    Cursor& state = it->second;
+    state.position = (position < state.total) ? position : state.total;
+    state.lastUsed = ++g_cursorClock;
+    SetError("");
+    return MT4_SUCCESS;
+}
+
+MT4WRAPPER_API int MT4_CursorClose(int cursor) {
+    std::lock_guard<std::mutex> guard(g_cursorLock);
+    auto it = g_cursors.find(cursor);
+    if (it == g_cursors.end()) {
+        SetError("Invalid cursor");
+        return MT4_ERROR_INVALID_PARAMETER;
+    }
+
+    FreeCursor(it->second);
+    g_cursors.erase(it);
+    SetError("");
+    return MT4_SUCCESS;
+}
+
+// Streams a record array as one JSON array in chunks of at most chunkBytes.
+// Chunks are never smaller than the worst-case record plus the opening bracket,
+// so any record fits in a chunk of its own.
+template <typename Record, typename WriteItem>
+static int StreamJsonArray(const Record* records, int total, WriteItem writeItem,
+    MT4_ChunkCallback callback, void* userContext, int chunkBytes) {
+    const int minChunkBytes = (int)MaxRecordJson<Record>() + 1;
+    if (chunkBytes < minChunkBytes) {
+        chunkBytes = minChunkBytes;
+    }
+
+    // +1: the writer keeps a byte for a terminator that is never sent
+    std::vector<char> chunk((size_t)chunkBytes + 1);
+    JsonWriter json(chunk.data(), chunkBytes + 1);
+
+    bool cancelled = false;
+    auto flush = [&]() {
+        if (json.Length() > 0 && callback(chunk.data(), json.Length(), userContext) != 0) {
+            cancelled = true;
+        }
+        json.Rewind();
+        return !cancelled;
+    };
+
+    // Writes one piece, moving it to a fresh chunk if the current one is full
+    auto emit = [&](auto&& write) {
+        JsonWriter::Mark mark = json.Save();
+        write();
+        if (!json.Overflow()) {
+            return true;
+        }
+        json.Restore(mark);
+        if (!flush()) {
+            return false;
+        }
+        write();
+        return !json.Overflow();
+    };
+
+    json.BeginArray();
+    for (int i = 0; i < total; i++) {
+        if (!emit([&]() { writeItem(json, records[i]); })) {
+            break;
+        }
+    }
+    if (!json.Overflow() && !cancelled) {
+        emit([&]() { json.EndArray(); });
+    }
+
+    if (cancelled) {
+        SetError("Stream cancelled by caller");
+        return MT4_ERROR_CANCELLED;
+    }
+    if (json.Overflow()) {
+        SetError("Record larger than stream chunk");
+        return MT4_ERROR_BUFFER_TOO_SMALL;
+    }
+    if (!flush()) {
+        SetError("Stream cancelled by caller");
+        return MT4_ERROR_CANCELLED;
+    }
+
+    SetError("");
+    return total;
+}
+
+MT4WRAPPER_API int MT4_StreamTrades(int login, MT4_ChunkCallback callback, void* userContext, int chunkBytes) {
+    ContextCall call;
+    CManagerInterface* manager = call.Manager();
+    if (!g_initialized || !manager) {
+        return call.Unavailable();
+    }
+
+    if (!callback) {
+        SetError("Invalid callback parameter");
+        return MT4_ERROR_INVALID_PARAMETER;
+    }
+
+    TradeRecord* trades = nullptr;
+    try {
+        int total = 0;
+        trades = (login > 0)
+            ? manager->TradesUserHistory(login, 0, time(NULL), &total)
+            : manager->TradesRequest(&total);
+        if (!trades) {
+            total = 0;
+        }
+
+        int rc = StreamJsonArray(trades, total, WriteTradeItem, callback, userContext, chunkBytes);
+        if (trades) {
+            manager->MemFree(trades);
+            trades = nullptr;
+        }
+        return rc;
+    }
+    catch (const std::exception& e) {
+        if (trades) {
+            manager->MemFree(trades);
+        }
+        SetError(e.what());
+        return MT4_ERROR_INTERNAL;
+    }
+    catch (...) {
+        if (trades) {
+            manager->MemFree(trades);
+        }
+        SetError("Unknown error streaming trades");
+        return MT4_ERROR_INTERNAL;
+    }
+}
+
+MT4WRAPPER_API int MT4_StreamUsers(MT4_ChunkCallback callback, void* userContext, int chunkBytes) {
+    ContextCall call;
+    CManagerInterface* manager = call.Manager();
+    if (!g_initialized || !manager) {
+        return call.Unavailable();
+    }
+
+    if (!callback) {
+        SetError("Invalid callback parameter");
+        return MT4_ERROR_INVALID_PARAMETER;
+    }
+
+    UserRecord* users = nullptr;
+    try {
+        int total = 0;
+        users = manager->UsersRequest(&total);
+        if (!users) {
+            total = 0;
+        }
+
+        int rc = StreamJsonArray(users, total, WriteUserListItem, callback, userContext, chunkBytes);
+        if (users) {
+            manager->MemFree(users);
+            users = nullptr;
+        }
+        return rc;
+    }
+    catch (const std::exception& e) {
+        if (users) {
+            manager->MemFree(users);
+        }
+        SetError(e.what());
+        return MT4_ERROR_INTERNAL;
+    }
+    catch (...) {
+        if (users) {
+            manager->MemFree(users);
+        }
+        SetError("Unknown error streaming users");
+        return MT4_ERROR_INTERNAL;
+    }
+}
+
+MT4WRAPPER_API int MT4_StartMirror(const char* server, int login, const char* password) {
+    if (!g_initialized || !g_pFactory) {
+        SetError("Not initialized");
+        return MT4_ERROR_NOT_INITIALIZED;
+    }
+
+    if (!server || !password) {
+        SetError("Invalid parameters");
+        return MT4_ERROR_INVALID_PARAMETER;
+    }
+
+    try {
+        std::string error;
+        int rc = g_mirror.Start(g_pFactory, server, login, password, error);
+        SetError(error.c_str());
+        return rc;
+    }
+    catch (const std::exception& e) {
+        SetError(e.what());
+        return MT4_ERROR_INTERNAL;
+    }
+    catch (...) {
+        SetError("Unknown error starting mirror");
+        return MT4_ERROR_INTERNAL;
+    }
+}
+
+MT4WRAPPER_API int MT4_StopMirror() {
+    try {
+        g_mirror.Stop();
+        SetError("");
+        return MT4_SUCCESS;
+    }
+    catch (...) {
+        SetError("Unknown error stopping mirror");
+        return MT4_ERROR_INTERNAL;
+    }
+}
+
+MT4WRAPPER_API int MT4_GetMirrorState(int* users, int* trades, int* symbols, int* groups) {
+    static_assert(PumpingMirror::READY == MT4_MIRROR_READY, "mirror state values changed");
+    g_mirror.Counts(users, trades, symbols, groups);
+    return (int)g_mirror.GetState();
+}
+
+// Server-side fallback for MT4_GetAccountState. MarginLevel has neither credit
+// nor the position count; credit comes from the user record, since equity
+// includes it.
+static void FillAccountState(MT4AccountState& state, const MarginLevel& level, double credit) {
+    memset(&state, 0, sizeof(state));
+    state.login = level.login;
+    state.leverage = level.leverage;
+    state.positions = -1;
+    state.balance = level.balance;
+    state.credit = credit;
+    state.equity = level.equity;
+    state.profit = level.equity - level.balance - credit;
+    state.margin = level.margin;
+    state.margin_free = level.margin_free;
+    state.margin_level = level.margin_level;
+    CopyFixed(state.group, level.group);
+    switch (level.level_type) {
+    case MARGINLEVEL_MARGINCALL: state.level = MT4_LEVEL_MARGIN_CALL; break;
+    case MARGINLEVEL_STOPOUT:    state.level = MT4_LEVEL_STOP_OUT; break;
+    default:                     state.level = MT4_LEVEL_OK; break;
+    }
+}
+
+MT4WRAPPER_API int MT4_GetAccountState(int login, MT4AccountState* state) {
+    if (!g_initialized) {
+        SetError("Not initialized");
+        return MT4_ERROR_NOT_INITIALIZED;
+    }
+
+    if (!state) {
+        SetError("Invalid buffer parameter");
+        return MT4_ERROR_INVALID_PARAMETER;
+    }
+
+    try {
+        bool found = false;
+        if (g_mirror.AccountState(login, *state, found)) {
+            if (!found) {
+                SetError("User not found");
+                return MT4_ERROR_INTERNAL;
+            }
+            SetError("");
+            return MT4_SUCCESS;
+        }
+
+        ContextCall call;
+        CManagerInterface* manager = call.Manager();
+        if (!manager) {
+            return call.Unavailable();
+        }
+
+        MarginLevel level = {};
+        int result = manager->MarginLevelRequest(login, &level);
+        if (result != RET_OK) {
+            const char* errorDesc = manager->ErrorDescription(result);
+            SetError(errorDesc ? errorDesc : "Margin level request failed");
+            return MT4_ERROR_INTERNAL;
+        }
+
+        int logins[] = { login };
+        int count = 1;   // in: logins, out: records returned
+        UserRecord* users = manager->UserRecordsRequest(logins, &count);
+        double credit = users && count > 0 ? users[0].credit : 0;
+        if (users) {
+            manager->MemFree(users);
+        }
+        FillAccountState(*state, level, credit);
+        SetError("");
+        return MT4_SUCCESS;
+    }
+    catch (const std::exception& e) {
+        SetError(e.what());
+        return MT4_ERROR_INTERNAL;
+    }
+    catch (...) {
+        SetError("Unknown error getting account state");
+        return MT4_ERROR_INTERNAL;
+    }
+}
+
+// Server-side fallback for MT4_GetExposure: a one-off margin engine seeded from a
+// snapshot. Nothing is quoted, so it keeps the server's profit and open prices.
+static bool ServerExposure(CManagerInterface* manager, const char* group, std::vector<MT4ExposureData>& rows) {
+    manager->SymbolsRefresh();
+
+    int symbolCount = 0, tradeCount = 0, userCount = 0;
+    ManagerArray<ConSymbol> symbolArray(manager, manager->SymbolsGetAll(&symbolCount));
+    ManagerArray<TradeRecord> tradeArray(manager, manager->TradesRequest(&tradeCount));
+
+    // Logins and groups only matter for a per-group answer
+    bool byGroup = group && group[0];
+    ManagerArray<UserRecord> userArray(manager, byGroup ? manager->UsersRequest(&userCount) : nullptr);
+    ConSymbol* symbols = symbolArray.Get();
+    TradeRecord* trades = tradeArray.Get();
+    UserRecord* users = userArray.Get();
+
+    SymbolIndex index;
+    index.Build(symbols, symbols ? symbolCount : 0, &ConSymbol::symbol);
+    MarginEngine engine;
+    auto rebuild = [&](const ConGroup* groups, int groupCount) {
+        engine.Rebuild(index, symbols, symbols ? symbolCount : 0, groups, groupCount,
+            users, users ? userCount : 0, trades, trades ? tradeCount : 0);
+    };
+    if (!byGroup || !EnsureGroups(manager) || !g_groups.Read(rebuild)) {
+        rebuild(nullptr, 0);
+    }
+    return engine.GetExposure(group, rows);
+}
+
+MT4WRAPPER_API int MT4_GetExposure(const char* group, MT4ExposureData* records, int maxRecords, int* total) {
+    if (!g_initialized) {
+        SetError("Not initialized");
+        return MT4_ERROR_NOT_INITIALIZED;
+    }
+
+    if (maxRecords < 0) {
+        SetError("Invalid buffer parameter");
+        return MT4_ERROR_INVALID_PARAMETER;
+    }
+
+    try {
+        std::vector<MT4ExposureData> rows;
+        bool found = false;
+        if (!g_mirror.Exposure(group, rows, found)) {
+            ContextCall call;
+            CManagerInterface* manager = call.Manager();
+            if (!manager) {
+                return call.Unavailable();
+            }
+            found = ServerExposure(manager, group, rows);
+        }
+        if (!found) {
+            SetError("Group not found");
+            return MT4_ERROR_INTERNAL;
+        }
+
+        int rc = CheckRecordCapacity((int)rows.size(), records, maxRecords, total);
+        if (rc != MT4_SUCCESS) {
+            return rc;
+        }
+        std::copy(rows.begin(), rows.end(), records);
+        SetError("");
+        return (int)rows.size();
+    }
+    catch (const std::exception& e) {
+        SetError(e.what());
+        return MT4_ERROR_INTERNAL;
+    }
+    catch (...) {
+        SetError("Unknown error getting exposure");
+        return MT4_ERROR_INTERNAL;
+    }
+}
+
+MT4WRAPPER_API int MT4_ScanMarginLevels(MT4MarginEvent* records, int maxRecords, int* total) {
+    if (!g_initialized) {
+        SetError("Not initialized");
+        return MT4_ERROR_NOT_INITIALIZED;
+    }
+
+    if (maxRecords < 0) {
+        SetError("Invalid buffer parameter");
+        return MT4_ERROR_INVALID_PARAMETER;
+    }
+
+    try {
+        // The server has no equivalent short of one MarginLevelRequest per account
+        std::vector<MT4MarginEvent> rows;
+        if (!g_mirror.TakeLevelChanges(records ? maxRecords : 0, rows)) {
+            SetError("Mirror not ready");
+            return MT4_ERROR_NOT_CONNECTED;
+        }
+
+        int rc = CheckRecordCapacity((int)rows.size(), records, maxRecords, total);
+        if (rc != MT4_SUCCESS) {
+            return rc;
+        }
+        std::copy(rows.begin(), rows.end(), records);
+        SetError("");
+        return (int)rows.size();
+    }
+    catch (const std::exception& e) {
+        SetError(e.what());
+        return MT4_ERROR_INTERNAL;
+    }
+    catch (...) {
+        SetError("Unknown error scanning margin levels");
+        return MT4_ERROR_INTERNAL;
+    }
+}
+
+MT4WRAPPER_API int MT4_StartPool(const char* server, int login, const char* password,
+    int size, int maxInFlight, int acquireTimeoutMs) {
+    if (!g_initialized || !g_pFactory) {
+        SetError("Not initialized");
+        return MT4_ERROR_NOT_INITIALIZED;
+    }
+
+    if (!server || !password || size <= 0 || maxInFlight <= 0 || acquireTimeoutMs < 0) {
+        SetError("Invalid parameters");
+        return MT4_ERROR_INVALID_PARAMETER;
+    }
+
+    try {
+        std::string error;
+        int rc = g_pool.Start(g_pFactory, server, login, password, size, maxInFlight, acquireTimeoutMs, error);
+        SetError(error.c_str());
+        return rc;
+    }
+    catch (const std::exception& e) {
+        SetError(e.what());
+        return MT4_ERROR_INTERNAL;
+    }
+    catch (...) {
+        SetError("Unknown error starting pool");
+        return MT4_ERROR_INTERNAL;
+    }
+}
+
+MT4WRAPPER_API int MT4_StopPool() {
+    try {
+        // Cursors opened on a pooled connection hold its arrays
+        g_pool.Stop(CloseCursors);
+        SetError("");
+        return MT4_SUCCESS;
+    }
+    catch (...) {
+        SetError("Unknown error stopping pool");
+        return MT4_ERROR_INTERNAL;
+    }
+}
+
+// Shared by MT4_GetPoolStats and MT4_GetDealingStats
+static int ReadPoolStats(const ConnectionPool& pool, MT4PoolStats* records, int maxRecords, int* total, long long* rejected) {
+    if (maxRecords < 0) {
+        SetError("Invalid buffer parameter");
+        return MT4_ERROR_INVALID_PARAMETER;
+    }
+
+    try {
+        std::vector<MT4PoolStats> rows;
+        long long busy = 0;
+        if (!pool.Stats(rows, busy)) {
+            SetError("Pool not running");
+            return MT4_ERROR_NOT_CONNECTED;
+        }
+        if (rejected) {
+            *rejected = busy;
+        }
+
+        int rc = CheckRecordCapacity((int)rows.size(), records, maxRecords, total);
+        if (rc != MT4_SUCCESS) {
+            return rc;
+        }
+        std::copy(rows.begin(), rows.end(), records);
+        SetError("");
+        return (int)rows.size();
+    }
+    catch (const std::exception& e) {
+        SetError(e.what());
+        return MT4_ERROR_INTERNAL;
+    }
+    catch (...) {
+        SetError("Unknown error getting pool stats");
+        return MT4_ERROR_INTERNAL;
+    }
+}
+
+MT4WRAPPER_API int MT4_GetPoolStats(MT4PoolStats* records, int maxRecords, int* total, long long* rejected) {
+    return ReadPoolStats(g_pool, records, maxRecords, total, rejected);
+}
+
+MT4WRAPPER_API int MT4_StartDealing(const char* server, int login, const char* password,
+    int size, int acquireTimeoutMs) {
+    if (!g_initialized || !g_pFactory) {
+        SetError("Not initialized");
+        return MT4_ERROR_NOT_INITIALIZED;
+    }
+
+    if (!server || !password || size <= 0 || acquireTimeoutMs < 0) {
+        SetError("Invalid parameters");
+        return MT4_ERROR_INVALID_PARAMETER;
+    }
+
+    try {
+        // One transaction per connection: a second order queues for the next
+        // free dealing connection rather than behind the first on the same one
+        std::string error;
+        int rc = g_dealing.Start(g_pFactory, server, login, password, size, 1, acquireTimeoutMs, error);
+        SetError(error.c_str());
+        return rc;
+    }
+    catch (const std::exception& e) {
+        SetError(e.what());
+        return MT4_ERROR_INTERNAL;
+    }
+    catch (...) {
+        SetError("Unknown error starting dealing connections");
+        return MT4_ERROR_INTERNAL;
+    }
+}
+
+MT4WRAPPER_API int MT4_StopDealing() {
+    try {
+        g_dealing.Stop(nullptr);
+        SetError("");
+        return MT4_SUCCESS;
+    }
+    catch (...) {
+        SetError("Unknown error stopping dealing connections");
+        return MT4_ERROR_INTERNAL;
+    }
+}
+
+MT4WRAPPER_API int MT4_GetDealingStats(MT4PoolStats* records, int maxRecords, int* total, long long* rejected) {
+    return ReadPoolStats(g_dealing, records, maxRecords, total, rejected);
+}
+
+MT4WRAPPER_API int MT4_StartQueue(int workers, int maxQueued) {
+    if (!g_initialized) {
+        SetError("Not initialized");
+        return MT4_ERROR_NOT_INITIALIZED;
+    }
+
+    if (workers <= 0 || maxQueued <= 0) {
+        SetError("Invalid parameters");
+        return MT4_ERROR_INVALID_PARAMETER;
+    }
+
+    try {
+        std::string error;
+        int rc = g_requests.Start(workers, maxQueued, error);
+        SetError(error.c_str());
+        return rc;
+    }
+    catch (const std::exception& e) {
+        SetError(e.what());
+        return MT4_ERROR_INTERNAL;
+    }
+    catch (...) {
+        SetError("Unknown error starting queue");
+        return MT4_ERROR_INTERNAL;
+    }
+}
+
+MT4WRAPPER_API int MT4_StopQueue() {
+    try {
+        g_requests.Stop();
+        SetError("");
+        return MT4_SUCCESS;
+    }
+    catch (...) {
+        SetError("Unknown error stopping queue");
+        return MT4_ERROR_INTERNAL;
+    }
+}
+
+MT4WRAPPER_API int MT4_SetCompletionCallback(MT4_CompletionCallback callback, void* userContext) {
+    g_requests.SetCallback(callback, userContext);
+    SetError("");
+    return MT4_SUCCESS;
+}
+
+MT4WRAPPER_API int MT4_PollCompletions(MT4Completion* records, int maxRecords, int timeoutMs) {
+    if (!records || maxRecords <= 0 || timeoutMs < 0) {
+        SetError("Invalid parameters");
+        return MT4_ERROR_INVALID_PARAMETER;
+    }
+
+    try {
+        SetError("");
+        return g_requests.Poll(records, maxRecords, timeoutMs);
+    }
+    catch (const std::exception& e) {
+        SetError(e.what());
+        return MT4_ERROR_INTERNAL;
+    }
+    catch (...) {
+        SetError("Unknown error polling completions");
+        return MT4_ERROR_INTERNAL;
+    }
+}
+
+MT4WRAPPER_API int MT4_FreeCompletion(long long request) {
+    if (!g_requests.Free(request)) {
+        SetError("Unknown request");
+        return MT4_ERROR_INVALID_PARAMETER;
+    }
+    SetError("");
+    return MT4_SUCCESS;
+}
+
+// Runs a worker's call on the context its submitter was bound to
+class ThreadContextScope {
+public:
+    explicit ThreadContextScope(MT4_Context* context) : m_previous(t_context) { t_context = context; }
+    ~ThreadContextScope() { t_context = m_previous; }
+
+    ThreadContextScope(const ThreadContextScope&) = delete;
+    ThreadContextScope& operator=(const ThreadContextScope&) = delete;
+
+private:
+    MT4_Context* m_previous;
+};
+
+// Queues call for a worker. The worker's error text replaces the output of a
+// call that failed, since the submitting thread never sees it. The call keeps
+// a reference to the submitter's bound context until it has run or been dropped.
+static long long SubmitCall(long long tag, RequestQueue::Call call) {
+    try {
+        RetainContext(t_context);
+        std::shared_ptr<MT4_Context> bound(t_context, ReleaseContext);
+        long long request = g_requests.Submit(tag, [call, bound](std::string& out) {
+            ThreadContextScope scope(bound.get());
+            int rc = call(out);
+            if (rc < 0) {
+                out = t_lastError;
+            }
+            return rc;
+        });
+        if (request == MT4_ERROR_BUSY) {
+            SetError("Request queue full");
+        }
+        else if (request < 0) {
+            SetError("Queue not running");
+        }
+        else {
+            SetError("");
+        }
+        return request;
+    }
+    catch (const std::exception& e) {
+        SetError(e.what());
+        return MT4_ERROR_INTERNAL;
+    }
+    catch (...) {
+        SetError("Unknown error submitting request");
+        return MT4_ERROR_INTERNAL;
+    }
+}
+
+// Runs a JSON export into the worker's buffer, growing it once to the size the
+// export asks for. The buffer starts at the list's estimate (0 for single
+// records) and keeps its size, so one call is usually enough.
+static int RunJson(const std::function<int(char*, int, int*)>& call, std::string& out, long long estimate = 0) {
+    static thread_local std::vector<char> buffer(64 * 1024);
+    if (estimate > (long long)buffer.size() && estimate < INT_MAX) {
+        buffer.resize((size_t)estimate);
+    }
+    int required = 0;
+    int rc = call(buffer.data(), (int)buffer.size(), &required);
+    if (rc == MT4_ERROR_BUFFER_TOO_SMALL && required > (int)buffer.size()) {
+        buffer.resize(required);
+        rc = call(buffer.data(), (int)buffer.size(), &required);
+    }
+    if (rc >= 0) {
+        out.assign(buffer.data());
+    }
+    return rc;
+}
+
+MT4WRAPPER_API long long MT4_SubmitGetUserInfo(long long tag, int login) {
+    return SubmitCall(tag, [login](std::string& out) {
+        return RunJson([login](char* buffer, int size, int*) { return MT4_GetUserInfo(login, buffer, size); }, out);
+    });
+}
+
+MT4WRAPPER_API long long MT4_SubmitGetAllUsers(long long tag, unsigned long long fieldMask) {
+    return SubmitCall(tag, [fieldMask](std::string& out) {
+        return RunJson([fieldMask](char* buffer, int size, int* required) {
+            return MT4_GetAllUsers(fieldMask, buffer, size, required);
+        }, out, EstimateListJson(MT4_RECORD_USER, fieldMask));
+    });
+}
+
+MT4WRAPPER_API long long MT4_SubmitGetTrades(long long tag, int login, unsigned long long fieldMask) {
+    return SubmitCall(tag, [login, fieldMask](std::string& out) {
+        return RunJson([login, fieldMask](char* buffer, int size, int* required) {
+            return MT4_GetTrades(login, fieldMask, buffer, size, required);
+        }, out, login <= 0 ? EstimateListJson(MT4_RECORD_TRADE, fieldMask) : 0);
+    });
+}
+
+MT4WRAPPER_API long long MT4_SubmitGetSymbols(long long tag, unsigned long long fieldMask) {
+    return SubmitCall(tag, [fieldMask](std::string& out) {
+        return RunJson([fieldMask](char* buffer, int size, int* required) {
+            return MT4_GetSymbols(fieldMask, buffer, size, required);
+        }, out, EstimateListJson(MT4_RECORD_SYMBOL, fieldMask));
+    });
+}
+
+MT4WRAPPER_API long long MT4_SubmitGetGroups(long long tag, unsigned long long fieldMask) {
+    return SubmitCall(tag, [fieldMask](std::string& out) {
+        return RunJson([fieldMask](char* buffer, int size, int* required) {
+            return MT4_GetGroups(fieldMask, buffer, size, required);
+        }, out, EstimateListJson(MT4_RECORD_GROUP, fieldMask));
+    });
+}
+
+MT4WRAPPER_API long long MT4_SubmitGetQuote(long long tag, const char* symbol) {
+    if (!symbol) {
+        SetError("Invalid parameters");
+        return MT4_ERROR_INVALID_PARAMETER;
+    }
+
+    std::string name(symbol);
+    return SubmitCall(tag, [name](std::string& out) {
+        return RunJson([&name](char* buffer, int size, int*) { return MT4_GetQuote(name.c_str(), buffer, size); }, out);
+    });
+}
+
+MT4WRAPPER_API long long MT4_SubmitOpenTrade(long long tag, int login, const char* symbol, int cmd, double volume,
+    double price, double stoploss, double takeprofit, const char* comment) {
+    if (!symbol) {
+        SetError("Invalid parameters");
+        return MT4_ERROR_INVALID_PARAMETER;
+    }
+
+    std::string name(symbol);
+    std::string note(comment ? comment : "");
+    return SubmitCall(tag, [=](std::string& out) {
+        return RunJson([&](char* buffer, int size, int*) {
+            return MT4_OpenTrade(login, name.c_str(), cmd, volume, price, stoploss, takeprofit, note.c_str(), buffer, size);
+        }, out);
+    });
+}
+
+MT4WRAPPER_API long long MT4_SubmitCloseTrade(long long tag, int order, double lots, double price) {
+    return SubmitCall(tag, [order, lots, price](std::string&) {
+        return MT4_CloseTrade(order, lots, price);
+    });
+}
+
+MT4WRAPPER_API long long MT4_SubmitCreateUser(long long tag, const char* jsonData) {
+    if (!jsonData) {
+        SetError("Invalid parameters");
+        return MT4_ERROR_INVALID_PARAMETER;
+    }
+
+    std::string body(jsonData);
+    return SubmitCall(tag, [body](std::string& out) {
+        return RunJson([&body](char* buffer, int size, int*) { return MT4_CreateUser(body.c_str(), buffer, size); }, out);
+    });
+}
+
+MT4WRAPPER_API long long MT4_SubmitUpdateUser(long long tag, int login, const char* jsonData) {
+    if (!jsonData) {
+        SetError("Invalid parameters");
+        return MT4_ERROR_INVALID_PARAMETER;
+    }
+
+    std::string body(jsonData);
+    return SubmitCall(tag, [login, body](std::string&) {
+        return MT4_UpdateUser(login, body.c_str());
+    });
+}
+
+MT4WRAPPER_API long long MT4_SubmitDeleteUser(long long tag, int login) {
+    return SubmitCall(tag, [login](std::string&) {
+        return MT4_DeleteUser(login);
+    });
+}
+
+MT4WRAPPER_API long long MT4_SubmitCreateUsersBatch(long long tag, const char* jsonArray, int count) {
+    if (!jsonArray || count < 0) {
+        SetError("Invalid parameters");
+        return MT4_ERROR_INVALID_PARAMETER;
+    }
+
+    std::string body(jsonArray);
+    return SubmitCall(tag, [body, count](std::string& out) {
+        std::vector<MT4CreateUserResult> results(count);
+        int created = MT4_CreateUsersBatch(body.c_str(), count, results.data());
+        if (created < 0) {
+            return created;
+        }
+
+        std::string error = t_lastError;
+        int rc = RunJson([&](char* buffer, int size, int* required) {
+            JsonWriter json(buffer, size);
+            json.BeginObject().Key("created").Int(created).Key("error").String(error.c_str()).Key("results").BeginArray();
+            for (const MT4CreateUserResult& result : results) {
+                json.BeginObject().Key("login").Int(result.login).Key("code").Int(result.code).EndObject();
+            }
+            json.EndArray().EndObject();
+            return FinishJson(json, required);
+        }, out);
+        return rc < 0 ? rc : created;
+    });
+}
+
+MT4WRAPPER_API long long MT4_SubmitCloseTradesBatch(long long tag, const int* orders, int count, const double* prices) {
+    if (count < 0 || (count > 0 && !orders)) {
+        SetError("Invalid parameters");
+        return MT4_ERROR_INVALID_PARAMETER;
+    }
+
+    std::vector<int> tickets(orders, orders + count);
+    std::vector<double> at;
+    if (prices) {
+        at.assign(prices, prices + count);
+    }
+    return SubmitCall(tag, [tickets, at](std::string& out) {
+        std::vector<int> results(tickets.size());
+        int closed = MT4_CloseTradesBatch(tickets.data(), (int)tickets.size(), at.empty() ? nullptr : at.data(), results.data());
+        if (closed < 0) {
+            return closed;
+        }
+
+        std::string error = t_lastError;
+        int rc = RunJson([&](char* buffer, int size, int* required) {
+            JsonWriter json(buffer, size);
+            json.BeginObject().Key("closed").Int(closed).Key("error").String(error.c_str()).Key("results").BeginArray();
+            for (int result : results) {
+                json.Int(result);
+            }
+            json.EndArray().EndObject();
+            return FinishJson(json, required);
+        }, out);
+        return rc < 0 ? rc : closed;
+    });
+}
+
+MT4WRAPPER_API long long MT4_SubmitGetUsersSince(long long tag, unsigned long long version, unsigned long long fieldMask) {
+    return SubmitCall(tag, [version, fieldMask](std::string& out) {
+        return RunJson([version, fieldMask](char* buffer, int size, int* required) {
+            return MT4_GetUsersSince(version, fieldMask, buffer, size, required);
+        }, out);
+    });
+}
+
+MT4WRAPPER_API long long MT4_SubmitGetTradesSince(long long tag, unsigned long long version, unsigned long long fieldMask) {
+    return SubmitCall(tag, [version, fieldMask](std::string& out) {
+        return RunJson([version, fieldMask](char* buffer, int size, int* required) {
+            return MT4_GetTradesSince(version, fieldMask, buffer, size, required);
+        }, out);
+    });
+}
+
+// Runs a binary export into out as the packed records, retrying with the total
+// it reports; the set can grow between calls, so a couple of times
+template <class Record>
+static int RunRecords(const std::function<int(Record*, int, int*)>& call, std::string& out) {
+    std::vector<Record> records(256);
+    int total = 0;
+    int rc = call(records.data(), (int)records.size(), &total);
+    for (int attempt = 0; attempt < 3 && rc == MT4_ERROR_BUFFER_TOO_SMALL; attempt++) {
+        records.resize(std::max((size_t)total, records.size() * 2));
+        rc = call(records.data(), (int)records.size(), &total);
+    }
+    if (rc >= 0) {
+        out.assign((const char*)records.data(), rc * sizeof(Record));
+    }
+    return rc;
+}
+
+MT4WRAPPER_API long long MT4_SubmitGetTradesBinary(long long tag, int login) {
+    return SubmitCall(tag, [login](std::string& out) {
+        return RunRecords<MT4TradeData>([login](MT4TradeData* records, int maxRecords, int* total) {
+            return MT4_GetTradesBinary(login, records, maxRecords, total);
+        }, out);
+    });
+}
+
+MT4WRAPPER_API long long MT4_SubmitGetTradesByLogin(long long tag, int login) {
+    return SubmitCall(tag, [login](std::string& out) {
+        return RunRecords<MT4TradeData>([login](MT4TradeData* records, int maxRecords, int* total) {
+            return MT4_GetTradesByLogin(login, records, maxRecords, total);
+        }, out);
+    });
+}
+
+MT4WRAPPER_API long long MT4_SubmitGetUsersBinary(long long tag) {
+    return SubmitCall(tag, [](std::string& out) {
+        return RunRecords<MT4UserData>(MT4_GetUsersBinary, out);
+    });
+}
+
+MT4WRAPPER_API long long MT4_SubmitGetSymbolsBinary(long long tag) {
+    return SubmitCall(tag, [](std::string& out) {
+        return RunRecords<MT4SymbolData>(MT4_GetSymbolsBinary, out);
+    });
+}
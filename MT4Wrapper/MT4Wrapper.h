@@ -16,23 +16,434 @@ MT4WRAPPER_API int MT4_IsConnected();
 MT4WRAPPER_API const char* MT4_GetLastError();
 MT4WRAPPER_API int MT4_Ping();
 
+// The last error is kept per thread: MT4_GetLastError describes the calling
+// thread's most recent failure, and the pointer stays valid until that thread's
+// next wrapper call.
+//
+// Contexts: each MT4_Context owns a separate manager connection. Every export
+// runs on the calling thread's context, chosen with MT4_SetThreadContext (NULL,
+// the initial binding, selects the default connection MT4_Initialize creates),
+// and holds that context's lock for the duration of the call. Threads bound to
+// different contexts therefore run in parallel; calls on one context queue, so
+// a chunk callback must not call back into the wrapper on its own context.
+// A new context is connected with MT4_Connect/MT4_Login from a thread bound to
+// it. MT4_DestroyContext (and MT4_Shutdown, for all of them) closes the
+// connection at once; other threads still bound to the context get
+// MT4_ERROR_NOT_INITIALIZED until they bind another one or NULL, and the
+// context's memory is freed when the last of them does.
+typedef struct MT4_Context MT4_Context;
+
+MT4WRAPPER_API MT4_Context* MT4_CreateContext();
+MT4WRAPPER_API int MT4_DestroyContext(MT4_Context* context);
+MT4WRAPPER_API int MT4_SetThreadContext(MT4_Context* context);
+
+// JSON list exports return every record. *requiredSize (optional) receives the
+// exact buffer size the document needs; on MT4_ERROR_BUFFER_TOO_SMALL retry once
+// with that size. buffer = NULL, bufferSize = 0 is a size query. Lists the
+// mirror cannot serve fail with MT4_ERROR_NOT_CONNECTED while the connection is
+// down rather than returning an empty array.
+// fieldMask selects the JSON keys to emit (bit N = Nth field of the record's
+// table); MT4_FIELDS_ALL emits the full record. MT4_ParseFieldMask builds a mask
+// from a key list such as "login,balance" once, so callers can reuse it.
+#define MT4_FIELDS_ALL 0xFFFFFFFFFFFFFFFFULL
+
+#define MT4_RECORD_USER 1
+#define MT4_RECORD_TRADE 2
+#define MT4_RECORD_SYMBOL 3
+#define MT4_RECORD_GROUP 4
+
+MT4WRAPPER_API int MT4_ParseFieldMask(int recordType, const char* fields, unsigned long long* mask);
+
+// Upper estimate of the buffer the full list of recordType with fieldMask needs:
+// the record count (the mirror's, else the last list the server returned) times
+// the widest value of each selected field, so only escaped strings can exceed it.
+// No server round trip; with no count known yet it is the size of an empty array.
+// MT4_RECORD_TRADE means all open trades.
+MT4WRAPPER_API int MT4_EstimateJsonSize(int recordType, unsigned long long fieldMask, int* estimatedSize);
+
 // User management
 MT4WRAPPER_API int MT4_GetUserInfo(int login, char* buffer, int bufferSize);
-MT4WRAPPER_API int MT4_GetAllUsers(char* buffer, int bufferSize);
+MT4WRAPPER_API int MT4_GetAllUsers(unsigned long long fieldMask, char* buffer, int bufferSize, int* requiredSize);
 MT4WRAPPER_API int MT4_CreateUser(const char* jsonData, char* buffer, int bufferSize);
+// Applies the body's keys to login's record. password and passwordInvestor are
+// set after the record update; passwordPhone is only accepted on create.
 MT4WRAPPER_API int MT4_UpdateUser(int login, const char* jsonData);
 MT4WRAPPER_API int MT4_DeleteUser(int login);
 
+// Batch creation: jsonArray holds exactly count MT4_CreateUser-style objects,
+// all parsed before the first is created. A record that fails to parse (its code
+// MT4_ERROR_INVALID_PARAMETER) or a different number of records fails the whole
+// call with MT4_ERROR_INVALID_PARAMETER and creates nothing. Otherwise results
+// receives one entry per object: code MT4_SUCCESS, the MT4 server's RET_* code
+// (> 0) when UserRecordNew refused the record, or MT4_ERROR_CANCELLED for
+// records not attempted after the connection dropped.
+// Returns the number of users created.
+struct MT4CreateUserResult {
+    int login;
+    int code;
+};
+
+MT4WRAPPER_API int MT4_CreateUsersBatch(const char* jsonArray, int count, MT4CreateUserResult* results);
+
 // Trade management  
-MT4WRAPPER_API int MT4_GetTrades(int login, char* buffer, int bufferSize);
+MT4WRAPPER_API int MT4_GetTrades(int login, unsigned long long fieldMask, char* buffer, int bufferSize, int* requiredSize);
+
+// Delta queries over the mirror's users and open trades. Pass the "version" from
+// the previous response (0 the first time) to get
+//   {"version":N,"full":false,"changed":[...records],"removed":[...logins/orders]}
+// with only what changed since. "full":true means changed holds every record and
+// the client should replace its copy: the first call, a client too far behind,
+// or a version from before a reload. Without the mirror every answer is a full
+// snapshot at version 0. Buffer sizing works as for the list exports.
+MT4WRAPPER_API int MT4_GetUsersSince(unsigned long long version, unsigned long long fieldMask,
+    char* buffer, int bufferSize, int* requiredSize);
+MT4WRAPPER_API int MT4_GetTradesSince(unsigned long long version, unsigned long long fieldMask,
+    char* buffer, int bufferSize, int* requiredSize);
+
 MT4WRAPPER_API int MT4_OpenTrade(int login, const char* symbol, int cmd, double volume, 
     double price, double stoploss, double takeprofit, const char* comment, char* buffer, int bufferSize);
+// Closes order (lots 0: in full) at price, 0 for the current price: a fresh
+// mirrored quote, else the server's. MT4_ERROR_NO_PRICE when there is neither.
 MT4WRAPPER_API int MT4_CloseTrade(int order, double lots, double price);
 
+// Batch close: closes count open trades in full, at prices[i] or, with prices
+// NULL or prices[i] 0, at the current price; pending orders are deleted. The
+// trades are looked up in one pass (the mirror, else one server request, which
+// also prices positions without a fresh mirrored quote) and the closes run in
+// parallel, one per dealing connection (else per pool connection). results
+// receives one code per order:
+//   MT4_SUCCESS                  closed (or, for a pending order, deleted)
+//   > 0                          the server's RET_* code refusing the close
+//   MT4_ERROR_INVALID_PARAMETER  the ticket is not an open trade
+//   MT4_ERROR_NO_PRICE           a position with no current price
+//   MT4_ERROR_NOT_CONNECTED, MT4_ERROR_BUSY, MT4_ERROR_NOT_INITIALIZED
+//                                no connection to send the close on
+//   MT4_ERROR_INTERNAL           the close threw
+//   MT4_ERROR_CANCELLED          not attempted: the connection dropped first
+// Returns the number of trades closed, the last error naming the first
+// failure, or a negative code (every result MT4_ERROR_CANCELLED) when the
+// arguments are invalid or no connection was free to look the trades up.
+MT4WRAPPER_API int MT4_CloseTradesBatch(const int* orders, int count, const double* prices, int* results);
+
 // Symbol management
-MT4WRAPPER_API int MT4_GetSymbols(char* buffer, int bufferSize);
+MT4WRAPPER_API int MT4_GetSymbols(unsigned long long fieldMask, char* buffer, int bufferSize, int* requiredSize);
 MT4WRAPPER_API int MT4_GetQuote(const char* symbol, char* buffer, int bufferSize);
 
+// Group configuration from the wrapper's group cache: requested from the server
+// once, then kept current by the mirror's pump while it runs
+MT4WRAPPER_API int MT4_GetGroups(unsigned long long fieldMask, char* buffer, int bufferSize, int* requiredSize);
+
+// Fixed-layout records for the binary exports. Doubles come first so the
+// natural layout has no padding and matches the C# structs in the REST API.
+// Strings are always zero-terminated.
+struct MT4TradeData {
+    double open_price;
+    double close_price;
+    double sl;
+    double tp;
+    double commission;
+    double storage;
+    double profit;
+    int order;
+    int login;
+    int cmd;
+    int volume;
+    int digits;
+    int open_time;
+    int close_time;
+    int expiration;
+    int magic;
+    char symbol[12];
+    char comment[32];
+};
+
+struct MT4UserData {
+    double balance;
+    double credit;
+    double prevbalance;
+    double prevmonthbalance;
+    double prevequity;
+    double prevmonthequity;
+    int login;
+    int leverage;
+    int enable;
+    int enable_read_only;
+    int agent_account;
+    int regdate;
+    int lastdate;
+    int timestamp;
+    char group[16];
+    char name[128];
+    char email[48];
+    char country[32];
+    char city[32];
+    char phone[32];
+    char status[16];
+    char comment[64];
+};
+
+struct MT4SymbolData {
+    double contract_size;
+    double tick_value;
+    double tick_size;
+    double point;
+    double margin_initial;
+    double margin_maintenance;
+    double margin_hedged;
+    double margin_divider;
+    double swap_long;
+    double swap_short;
+    int type;
+    int digits;
+    int trade;
+    int spread;
+    int stops_level;
+    int freeze_level;
+    int margin_mode;
+    int profit_mode;
+    int swap_type;
+    int exemode;
+    int long_only;
+    char symbol[12];
+    char description[64];
+    char currency[12];
+    char margin_currency[12];
+};
+
+struct MT4QuoteData {
+    double bid;
+    double ask;
+    double high;
+    double low;
+    double point;
+    int digits;
+    int spread;
+    int direction;
+    int type;
+    int time;
+    char symbol[12];
+};
+
+// Binary (blittable) exports
+// Each fills a caller-provided array and returns the number of records written.
+// *total receives the number of records available; when maxRecords is smaller
+// nothing is written and MT4_ERROR_BUFFER_TOO_SMALL is returned, so one retry
+// with an array of *total records always succeeds. Pass records = NULL and
+// maxRecords = 0 to query the count only.
+MT4WRAPPER_API int MT4_GetTradesBinary(int login, MT4TradeData* records, int maxRecords, int* total);
+MT4WRAPPER_API int MT4_GetUsersBinary(MT4UserData* records, int maxRecords, int* total);
+MT4WRAPPER_API int MT4_GetSymbolsBinary(MT4SymbolData* records, int maxRecords, int* total);
+MT4WRAPPER_API int MT4_GetQuotesBinary(MT4QuoteData* records, int maxRecords, int* total);
+
+// Open trades (positions and pending orders) by ticket, login or symbol. Served
+// from the mirror's indexes in time proportional to the result; while the mirror
+// is not READY they fall back to the server. MT4_GetTradeByOrder fails with
+// MT4_ERROR_INVALID_PARAMETER ("Trade not found") when the ticket is not open.
+MT4WRAPPER_API int MT4_GetTradeByOrder(int order, MT4TradeData* record);
+MT4WRAPPER_API int MT4_GetTradesByLogin(int login, MT4TradeData* records, int maxRecords, int* total);
+MT4WRAPPER_API int MT4_GetTradesBySymbol(const char* symbol, MT4TradeData* records, int maxRecords, int* total);
+
+// Cursors page through one UsersRequest/TradesRequest result without going back
+// to the server. Open returns a handle (> 0) or an error code; *total receives the
+// record count. MT4_CursorNext writes a JSON array of up to maxRecords whole
+// records and returns how many it wrote (0 once exhausted). If not even one record
+// fits it returns MT4_ERROR_BUFFER_TOO_SMALL with *requiredSize set. At most 16
+// cursors stay open; the least recently used one is closed to make room.
+MT4WRAPPER_API int MT4_OpenUsersCursor(int* total);
+MT4WRAPPER_API int MT4_OpenTradesCursor(int login, int* total);
+MT4WRAPPER_API int MT4_CursorNext(int cursor, int maxRecords, char* buffer, int bufferSize, int* requiredSize);
+MT4WRAPPER_API int MT4_CursorSeek(int cursor, int position);
+MT4WRAPPER_API int MT4_CursorClose(int cursor);
+
+// Streaming: serializes the full result as one JSON array and hands it to the
+// callback in chunks of at most chunkBytes, split between records. A chunkBytes
+// below the largest JSON one record can produce is raised to that size. The
+// callback returns 0 to continue or non-zero to cancel (MT4_ERROR_CANCELLED).
+// Returns the number of records streamed.
+typedef int (__cdecl *MT4_ChunkCallback)(const char* data, int length, void* userContext);
+MT4WRAPPER_API int MT4_StreamTrades(int login, MT4_ChunkCallback callback, void* userContext, int chunkBytes);
+MT4WRAPPER_API int MT4_StreamUsers(MT4_ChunkCallback callback, void* userContext, int chunkBytes);
+
+// Pumping mirror: a second connection in pumping mode keeps users, open trades,
+// symbols, groups and the latest quote per symbol in memory. Once READY,
+// MT4_GetUserInfo, MT4_GetAllUsers, MT4_GetTrades(login 0), MT4_GetSymbols,
+// MT4_GetQuote and the binary list exports answer from it instead of the server;
+// mirrored quotes carry "age", the milliseconds since the quote arrived.
+// MT4_GetMirrorState returns the state and, optionally, the mirrored record counts.
+#define MT4_MIRROR_STOPPED 0
+#define MT4_MIRROR_STARTING 1
+#define MT4_MIRROR_READY 2
+
+MT4WRAPPER_API int MT4_StartMirror(const char* server, int login, const char* password);
+MT4WRAPPER_API int MT4_StopMirror();
+MT4WRAPPER_API int MT4_GetMirrorState(int* users, int* trades, int* symbols, int* groups);
+
+// Account state: floating profit, margin and margin level of one login. While the
+// mirror is READY these are kept current by the margin engine as ticks arrive
+// (profit includes swaps, commission and taxes); otherwise the server's
+// MarginLevelRequest is used, credit comes from the user record and positions
+// is -1. level is one of MT4_LEVEL_*,
+// judged against the group's margin call and stop out settings.
+#define MT4_LEVEL_OK 0
+#define MT4_LEVEL_MARGIN_CALL 1
+#define MT4_LEVEL_STOP_OUT 2
+
+struct MT4AccountState {
+    double balance;
+    double credit;
+    double equity;
+    double profit;
+    double margin;
+    double margin_free;
+    double margin_level;
+    int login;
+    int leverage;
+    int positions;
+    int level;
+    char group[16];
+};
+
+MT4WRAPPER_API int MT4_GetAccountState(int login, MT4AccountState* state);
+
+// Net exposure: one record per symbol with open positions, summed over all
+// groups (group NULL or "") or within one group. Volumes are in lots, notional is
+// volume x contract size x closing price in the deposit currency, and profit
+// includes swaps, commission and taxes. While the mirror is READY the totals are
+// maintained as trades open, close and reprice; otherwise they are summed from a
+// server snapshot, with the server's profit and notional at open prices. Sizing
+// works as for the binary exports; an unknown group fails with "Group not found".
+struct MT4ExposureData {
+    double buy_volume;
+    double sell_volume;
+    double net_volume;
+    double buy_notional;
+    double sell_notional;
+    double profit;
+    int positions;
+    char symbol[12];
+    char group[16];
+};
+
+MT4WRAPPER_API int MT4_GetExposure(const char* group, MT4ExposureData* records, int maxRecords, int* total);
+
+// Margin-level scan. While the mirror is READY every account is checked against
+// its group's margin call and stop out levels after each batch of quotes.
+// MT4_ScanMarginLevels runs one more pass and returns the accounts whose level
+// (MT4_LEVEL_*) changed since the previous call, in either direction; the first
+// call reports every account that is not MT4_LEVEL_OK. Changes are only consumed
+// when they all fit, so the retry after MT4_ERROR_BUFFER_TOO_SMALL loses none.
+// Needs the mirror: fails with MT4_ERROR_NOT_CONNECTED while it is not READY.
+struct MT4MarginEvent {
+    double balance;
+    double equity;
+    double margin;
+    double margin_level;
+    int login;
+    int level;
+    int previous_level;
+    int positions;
+};
+
+MT4WRAPPER_API int MT4_ScanMarginLevels(MT4MarginEvent* records, int maxRecords, int* total);
+
+// Connection pool: size more manager connections to the same server, each logged
+// in separately. While it runs, a call from a thread with no bound context goes
+// to the pooled connection with the fewest calls in flight instead of the
+// default connection (which keeps MT4_Connect/MT4_Login/MT4_Disconnect,
+// MT4_IsConnected and MT4_Ping). A connection takes at most maxInFlight calls;
+// when every one is full a call waits up to acquireTimeoutMs, then fails with
+// MT4_ERROR_BUSY. A pooled connection that dropped is reconnected by the next
+// call routed to it; one that cannot reconnect is skipped for a few seconds, and
+// with none left calls go to the default connection. MT4_StopPool waits for the
+// calls in flight.
+//
+// MT4_GetPoolStats returns one row per pooled connection: calls served, calls in
+// flight, and how long calls queued for the connection (total and worst case, in
+// microseconds). *rejected (optional) receives the MT4_ERROR_BUSY count.
+// Fails with MT4_ERROR_NOT_CONNECTED when the pool is not running.
+struct MT4PoolStats {
+    long long calls;
+    long long wait_us_total;
+    long long wait_us_max;
+    int index;
+    int in_flight;
+    int max_in_flight;
+    int acquire_timeout_ms;
+};
+
+MT4WRAPPER_API int MT4_StartPool(const char* server, int login, const char* password,
+    int size, int maxInFlight, int acquireTimeoutMs);
+MT4WRAPPER_API int MT4_StopPool();
+MT4WRAPPER_API int MT4_GetPoolStats(MT4PoolStats* records, int maxRecords, int* total, long long* rejected);
+
+// Dealing connections: size manager connections reserved for MT4_OpenTrade and
+// MT4_CloseTrade, which no read or report call ever uses, so an order never
+// queues behind a trade dump or a symbol refresh. Each takes one transaction at
+// a time; when all are busy a trade waits up to acquireTimeoutMs, then fails
+// with MT4_ERROR_BUSY. Without them trades route like any other call.
+// MT4_GetDealingStats reports them the way MT4_GetPoolStats reports the pool.
+MT4WRAPPER_API int MT4_StartDealing(const char* server, int login, const char* password,
+    int size, int acquireTimeoutMs);
+MT4WRAPPER_API int MT4_StopDealing();
+MT4WRAPPER_API int MT4_GetDealingStats(MT4PoolStats* records, int maxRecords, int* total, long long* rejected);
+
+// Request queue: MT4_Submit* queue a call and return at once with a request id
+// (> 0), or MT4_ERROR_BUSY when maxQueued calls are already waiting. workers
+// threads run the queued calls through the blocking exports, so they use the
+// pool and dealing connections like any other caller; sizing workers to the
+// connections' total in-flight slots keeps every connection busy. A call
+// submitted from a thread bound with MT4_SetThreadContext runs on that context.
+//
+// Each finished call produces an MT4Completion: tag is the caller's value from
+// the submit, result what the blocking export returned, and data the JSON it
+// wrote or, when result < 0, the error text. data is empty for the close,
+// update and delete calls. The *Binary and ByLogin reads complete with result
+// records packed as in the binary exports. The batches complete with the count
+// done and {"created"|"closed":N,"error":"first failure","results":[...]}, each
+// result a {"login","code"} pair or a close code.
+// With a completion callback set, the worker calls it and data is valid only
+// during the call; the callback must not block. Otherwise completions wait for
+// MT4_PollCompletions, which returns up to maxRecords of them, waiting up to
+// timeoutMs for the first; their data stays valid until MT4_FreeCompletion.
+// MT4_StopQueue lets running calls finish and completes the queued ones with
+// MT4_ERROR_CANCELLED.
+struct MT4Completion {
+    long long request;
+    long long tag;
+    const char* data;
+    int result;
+    int length;
+};
+
+typedef void (__cdecl *MT4_CompletionCallback)(const MT4Completion* completion, void* userContext);
+
+MT4WRAPPER_API int MT4_StartQueue(int workers, int maxQueued);
+MT4WRAPPER_API int MT4_StopQueue();
+MT4WRAPPER_API int MT4_SetCompletionCallback(MT4_CompletionCallback callback, void* userContext);
+MT4WRAPPER_API int MT4_PollCompletions(MT4Completion* records, int maxRecords, int timeoutMs);
+MT4WRAPPER_API int MT4_FreeCompletion(long long request);
+
+MT4WRAPPER_API long long MT4_SubmitGetUserInfo(long long tag, int login);
+MT4WRAPPER_API long long MT4_SubmitGetAllUsers(long long tag, unsigned long long fieldMask);
+MT4WRAPPER_API long long MT4_SubmitGetTrades(long long tag, int login, unsigned long long fieldMask);
+MT4WRAPPER_API long long MT4_SubmitGetSymbols(long long tag, unsigned long long fieldMask);
+MT4WRAPPER_API long long MT4_SubmitGetGroups(long long tag, unsigned long long fieldMask);
+MT4WRAPPER_API long long MT4_SubmitGetQuote(long long tag, const char* symbol);
+MT4WRAPPER_API long long MT4_SubmitOpenTrade(long long tag, int login, const char* symbol, int cmd, double volume,
+    double price, double stoploss, double takeprofit, const char* comment);
+MT4WRAPPER_API long long MT4_SubmitCloseTrade(long long tag, int order, double lots, double price);
+MT4WRAPPER_API long long MT4_SubmitCloseTradesBatch(long long tag, const int* orders, int count, const double* prices);
+MT4WRAPPER_API long long MT4_SubmitCreateUser(long long tag, const char* jsonData);
+MT4WRAPPER_API long long MT4_SubmitCreateUsersBatch(long long tag, const char* jsonArray, int count);
+MT4WRAPPER_API long long MT4_SubmitUpdateUser(long long tag, int login, const char* jsonData);
+MT4WRAPPER_API long long MT4_SubmitDeleteUser(long long tag, int login);
+MT4WRAPPER_API long long MT4_SubmitGetUsersSince(long long tag, unsigned long long version, unsigned long long fieldMask);
+MT4WRAPPER_API long long MT4_SubmitGetTradesSince(long long tag, unsigned long long version, unsigned long long fieldMask);
+MT4WRAPPER_API long long MT4_SubmitGetTradesBinary(long long tag, int login);
+MT4WRAPPER_API long long MT4_SubmitGetTradesByLogin(long long tag, int login);
+MT4WRAPPER_API long long MT4_SubmitGetUsersBinary(long long tag);
+MT4WRAPPER_API long long MT4_SubmitGetSymbolsBinary(long long tag);
+
 // Return codes
 #define MT4_SUCCESS 0
 #define MT4_ERROR_NOT_INITIALIZED -1
@@ -42,4 +453,7 @@ MT4WRAPPER_API int MT4_GetQuote(const char* symbol, char* buffer, int bufferSize
 #define MT4_ERROR_NOT_CONNECTED -5
 #define MT4_ERROR_INVALID_PARAMETER -6
 #define MT4_ERROR_BUFFER_TOO_SMALL -7
+#define MT4_ERROR_CANCELLED -8
+#define MT4_ERROR_BUSY -9
+#define MT4_ERROR_NO_PRICE -10
 #define MT4_ERROR_INTERNAL -99
\ No newline at end of file
@@ -0,0 +1,704 @@
+#include <windows.h>
+#include "MT4Wrapper.h"
+#include "../MT4ManagerAPI.h"
+#include "MarginEngine.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <limits>
+
+void MarginEngine::Rebuild(const SymbolIndex& index, const ConSymbol* symbols, int symbolCount,
+    const ConGroup* groups, int groupCount, const UserRecord* users, int userCount,
+    const TradeRecord* trades, int tradeCount) {
+    std::unique_lock<std::shared_mutex> lock(m_lock);
+
+    m_symbols.assign(index.Count(), SymbolCalc());
+    m_symbolLegs.assign(index.Count(), std::vector<long long>());
+    m_exposure.assign(index.Count(), Exposure());
+    std::vector<bool> seen(index.Count());
+    for (int i = 0; i < symbolCount; i++) {
+        int id = index.Find(MakeSymbolKey(symbols[i].symbol));
+        if (id == SymbolIndex::NOT_FOUND || seen[id]) {
+            continue;
+        }
+        seen[id] = true;
+
+        const ConSymbol& symbol = symbols[i];
+        SymbolCalc& calc = m_symbols[id];
+        memcpy(calc.name, symbol.symbol, sizeof(calc.name));
+        calc.contractSize = symbol.contract_size;
+        calc.tickValue = symbol.tick_value;
+        calc.tickSize = symbol.tick_size;
+        calc.marginInitial = symbol.margin_initial;
+        calc.marginHedged = symbol.margin_hedged;
+        calc.marginDivider = symbol.margin_divider;
+        calc.marginMode = symbol.margin_mode;
+        calc.profitMode = symbol.profit_mode;
+    }
+
+    // Same ids as GroupCache, which hands over its groups in id order
+    m_groupIndex.Build(groups, groups ? groupCount : 0, &ConGroup::group);
+    m_groups.assign(m_groupIndex.Count(), GroupCalc());
+    std::vector<bool> seenGroup(m_groups.size());
+    for (int i = 0; i < groupCount; i++) {
+        const ConGroup& group = groups[i];
+        int groupId = m_groupIndex.Find(GroupKey::Make(group.group));
+        if (groupId == GroupIndex::NOT_FOUND || seenGroup[groupId]) {
+            continue;
+        }
+        seenGroup[groupId] = true;
+
+        GroupCalc& calc = m_groups[groupId];
+        calc.marginCall = group.margin_call;
+        calc.stopOut = group.margin_stopout;
+        calc.marginType = group.margin_type;
+        calc.freeMarginMode = group.margin_mode;
+        calc.hedgeLargeLeg = group.hedge_largeleg != 0;
+
+        int overrides = std::min(group.secmargins_total, (int)MAX_SEC_GROPS_MARGIN);
+        for (int j = 0; j < overrides; j++) {
+            int id = index.Find(MakeSymbolKey(group.secmargins[j].symbol));
+            if (id != SymbolIndex::NOT_FOUND && group.secmargins[j].margin_divider > 0) {
+                calc.dividers[id] = group.secmargins[j].margin_divider;
+            }
+        }
+    }
+    m_groupExposure.assign(m_groups.size(), std::vector<Exposure>());
+
+    // Levels carry over so a reload does not report every called account again
+    std::unordered_map<int, double> levels;
+    for (size_t i = 0; i < m_accounts.size(); i++) {
+        levels[m_accounts[i].login] = m_lastLevel[i];
+    }
+    m_accountSlots.Clear();
+    m_accounts.clear();
+    m_details.clear();
+    m_legs.clear();
+    m_orderLegs.clear();
+    for (auto* slots : { &m_deposit, &m_floating, &m_usedMargin, &m_percent, &m_callLimit, &m_stopLimit }) {
+        slots->clear();
+    }
+    m_scanLevel.clear();
+    m_lastLevel.clear();
+
+    for (int i = 0; i < userCount; i++) {
+        ApplyUser(users[i]);
+    }
+    for (int i = 0; i < tradeCount; i++) {
+        AddPosition(trades[i], index.Find(MakeSymbolKey(trades[i].symbol)));
+    }
+    for (auto& leg : m_legs) {
+        RecalcLeg(leg.second);
+    }
+    for (size_t i = 0; i < m_accounts.size(); i++) {
+        auto level = levels.find(m_accounts[i].login);
+        if (level != levels.end()) {
+            m_lastLevel[i] = level->second;
+        }
+    }
+
+    // Untaken changes of logins the reload dropped have nothing left to report
+    for (auto it = m_levelChanges.begin(); it != m_levelChanges.end();) {
+        it = FindAccount(it->first) ? std::next(it) : m_levelChanges.erase(it);
+    }
+}
+
+void MarginEngine::SetUser(const UserRecord& user) {
+    std::unique_lock<std::shared_mutex> lock(m_lock);
+    if (user.login < 0) {
+        return;
+    }
+    Account& account = AccountFor(user.login);
+    int leverage = account.leverage;
+    int group = account.group;
+    ApplyUser(user);
+
+    // Balance and credit only move the deposit; leverage and group move margin
+    if (account.leverage != leverage || account.group != group) {
+        for (long long key : m_details[account.slot].legs) {
+            RecalcLeg(m_legs[key]);
+        }
+    }
+}
+
+void MarginEngine::RemoveUser(int login) {
+    std::unique_lock<std::shared_mutex> lock(m_lock);
+    const Account* account = FindAccount(login);
+    if (!account) {
+        return;
+    }
+    // Copy: removing the last position of a leg edits the account's legs
+    int slot = account->slot;
+    std::vector<long long> legs = m_details[slot].legs;
+    for (long long key : legs) {
+        std::vector<Position> positions = m_legs[key].positions;
+        for (const Position& position : positions) {
+            RemovePosition(position.order);
+        }
+    }
+    RemoveSlot(slot);
+    m_levelChanges.erase(login);
+}
+
+void MarginEngine::SetTrade(const TradeRecord& trade, int symbolId) {
+    std::unique_lock<std::shared_mutex> lock(m_lock);
+    RemovePosition(trade.order);
+    if (trade.cmd != OP_BUY && trade.cmd != OP_SELL) {
+        return;
+    }
+    if (symbolId >= (int)m_symbols.size()) {
+        symbolId = SymbolIndex::NOT_FOUND;
+    }
+    AddPosition(trade, symbolId);
+    RecalcLeg(m_legs[LegKey(trade.login, symbolId)]);
+}
+
+void MarginEngine::RemoveTrade(int order) {
+    std::unique_lock<std::shared_mutex> lock(m_lock);
+    RemovePosition(order);
+}
+
+void MarginEngine::OnQuotes(const int* symbolIds, const SymbolInfo* quotes, int count) {
+    std::unique_lock<std::shared_mutex> lock(m_lock);
+    for (int i = 0; i < count; i++) {
+        int id = symbolIds[i];
+        if (id < 0 || id >= (int)m_symbols.size()) {
+            continue;
+        }
+        m_symbols[id].bid = quotes[i].bid;
+        m_symbols[id].ask = quotes[i].ask;
+        m_symbols[id].quoted = quotes[i].bid > 0 && quotes[i].ask > 0;
+    }
+
+    // Only legs in the quoted symbols move; a symbol repeated in the batch is
+    // recalculated once, with its last price
+    m_batch++;
+    for (int i = 0; i < count; i++) {
+        int id = symbolIds[i];
+        if (id < 0 || id >= (int)m_symbols.size() || m_symbols[id].batch == m_batch) {
+            continue;
+        }
+        m_symbols[id].batch = m_batch;
+        for (long long key : m_symbolLegs[id]) {
+            RecalcLeg(m_legs[key]);
+        }
+    }
+    if (m_batch % RESUM_BATCHES == 0) {
+        ResumTotals();
+    }
+    ScanLevels();
+}
+
+bool MarginEngine::Get(int login, MT4AccountState& state) const {
+    std::shared_lock<std::shared_mutex> lock(m_lock);
+    const Account* found = FindAccount(login);
+    if (!found) {
+        return false;
+    }
+    const Account& account = *found;
+    int slot = account.slot;
+    double profit = m_floating[slot];
+    double margin = m_usedMargin[slot];
+    double deposit = m_deposit[slot];
+    const GroupCalc* group = account.group >= 0 ? &m_groups[account.group] : nullptr;
+
+    memset(&state, 0, sizeof(state));
+    state.login = login;
+    state.leverage = account.leverage;
+    state.positions = Positions(account);
+    state.balance = account.balance;
+    state.credit = account.credit;
+    state.profit = profit;
+    state.equity = deposit + profit;
+    state.margin = margin;
+    state.margin_level = margin > 0 ? state.equity / margin * 100 : 0;
+    memcpy(state.group, m_details[slot].groupName, sizeof(state.group));
+
+    // The group decides how much floating P/L counts towards free margin
+    switch (group ? group->freeMarginMode : MARGIN_USE_ALL) {
+    case MARGIN_DONT_USE:  state.margin_free = deposit - margin; break;
+    case MARGIN_USE_PROFIT: state.margin_free = deposit + std::max(profit, 0.0) - margin; break;
+    case MARGIN_USE_LOSS:  state.margin_free = deposit + std::min(profit, 0.0) - margin; break;
+    default:               state.margin_free = state.equity - margin; break;
+    }
+
+    state.level = (int)LevelOf(state.equity, margin, m_percent[slot], m_callLimit[slot], m_stopLimit[slot]);
+    return true;
+}
+
+void MarginEngine::Reprice(TradeRecord* trades, int count) const {
+    std::shared_lock<std::shared_mutex> lock(m_lock);
+    for (int i = 0; i < count; i++) {
+        auto owner = m_orderLegs.find(trades[i].order);
+        if (owner == m_orderLegs.end()) {
+            continue;
+        }
+        for (const Position& position : m_legs.at(owner->second).positions) {
+            if (position.order == trades[i].order) {
+                trades[i].profit = std::round(position.profit * 100) / 100;
+                break;
+            }
+        }
+    }
+}
+
+bool MarginEngine::GetExposure(const char* group, std::vector<MT4ExposureData>& rows) const {
+    std::shared_lock<std::shared_mutex> lock(m_lock);
+    const std::vector<Exposure>* totals = &m_exposure;
+    char groupName[16] = {0};
+    if (group && group[0]) {
+        int groupId = m_groupIndex.Find(group);
+        if (groupId == GroupIndex::NOT_FOUND) {
+            return false;
+        }
+        totals = &m_groupExposure[groupId];
+        strncpy(groupName, group, sizeof(groupName) - 1);
+    }
+
+    rows.clear();
+    for (size_t id = 0; id < totals->size(); id++) {
+        const Exposure& exposure = (*totals)[id];
+        if (exposure.positions <= 0) {
+            continue;
+        }
+        MT4ExposureData row = {};
+        row.buy_volume = exposure.buyVolume / 100.0;
+        row.sell_volume = exposure.sellVolume / 100.0;
+        row.net_volume = (exposure.buyVolume - exposure.sellVolume) / 100.0;
+        row.buy_notional = exposure.buyNotional;
+        row.sell_notional = exposure.sellNotional;
+        row.profit = exposure.profit;
+        row.positions = exposure.positions;
+        memcpy(row.symbol, m_symbols[id].name, sizeof(row.symbol) - 1);
+        memcpy(row.group, groupName, sizeof(row.group));
+        rows.push_back(row);
+    }
+    return true;
+}
+
+void MarginEngine::TakeLevelChanges(size_t maxRows, std::vector<MT4MarginEvent>& rows) {
+    std::unique_lock<std::shared_mutex> lock(m_lock);
+    ScanLevels();
+
+    rows.clear();
+    for (const auto& change : m_levelChanges) {
+        const Account* found = FindAccount(change.first);
+        if (!found) {
+            continue;
+        }
+        const Account& account = *found;
+        int slot = account.slot;
+        // An account that went back to where it was has nothing to report
+        int level = (int)m_lastLevel[slot];
+        if (level == change.second) {
+            continue;
+        }
+        MT4MarginEvent row = {};
+        row.balance = account.balance;
+        row.equity = m_deposit[slot] + m_floating[slot];
+        row.margin = m_usedMargin[slot];
+        row.margin_level = row.margin > 0 ? row.equity / row.margin * 100 : 0;
+        row.login = account.login;
+        row.level = level;
+        row.previous_level = change.second;
+        row.positions = Positions(account);
+        rows.push_back(row);
+    }
+    if (rows.size() <= maxRows) {
+        m_levelChanges.clear();
+    }
+}
+
+void MarginEngine::Clear() {
+    std::unique_lock<std::shared_mutex> lock(m_lock);
+    m_symbols.clear();
+    m_symbolLegs.clear();
+    m_groups.clear();
+    m_groupIndex.Clear();
+    m_accountSlots.Clear();
+    m_accounts.clear();
+    m_details.clear();
+    m_legs.clear();
+    m_orderLegs.clear();
+    m_exposure.clear();
+    m_groupExposure.clear();
+    for (auto* slots : { &m_deposit, &m_floating, &m_usedMargin, &m_percent, &m_callLimit, &m_stopLimit }) {
+        slots->clear();
+    }
+    m_scanLevel.clear();
+    m_lastLevel.clear();
+    m_levelChanges.clear();
+}
+
+// Helpers below run with m_lock held exclusively
+
+MarginEngine::Account* MarginEngine::FindAccount(int login) {
+    int slot = m_accountSlots.Find(login);
+    return slot < 0 ? nullptr : &m_accounts[slot];
+}
+
+const MarginEngine::Account* MarginEngine::FindAccount(int login) const {
+    int slot = m_accountSlots.Find(login);
+    return slot < 0 ? nullptr : &m_accounts[slot];
+}
+
+// login must not be negative; the slot table has no room for it
+MarginEngine::Account& MarginEngine::AccountFor(int login) {
+    Account* account = FindAccount(login);
+    return account ? *account : m_accounts[AddSlot(login)];
+}
+
+int MarginEngine::AddSlot(int login) {
+    int slot = (int)m_accounts.size();
+    Account account = {};
+    account.login = login;
+    account.group = -1;
+    account.slot = slot;
+    m_accounts.push_back(account);
+    m_details.emplace_back();
+    m_accountSlots.Set(login, slot);
+    m_deposit.push_back(0);
+    m_floating.push_back(0);
+    m_usedMargin.push_back(0);
+    m_percent.push_back(0);
+    m_callLimit.push_back(-std::numeric_limits<double>::infinity());
+    m_stopLimit.push_back(-std::numeric_limits<double>::infinity());
+    m_scanLevel.push_back(MT4_LEVEL_OK);
+    m_lastLevel.push_back(MT4_LEVEL_OK);
+    return slot;
+}
+
+// Swap-removes a slot, moving the last account into it
+void MarginEngine::RemoveSlot(int slot) {
+    size_t last = m_accounts.size() - 1;
+    m_accountSlots.Erase(m_accounts[slot].login);
+    if ((size_t)slot != last) {
+        m_accounts[slot] = m_accounts[last];
+        m_accounts[slot].slot = slot;
+        m_details[slot] = std::move(m_details[last]);
+        m_accountSlots.Set(m_accounts[slot].login, slot);
+        m_deposit[slot] = m_deposit[last];
+        m_floating[slot] = m_floating[last];
+        m_usedMargin[slot] = m_usedMargin[last];
+        m_percent[slot] = m_percent[last];
+        m_callLimit[slot] = m_callLimit[last];
+        m_stopLimit[slot] = m_stopLimit[last];
+        m_scanLevel[slot] = m_scanLevel[last];
+        m_lastLevel[slot] = m_lastLevel[last];
+    }
+    for (auto* slots : { &m_deposit, &m_floating, &m_usedMargin, &m_percent, &m_callLimit, &m_stopLimit }) {
+        slots->pop_back();
+    }
+    m_accounts.pop_back();
+    m_details.pop_back();
+    m_scanLevel.pop_back();
+    m_lastLevel.pop_back();
+}
+
+// Accounts without a known group are never called
+void MarginEngine::SetLimits(const Account& account) {
+    int slot = account.slot;
+    if (account.group < 0) {
+        m_percent[slot] = 0;
+        m_callLimit[slot] = -std::numeric_limits<double>::infinity();
+        m_stopLimit[slot] = -std::numeric_limits<double>::infinity();
+        return;
+    }
+    const GroupCalc& group = m_groups[account.group];
+    m_percent[slot] = group.marginType == MARGIN_TYPE_PERCENT ? 1.0 : 0.0;
+    m_callLimit[slot] = group.marginCall;
+    m_stopLimit[slot] = group.stopOut;
+}
+
+void MarginEngine::ScanLevels() {
+    size_t count = m_accounts.size();
+    const double* deposit = m_deposit.data();
+    const double* floating = m_floating.data();
+    const double* margin = m_usedMargin.data();
+    const double* percent = m_percent.data();
+    const double* callLimit = m_callLimit.data();
+    const double* stopLimit = m_stopLimit.data();
+    double* scan = m_scanLevel.data();
+    double* last = m_lastLevel.data();
+
+    // No branches and no lookups: this is the loop the layout exists for
+    for (size_t i = 0; i < count; i++) {
+        scan[i] = LevelOf(deposit[i] + floating[i], margin[i], percent[i], callLimit[i], stopLimit[i]);
+    }
+
+    // Changes are rare; keep the level each account had before its first one
+    for (size_t i = 0; i < count; i++) {
+        if (scan[i] != last[i]) {
+            m_levelChanges.emplace(m_accounts[i].login, (int)last[i]);
+            last[i] = scan[i];
+        }
+    }
+}
+
+// Replaces the incrementally moved account totals with sums over the legs
+void MarginEngine::ResumTotals() {
+    std::fill(m_floating.begin(), m_floating.end(), 0.0);
+    std::fill(m_usedMargin.begin(), m_usedMargin.end(), 0.0);
+    for (const auto& entry : m_legs) {
+        const Leg& leg = entry.second;
+        int slot = FindAccount(leg.login)->slot;
+        m_floating[slot] += leg.profit + leg.fixed;
+        m_usedMargin[slot] += leg.margin;
+    }
+}
+
+int MarginEngine::Positions(const Account& account) const {
+    int positions = 0;
+    for (long long key : m_details[account.slot].legs) {
+        positions += (int)m_legs.at(key).positions.size();
+    }
+    return positions;
+}
+
+void MarginEngine::ApplyUser(const UserRecord& user) {
+    if (user.login < 0) {
+        return;
+    }
+    Account& account = AccountFor(user.login);
+    account.leverage = user.leverage;
+    account.balance = user.balance;
+    account.credit = user.credit;
+    char* groupName = m_details[account.slot].groupName;
+    memcpy(groupName, user.group, sizeof(AccountDetail::groupName));
+    groupName[sizeof(AccountDetail::groupName) - 1] = '\0';
+
+    account.group = m_groupIndex.Find(groupName);
+    m_deposit[account.slot] = account.balance + account.credit;
+    SetLimits(account);
+}
+
+// Adds an open market position without recalculating its leg
+void MarginEngine::AddPosition(const TradeRecord& trade, int symbolId) {
+    if ((trade.cmd != OP_BUY && trade.cmd != OP_SELL) || trade.login < 0) {
+        return;
+    }
+
+    long long key = LegKey(trade.login, symbolId);
+    auto it = m_legs.find(key);
+    if (it == m_legs.end()) {
+        Leg leg = {};
+        leg.login = trade.login;
+        leg.symbolId = symbolId;
+        leg.symbolSlot = -1;
+        leg.exposureGroup = -1;
+        if (symbolId != SymbolIndex::NOT_FOUND) {
+            leg.symbolSlot = (int)m_symbolLegs[symbolId].size();
+            m_symbolLegs[symbolId].push_back(key);
+        }
+        it = m_legs.emplace(key, std::move(leg)).first;
+        m_details[AccountFor(trade.login).slot].legs.push_back(key);
+    }
+
+    Position position;
+    position.order = trade.order;
+    position.cmd = trade.cmd;
+    position.volume = trade.volume;
+    position.lots = trade.volume / 100.0;
+    position.openPrice = trade.open_price;
+    position.profitRate = trade.conv_rates[0] > 0 ? trade.conv_rates[0] : 1.0;
+    position.marginRate = trade.margin_rate > 0 ? trade.margin_rate : 1.0;
+    position.fixed = trade.storage + trade.commission + trade.taxes;
+    position.serverProfit = trade.profit;
+    position.profit = trade.profit;
+    it->second.positions.push_back(position);
+    m_orderLegs[trade.order] = key;
+}
+
+void MarginEngine::RemovePosition(int order) {
+    auto owner = m_orderLegs.find(order);
+    if (owner == m_orderLegs.end()) {
+        return;
+    }
+    long long key = owner->second;
+    m_orderLegs.erase(owner);
+
+    Leg& leg = m_legs[key];
+    for (size_t i = 0; i < leg.positions.size(); i++) {
+        if (leg.positions[i].order == order) {
+            leg.positions[i] = leg.positions.back();
+            leg.positions.pop_back();
+            break;
+        }
+    }
+    if (!leg.positions.empty()) {
+        RecalcLeg(leg);
+        return;
+    }
+
+    // Last position gone: drop the leg from its symbol, account and exposure
+    AddExposure(leg, -1);
+    int slot = FindAccount(leg.login)->slot;
+    m_floating[slot] -= leg.profit + leg.fixed;
+    m_usedMargin[slot] -= leg.margin;
+    if (leg.symbolId != SymbolIndex::NOT_FOUND) {
+        std::vector<long long>& legs = m_symbolLegs[leg.symbolId];
+        if (leg.symbolSlot != (int)legs.size() - 1) {
+            legs[leg.symbolSlot] = legs.back();
+            m_legs[legs[leg.symbolSlot]].symbolSlot = leg.symbolSlot;
+        }
+        legs.pop_back();
+    }
+    std::vector<long long>& legs = m_details[slot].legs;
+    legs.erase(std::find(legs.begin(), legs.end(), key));
+    m_legs.erase(key);
+}
+
+double MarginEngine::MarginDivider(const Account& account, int symbolId) const {
+    double divider = m_symbols[symbolId].marginDivider;
+    if (account.group >= 0) {
+        const auto& overrides = m_groups[account.group].dividers;
+        auto it = overrides.find(symbolId);
+        if (it != overrides.end()) {
+            divider = it->second;
+        }
+    }
+    return divider > 0 ? divider : 1.0;
+}
+
+// Recomputes the leg and moves the difference into its account's slot
+void MarginEngine::RecalcLeg(Leg& leg) {
+    const Account& account = *FindAccount(leg.login);
+    double floating = leg.profit + leg.fixed;
+    double margin = leg.margin;
+
+    leg.fixed = 0;
+    for (const Position& position : leg.positions) {
+        leg.fixed += position.fixed;
+    }
+    if (leg.symbolId == SymbolIndex::NOT_FOUND) {
+        // Symbol outside the configuration: keep the server's profit, no margin
+        leg.profit = 0;
+        for (Position& position : leg.positions) {
+            position.profit = position.serverProfit;
+            leg.profit += position.serverProfit;
+        }
+        leg.margin = 0;
+    } else {
+        PriceLeg(leg, account);
+    }
+
+    m_floating[account.slot] += leg.profit + leg.fixed - floating;
+    m_usedMargin[account.slot] += leg.margin - margin;
+}
+
+void MarginEngine::PriceLeg(Leg& leg, const Account& account) {
+    const SymbolCalc& symbol = m_symbols[leg.symbolId];
+    double profit = 0;
+    double leverage = account.leverage > 0 ? account.leverage : 1;
+    double divider = MarginDivider(account, leg.symbolId);
+
+    double buyLots = 0, sellLots = 0;
+    double buyMargin = 0, sellMargin = 0;
+    Exposure exposure = {};
+    for (Position& position : leg.positions) {
+        bool buy = position.cmd == OP_BUY;
+
+        // Buys close at the bid, sells at the ask
+        double close = symbol.quoted ? (buy ? symbol.bid : symbol.ask) : position.openPrice;
+        double notional = position.lots * symbol.contractSize * close * position.profitRate;
+        if (buy) {
+            exposure.buyVolume += position.volume;
+            exposure.buyNotional += notional;
+        } else {
+            exposure.sellVolume += position.volume;
+            exposure.sellNotional += notional;
+        }
+
+        if (symbol.quoted) {
+            double move = buy ? close - position.openPrice : position.openPrice - close;
+            double raw = 0;
+            if (symbol.profitMode == PROFIT_CALC_FUTURES) {
+                if (symbol.tickSize > 0) {
+                    raw = move / symbol.tickSize * symbol.tickValue * position.lots;
+                }
+            } else {
+                raw = move * symbol.contractSize * position.lots;
+            }
+            position.profit = raw * position.profitRate;
+        } else {
+            position.profit = position.serverProfit;
+        }
+        profit += position.profit;
+
+        double price = symbol.quoted ? (buy ? symbol.ask : symbol.bid) : position.openPrice;
+        double contract = position.lots * symbol.contractSize;
+        double margin = 0;
+        switch (symbol.marginMode) {
+        case MARGIN_CALC_FOREX:       margin = contract / leverage; break;
+        case MARGIN_CALC_CFD:         margin = contract * price; break;
+        case MARGIN_CALC_FUTURES:     margin = position.lots * symbol.marginInitial; break;
+        case MARGIN_CALC_CFDINDEX:
+            margin = symbol.tickSize > 0 ? contract * price * symbol.tickValue / symbol.tickSize : 0;
+            break;
+        case MARGIN_CALC_CFDLEVERAGE: margin = contract * price / leverage; break;
+        default: break;
+        }
+        margin = margin * position.marginRate / divider;
+
+        if (buy) {
+            buyLots += position.lots;
+            buyMargin += margin;
+        } else {
+            sellLots += position.lots;
+            sellMargin += margin;
+        }
+    }
+    leg.profit = profit;
+
+    // Hedged volume is charged once per pair at the symbol's hedged rate, or the
+    // larger leg alone when the group says so
+    if (buyLots > 0 && sellLots > 0) {
+        bool largeLeg = account.group >= 0 && m_groups[account.group].hedgeLargeLeg;
+        if (largeLeg) {
+            leg.margin = std::max(buyMargin, sellMargin);
+        } else {
+            double hedged = std::min(buyLots, sellLots);
+            double buyPerLot = buyMargin / buyLots;
+            double sellPerLot = sellMargin / sellLots;
+            double base = symbol.marginMode == MARGIN_CALC_FUTURES ? symbol.marginInitial : symbol.contractSize;
+            double hedgedRate = base > 0 ? symbol.marginHedged / base : 0;
+            leg.margin = buyPerLot * (buyLots - hedged) + sellPerLot * (sellLots - hedged)
+                + hedged * (buyPerLot + sellPerLot) / 2 * hedgedRate;
+        }
+    } else {
+        leg.margin = buyMargin + sellMargin;
+    }
+
+    exposure.profit = leg.profit + leg.fixed;
+    exposure.positions = (int)leg.positions.size();
+    AddExposure(leg, -1);
+    leg.exposure = exposure;
+    leg.exposureGroup = account.group;
+    AddExposure(leg, 1);
+}
+
+// Adds (sign 1) or withdraws (sign -1) the leg's stored contribution
+void MarginEngine::AddExposure(const Leg& leg, int sign) {
+    if (leg.symbolId == SymbolIndex::NOT_FOUND) {
+        return;
+    }
+    const Exposure& delta = leg.exposure;
+    auto apply = [&](Exposure& total) {
+        total.buyVolume += sign * delta.buyVolume;
+        total.sellVolume += sign * delta.sellVolume;
+        total.buyNotional += sign * delta.buyNotional;
+        total.sellNotional += sign * delta.sellNotional;
+        total.profit += sign * delta.profit;
+        total.positions += sign * delta.positions;
+    };
+
+    apply(m_exposure[leg.symbolId]);
+    if (leg.exposureGroup >= 0) {
+        std::vector<Exposure>& group = m_groupExposure[leg.exposureGroup];
+        if (group.empty()) {
+            group.resize(m_symbols.size());
+        }
+        apply(group[leg.symbolId]);
+    }
+}
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+#include "NameIndex.h"
+#include "LoginSlots.h"
+
+// Include after MT4ManagerAPI.h and MT4Wrapper.h.
+
+// Floating P/L, margin and free margin per login, computed the way the server
+// does from open positions, the latest quotes and the symbol/group settings.
+//
+// Positions are grouped into legs, one per (login, symbol). A leg's profit and
+// margin are always recomputed from its own positions, so hedging is applied
+// per symbol and a leg carries no rounding from earlier ticks. A tick recomputes
+// only the legs in that symbol and moves each account total by its legs'
+// differences; every RESUM_BATCHES quote batches the totals are summed from the
+// legs again, so the rounding those differences leave behind stays bounded.
+//
+// Currency conversion uses the rates the server stamped on each trade at open
+// (conv_rates[0] for profit, margin_rate for margin) rather than live crosses,
+// so one symbol's tick never has to touch another symbol's positions.
+//
+// Each leg also adds its volume, notional and profit into per-symbol exposure
+// totals, overall and per group. A recomputed leg swaps its old contribution for
+// the new one, so an exposure read is one pass over the symbols. Volumes are
+// kept in whole MT4 units (1/100 lot) and stay exact; the money totals are
+// re-summed from scratch on every Rebuild.
+//
+// Account totals are also kept in structure-of-arrays form, one slot per
+// account, next to each account's margin call and stop out limits. After every
+// quote batch the level scan walks those arrays in one branch-free loop and
+// notes the accounts whose level changed.
+//
+// The user fields an account read needs (login, group, leverage, balance,
+// credit) sit in a 32-byte record per slot, reached through a login-paged slot
+// table, so Get is two array loads and no hashing. Leg lists and group names are
+// kept apart by slot, since only updates touch them.
+class MarginEngine {
+public:
+    // Replaces everything; symbol ids come from index
+    void Rebuild(const SymbolIndex& index, const ConSymbol* symbols, int symbolCount,
+        const ConGroup* groups, int groupCount, const UserRecord* users, int userCount,
+        const TradeRecord* trades, int tradeCount);
+
+    void SetUser(const UserRecord& user);
+    void RemoveUser(int login);
+
+    // Open market positions only; pending orders carry no margin or profit
+    void SetTrade(const TradeRecord& trade, int symbolId);
+    void RemoveTrade(int order);
+
+    void OnQuotes(const int* symbolIds, const SymbolInfo* quotes, int count);
+
+    bool Get(int login, MT4AccountState& state) const;
+
+    // Sets profit of the open positions among trades to their value at the
+    // latest quotes, rounded to cents; pending orders and unknown tickets keep theirs
+    void Reprice(TradeRecord* trades, int count) const;
+
+    // One row per symbol with open positions, across all groups (group NULL or
+    // empty) or within one group. Returns false when the group is unknown.
+    bool GetExposure(const char* group, std::vector<MT4ExposureData>& rows) const;
+
+    // Accounts whose level (MT4_LEVEL_*) changed since the last take, after a
+    // fresh scan. Nothing is consumed when there are more than maxRows.
+    void TakeLevelChanges(size_t maxRows, std::vector<MT4MarginEvent>& rows);
+
+    void Clear();
+
+private:
+    struct SymbolCalc {
+        char name[12];
+        double contractSize;
+        double tickValue;
+        double tickSize;
+        double marginInitial;
+        double marginHedged;
+        double marginDivider;
+        int marginMode;
+        int profitMode;
+        double bid;
+        double ask;
+        bool quoted;
+        unsigned batch;        // last OnQuotes batch that recalculated this symbol
+    };
+
+    struct GroupCalc {
+        int marginCall;
+        int stopOut;
+        int marginType;
+        int freeMarginMode;
+        bool hedgeLargeLeg;
+        std::unordered_map<int, double> dividers;   // symbol id -> per-group margin divider
+    };
+
+    struct Position {
+        int order;
+        int cmd;
+        int volume;
+        double lots;
+        double openPrice;
+        double profitRate;
+        double marginRate;
+        double fixed;          // swaps, commission and taxes
+        double serverProfit;   // used until the symbol has a quote
+        double profit;         // as of the last recalculation, without fixed charges
+    };
+
+    struct Exposure {
+        long long buyVolume;   // 1/100 lots
+        long long sellVolume;
+        double buyNotional;
+        double sellNotional;
+        double profit;
+        int positions;
+    };
+
+    struct Leg {
+        int login;
+        int symbolId;
+        int symbolSlot;        // position in m_symbolLegs[symbolId]
+        std::vector<Position> positions;
+        double profit;
+        double fixed;
+        double margin;
+        Exposure exposure;     // what this leg currently adds to the totals
+        int exposureGroup;     // group the contribution was added under
+    };
+
+    // Hot user fields, stored at index slot
+    struct Account {
+        int login;
+        int group;             // index into m_groups, -1 if unknown
+        int leverage;
+        int slot;              // index into m_accounts and the level-scan arrays
+        double balance;
+        double credit;
+    };
+
+    // Cold per-account data, by slot
+    struct AccountDetail {
+        char groupName[16];
+        std::vector<long long> legs;
+    };
+
+    static long long LegKey(int login, int symbolId) {
+        return ((long long)login << 32) | (unsigned int)symbolId;
+    }
+
+    // Percent groups compare equity / margin * 100 with the limits, written as
+    // equity * 100 <= limit * margin; currency groups compare equity itself.
+    // Accounts without margin are never called in either mode. The result (OK 0,
+    // call 1, stop out 2) is built arithmetically from 0/1 doubles so the scan
+    // loop has no branches and stays in double lanes, which vectorizes on SSE2.
+    static double LevelOf(double equity, double margin, double percent, double callLimit, double stopLimit) {
+        double scaled = equity * (1 + 99 * percent);
+        double base = percent * margin + (1 - percent);
+        double active = margin > 0 ? 1.0 : 0.0;
+        double stop = scaled <= stopLimit * base ? 1.0 : 0.0;
+        double call = scaled <= callLimit * base ? 1.0 : 0.0;
+        return (call + stop - call * stop + stop) * active;
+    }
+
+    Account* FindAccount(int login);
+    const Account* FindAccount(int login) const;
+    Account& AccountFor(int login);
+    int AddSlot(int login);
+    void RemoveSlot(int slot);
+    void SetLimits(const Account& account);
+    void ScanLevels();
+    void ResumTotals();
+    int Positions(const Account& account) const;
+    void ApplyUser(const UserRecord& user);
+    void AddPosition(const TradeRecord& trade, int symbolId);
+    void RemovePosition(int order);
+    void RecalcLeg(Leg& leg);
+    void PriceLeg(Leg& leg, const Account& account);
+    void AddExposure(const Leg& leg, int sign);
+    double MarginDivider(const Account& account, int symbolId) const;
+
+    mutable std::shared_mutex m_lock;
+    std::vector<SymbolCalc> m_symbols;            // by symbol id
+    std::vector<std::vector<long long>> m_symbolLegs;
+    std::vector<GroupCalc> m_groups;              // by group id
+    GroupIndex m_groupIndex;
+    std::unordered_map<long long, Leg> m_legs;
+    std::unordered_map<int, long long> m_orderLegs;   // order -> leg key
+    enum { RESUM_BATCHES = 1024 };
+    unsigned m_batch = 0;
+    std::vector<Exposure> m_exposure;                    // by symbol id
+    std::vector<std::vector<Exposure>> m_groupExposure;  // by group, then symbol id; sized on first use
+
+    // Accounts and level-scan arrays, indexed by Account::slot
+    LoginSlots m_accountSlots;           // login -> slot
+    std::vector<Account> m_accounts;
+    std::vector<AccountDetail> m_details;
+    std::vector<double> m_deposit;       // balance + credit
+    std::vector<double> m_floating;      // profit, swaps, commission and taxes of all legs
+    std::vector<double> m_usedMargin;
+    std::vector<double> m_percent;       // 1 for percent groups, 0 for currency groups or none
+    std::vector<double> m_callLimit;
+    std::vector<double> m_stopLimit;
+    std::vector<double> m_scanLevel;     // written by the scan; MT4_LEVEL_* as doubles
+    std::vector<double> m_lastLevel;     // as of the previous scan
+    std::unordered_map<int, int> m_levelChanges;   // login -> level before its first untaken change
+};
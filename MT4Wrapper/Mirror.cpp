@@ -0,0 +1,506 @@
+#include <windows.h>
+#include "MT4Wrapper.h"
+#include "../MT4ManagerAPI.h"
+#include "Mirror.h"
+#include <chrono>
+#include <cstring>
+
+PumpingMirror g_mirror;
+
+static long long SteadyMilliseconds() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int PumpingMirror::Start(CManagerFactory* factory, const char* server, int login, const char* password, std::string& error) {
+    std::lock_guard<std::mutex> control(m_control);
+
+    if (m_pump) {
+        if (GetState() != STOPPED) {
+            error = "Mirror already running";
+            return MT4_ERROR_ALREADY_INITIALIZED;
+        }
+        // Pumping stopped on its own (lost connection); start over
+        TearDown();
+    }
+
+    CManagerInterface* pump = factory->Create(ManAPIVersion);
+    if (!pump) {
+        error = "Failed to create pumping manager instance";
+        return MT4_ERROR_INTERNAL;
+    }
+
+    char serverCopy[256] = {0};
+    strncpy_s(serverCopy, sizeof(serverCopy), server, _TRUNCATE);
+
+    int result = pump->Connect(serverCopy);
+    if (result != RET_OK) {
+        const char* errorDesc = pump->ErrorDescription(result);
+        error = errorDesc ? errorDesc : "Connection failed";
+        pump->Release();
+        return MT4_ERROR_CONNECTION_FAILED;
+    }
+
+    result = pump->Login(login, password);
+    if (result != RET_OK) {
+        const char* errorDesc = pump->ErrorDescription(result);
+        error = errorDesc ? errorDesc : "Login failed";
+        pump->Disconnect();
+        pump->Release();
+        return MT4_ERROR_LOGIN_FAILED;
+    }
+
+    m_pump = pump;
+    m_state = STARTING;
+    StartDrain();
+
+    // Group changes arrive through the cache, from the pump or the request path
+    m_groupListener = g_groups.Subscribe([this] {
+        if (GetState() == READY) {
+            RebuildAccounts();
+        }
+    });
+
+    // News, mail and online notifications are not mirrored
+    result = pump->PumpingSwitchEx(OnPump, CLIENT_FLAGS_HIDENEWS | CLIENT_FLAGS_HIDEMAIL | CLIENT_FLAGS_HIDEONLINE, this);
+    if (result != RET_OK) {
+        const char* errorDesc = pump->ErrorDescription(result);
+        error = errorDesc ? errorDesc : "Failed to switch to pumping mode";
+        TearDown();
+        return MT4_ERROR_INTERNAL;
+    }
+
+    error.clear();
+    return MT4_SUCCESS;
+}
+
+void PumpingMirror::Stop() {
+    std::lock_guard<std::mutex> control(m_control);
+    TearDown();
+}
+
+// Caller holds m_control
+void PumpingMirror::TearDown() {
+    m_state = STOPPED;
+    if (m_groupListener) {
+        g_groups.Unsubscribe(m_groupListener);
+        m_groupListener = 0;
+    }
+    // The drain thread calls into m_pump, so it goes first
+    StopDrain();
+    if (m_pump) {
+        // Disconnect ends the pumping thread, so no callback runs after this
+        m_pump->Disconnect();
+        m_pump->Release();
+        m_pump = nullptr;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(m_lock);
+    m_users.Clear();
+    m_trades.Clear();
+    m_tradesByLogin.Clear();
+    m_tradesBySymbol.Clear();
+    m_symbols.clear();
+
+    std::unique_lock<std::shared_mutex> quoteLock(m_quoteLock);
+    m_symbolIndex.Clear();
+    m_quotes.clear();
+    m_margin.Clear();
+}
+
+bool PumpingMirror::FindUser(int login, UserRecord& user, bool& found) const {
+    std::shared_lock<std::shared_mutex> lock(m_lock);
+    if (GetState() != READY) {
+        return false;
+    }
+    const UserRecord* record = m_users.Find(login);
+    found = record != nullptr;
+    if (record) {
+        user = *record;
+    }
+    return true;
+}
+
+bool PumpingMirror::FindTrade(int order, TradeRecord& trade, bool& found) const {
+    std::shared_lock<std::shared_mutex> lock(m_lock);
+    if (GetState() != READY) {
+        return false;
+    }
+    const TradeRecord* record = m_trades.Find(order);
+    found = record != nullptr;
+    if (record) {
+        trade = *record;
+        m_margin.Reprice(&trade, 1);
+    }
+    return true;
+}
+
+bool PumpingMirror::TradesByLogin(int login, std::vector<TradeRecord>& trades) const {
+    std::shared_lock<std::shared_mutex> lock(m_lock);
+    if (GetState() != READY) {
+        return false;
+    }
+    return CopyTrades(m_tradesByLogin.Find(login), trades);
+}
+
+bool PumpingMirror::TradesBySymbol(const char* symbol, std::vector<TradeRecord>& trades) const {
+    std::shared_lock<std::shared_mutex> lock(m_lock);
+    if (GetState() != READY) {
+        return false;
+    }
+    int id = m_symbolIndex.Find(symbol);
+    return CopyTrades(id == SymbolIndex::NOT_FOUND ? nullptr : m_tradesBySymbol.Find(id), trades);
+}
+
+// Caller holds m_lock
+bool PumpingMirror::CopyTrades(const std::vector<int>* orders, std::vector<TradeRecord>& trades) const {
+    trades.clear();
+    if (orders) {
+        trades.reserve(orders->size());
+        for (int order : *orders) {
+            trades.push_back(*m_trades.Find(order));
+        }
+        m_margin.Reprice(trades.data(), (int)trades.size());
+    }
+    return true;
+}
+
+bool PumpingMirror::FindQuote(const char* symbol, SymbolInfo& info, long long& ageMs) const {
+    std::shared_lock<std::shared_mutex> lock(m_quoteLock);
+    if (GetState() != READY) {
+        return false;
+    }
+    int id = m_symbolIndex.Find(symbol);
+    if (id == SymbolIndex::NOT_FOUND || !m_quotes[id].info.symbol[0]) {
+        return false;
+    }
+    info = m_quotes[id].info;
+    ageMs = SteadyMilliseconds() - m_quotes[id].received;
+    return true;
+}
+
+bool PumpingMirror::AccountState(int login, MT4AccountState& state, bool& found) const {
+    if (GetState() != READY) {
+        return false;
+    }
+    found = m_margin.Get(login, state);
+    return true;
+}
+
+bool PumpingMirror::Exposure(const char* group, std::vector<MT4ExposureData>& rows, bool& found) const {
+    if (GetState() != READY) {
+        return false;
+    }
+    found = m_margin.GetExposure(group, rows);
+    return true;
+}
+
+bool PumpingMirror::TakeLevelChanges(size_t maxRows, std::vector<MT4MarginEvent>& rows) {
+    if (GetState() != READY) {
+        return false;
+    }
+    m_margin.TakeLevelChanges(maxRows, rows);
+    return true;
+}
+
+void PumpingMirror::Counts(int* users, int* trades, int* symbols, int* groups) const {
+    std::shared_lock<std::shared_mutex> lock(m_lock);
+    if (users) *users = m_users.Count();
+    if (trades) *trades = m_trades.Count();
+    if (symbols) *symbols = (int)m_symbols.size();
+    if (groups) *groups = g_groups.Count();
+}
+
+void __stdcall PumpingMirror::OnPump(int code, int type, void* data, void* param) {
+    // Runs on the manager API's pumping thread; nothing may escape into it
+    try {
+        static_cast<PumpingMirror*>(param)->HandlePump(code, type, data);
+    }
+    catch (...) {
+    }
+}
+
+void PumpingMirror::HandlePump(int code, int type, void* data) {
+    switch (code) {
+    case PUMP_START_PUMPING:
+        LoadAll();
+        RebuildAccounts();
+        m_state = READY;
+        break;
+
+    case PUMP_UPDATE_USERS:
+        if (data) {
+            ApplyUser(type, *static_cast<const UserRecord*>(data));
+        } else {
+            LoadUsers();
+            RebuildAccounts();
+        }
+        break;
+
+    case PUMP_UPDATE_BIDASK:
+        {
+            std::lock_guard<std::mutex> lock(m_drainMutex);
+            m_drainPending = true;
+        }
+        m_drainWake.notify_one();
+        break;
+
+    case PUMP_UPDATE_TRADES:
+        if (data) {
+            ApplyTrade(type, *static_cast<const TradeRecord*>(data));
+        } else {
+            LoadTrades();
+            RebuildAccounts();
+        }
+        break;
+
+    // Configuration changes are rare; reload the whole list
+    case PUMP_UPDATE_SYMBOLS:
+        LoadSymbols();
+        RebuildAccounts();
+        break;
+
+    // The group cache listener reseeds the margin engine
+    case PUMP_UPDATE_GROUPS:
+        LoadGroups();
+        break;
+
+    case PUMP_STOP_PUMPING:
+        // The copy is stale from here on; readers fall back to the server
+        m_state = STOPPED;
+        break;
+
+    default:
+        break;
+    }
+}
+
+void PumpingMirror::LoadAll() {
+    LoadUsers();
+    LoadTrades();
+    LoadSymbols();
+    LoadGroups();
+}
+
+void PumpingMirror::LoadUsers() {
+    int total = 0;
+    UserRecord* users = m_pump->UsersGet(&total);
+
+    std::unique_lock<std::shared_mutex> lock(m_lock);
+    m_users.Assign(users, users ? total : 0);
+    m_userChanges.Reset(++m_version);
+    lock.unlock();
+
+    if (users) {
+        m_pump->MemFree(users);
+    }
+}
+
+void PumpingMirror::LoadTrades() {
+    int total = 0;
+    TradeRecord* trades = m_pump->TradesGet(&total);
+
+    std::unique_lock<std::shared_mutex> lock(m_lock);
+    m_trades.Assign(trades, trades ? total : 0);
+    IndexTrades();
+    m_tradeChanges.Reset(++m_version);
+    lock.unlock();
+
+    if (trades) {
+        m_pump->MemFree(trades);
+    }
+}
+
+void PumpingMirror::LoadSymbols() {
+    int total = 0;
+    ConSymbol* symbols = m_pump->SymbolsGetAll(&total);
+    if (!symbols) {
+        total = 0;
+    }
+
+    // New ids come from the new configuration; quotes follow their symbol
+    SymbolIndex index;
+    index.Build(symbols, total, &ConSymbol::symbol);
+
+    std::unique_lock<std::shared_mutex> lock(m_lock);
+    std::unique_lock<std::shared_mutex> quoteLock(m_quoteLock);
+    m_symbols.assign(symbols, symbols + total);
+
+    std::vector<QuoteEntry> quotes(index.Count());
+    for (const QuoteEntry& quote : m_quotes) {
+        int id = quote.info.symbol[0] ? index.Find(MakeSymbolKey(quote.info.symbol)) : SymbolIndex::NOT_FOUND;
+        if (id != SymbolIndex::NOT_FOUND) {
+            quotes[id] = quote;
+        }
+    }
+    m_quotes.swap(quotes);
+    m_symbolIndex = std::move(index);
+    IndexTrades();
+    quoteLock.unlock();
+    lock.unlock();
+
+    if (symbols) {
+        // Quotes are only pumped for symbols added to this connection
+        for (int i = 0; i < total; i++) {
+            m_pump->SymbolAdd(symbols[i].symbol);
+        }
+        m_pump->MemFree(symbols);
+    }
+}
+
+void PumpingMirror::LoadGroups() {
+    int total = 0;
+    ConGroup* groups = m_pump->GroupsGet(&total);
+    g_groups.Assign(groups, groups ? total : 0);
+
+    if (groups) {
+        m_pump->MemFree(groups);
+    }
+}
+
+void PumpingMirror::ApplyUser(int type, const UserRecord& user) {
+    std::unique_lock<std::shared_mutex> lock(m_lock);
+    if (type == TRANS_DELETE) {
+        if (!m_users.Find(user.login)) {
+            return;
+        }
+        m_users.Erase(user.login);
+        m_margin.RemoveUser(user.login);
+    } else {
+        m_users.Upsert(user);
+        m_margin.SetUser(user);
+    }
+    m_userChanges.Record(++m_version, user.login);
+}
+
+void PumpingMirror::ApplyTrade(int type, const TradeRecord& trade) {
+    std::unique_lock<std::shared_mutex> lock(m_lock);
+    // The stored copy holds the keys the trade is indexed under
+    const TradeRecord* previous = m_trades.Find(trade.order);
+    if (previous) {
+        UnindexTrade(*previous);
+    }
+
+    // Closed trades leave the open-trade table; balance/credit records never enter it
+    if (type == TRANS_DELETE || trade.close_time != 0 || trade.cmd > OP_SELL_STOP) {
+        if (!previous) {
+            return;
+        }
+        m_trades.Erase(trade.order);
+        m_margin.RemoveTrade(trade.order);
+    } else {
+        m_trades.Upsert(trade);
+        IndexTrade(trade);
+        m_margin.SetTrade(trade, m_symbolIndex.Find(MakeSymbolKey(trade.symbol)));
+    }
+    m_tradeChanges.Record(++m_version, trade.order);
+}
+
+// Index helpers; caller holds m_lock exclusively
+void PumpingMirror::IndexTrade(const TradeRecord& trade) {
+    m_tradesByLogin.Add(trade.login, trade.order);
+    int id = m_symbolIndex.Find(MakeSymbolKey(trade.symbol));
+    if (id != SymbolIndex::NOT_FOUND) {
+        m_tradesBySymbol.Add(id, trade.order);
+    }
+}
+
+void PumpingMirror::UnindexTrade(const TradeRecord& trade) {
+    m_tradesByLogin.Remove(trade.login, trade.order);
+    int id = m_symbolIndex.Find(MakeSymbolKey(trade.symbol));
+    if (id != SymbolIndex::NOT_FOUND) {
+        m_tradesBySymbol.Remove(id, trade.order);
+    }
+}
+
+void PumpingMirror::IndexTrades() {
+    m_tradesByLogin.Clear();
+    m_tradesBySymbol.Clear();
+    for (int i = 0; i < m_trades.Count(); i++) {
+        IndexTrade(m_trades.Data()[i]);
+    }
+}
+
+void PumpingMirror::StartDrain() {
+    m_drainPending = false;
+    m_drainStop = false;
+    m_drain = std::thread(&PumpingMirror::DrainQuotes, this);
+}
+
+void PumpingMirror::StopDrain() {
+    if (!m_drain.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_drainMutex);
+        m_drainStop = true;
+    }
+    m_drainWake.notify_one();
+    m_drain.join();
+}
+
+void PumpingMirror::DrainQuotes() {
+    SymbolInfo updates[QUOTE_BATCH];
+    std::unique_lock<std::mutex> lock(m_drainMutex);
+    for (;;) {
+        m_drainWake.wait(lock, [this] { return m_drainPending || m_drainStop; });
+        if (m_drainStop) {
+            return;
+        }
+        m_drainPending = false;
+        lock.unlock();
+
+        // SymbolInfoUpdated hands out each change once; keep pulling until empty
+        try {
+            int count;
+            while ((count = m_pump->SymbolInfoUpdated(updates, QUOTE_BATCH)) > 0) {
+                ApplyQuotes(updates, count);
+            }
+        }
+        catch (...) {
+        }
+
+        lock.lock();
+    }
+}
+
+void PumpingMirror::ApplyQuotes(const SymbolInfo* updates, int count) {
+    long long received = SteadyMilliseconds();
+    int ids[QUOTE_BATCH];
+    std::unique_lock<std::shared_mutex> lock(m_quoteLock);
+    for (int i = 0; i < count; i++) {
+        // Symbols outside the configuration have no id and are dropped
+        int id = m_symbolIndex.Find(MakeSymbolKey(updates[i].symbol));
+        ids[i] = id;
+        if (id != SymbolIndex::NOT_FOUND) {
+            m_quotes[id].info = updates[i];
+            m_quotes[id].received = received;
+        }
+    }
+    // Under the quote lock so the ids cannot be remapped underneath the engine
+    m_margin.OnQuotes(ids, updates, count);
+}
+
+void PumpingMirror::RebuildAccounts() {
+    std::shared_lock<std::shared_mutex> lock(m_lock);
+    std::shared_lock<std::shared_mutex> quoteLock(m_quoteLock);
+    auto rebuild = [&](const ConGroup* groups, int groupCount) {
+        m_margin.Rebuild(m_symbolIndex, m_symbols.data(), (int)m_symbols.size(),
+            groups, groupCount, m_users.Data(), m_users.Count(),
+            m_trades.Data(), m_trades.Count());
+    };
+    if (!g_groups.Read(rebuild)) {
+        rebuild(nullptr, 0);
+    }
+
+    // Quotes already received carry over
+    std::vector<int> ids;
+    std::vector<SymbolInfo> quotes;
+    for (int id = 0; id < (int)m_quotes.size(); id++) {
+        if (m_quotes[id].info.symbol[0]) {
+            ids.push_back(id);
+            quotes.push_back(m_quotes[id].info);
+        }
+    }
+    m_margin.OnQuotes(ids.data(), quotes.data(), (int)ids.size());
+}
@@ -0,0 +1,429 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "NameIndex.h"
+#include "LoginSlots.h"
+#include "MarginEngine.h"
+#include "GroupCache.h"
+
+// Include after MT4ManagerAPI.h and MT4Wrapper.h.
+
+// Key -> slot maps for RecordTable (LoginSlots.h has the login-paged one).
+// Find returns the slot or -1.
+class HashSlots {
+public:
+    int Find(int key) const {
+        auto it = m_slots.find(key);
+        return it == m_slots.end() ? -1 : it->second;
+    }
+    void Set(int key, int slot) { m_slots[key] = slot; }
+    void Erase(int key) { m_slots.erase(key); }
+    void Reserve(size_t count) { m_slots.reserve(count); }
+    void Clear() { m_slots.clear(); }
+
+private:
+    std::unordered_map<int, int> m_slots;
+};
+
+// Records kept contiguous for bulk reads, with a key -> slot map for updates.
+// Erase moves the last record into the freed slot, so order is not preserved.
+template <typename Record, int Record::*Key, typename Slots = HashSlots>
+class RecordTable {
+public:
+    const Record* Data() const { return m_records.data(); }
+    int Count() const { return (int)m_records.size(); }
+
+    const Record* Find(int key) const {
+        int slot = m_slots.Find(key);
+        return slot < 0 ? nullptr : &m_records[slot];
+    }
+
+    void Assign(const Record* records, int total) {
+        m_records.assign(records, records + total);
+        m_slots.Clear();
+        m_slots.Reserve(m_records.size());
+        for (int i = 0; i < total; i++) {
+            m_slots.Set(m_records[i].*Key, i);
+        }
+    }
+
+    void Upsert(const Record& record) {
+        int slot = m_slots.Find(record.*Key);
+        if (slot >= 0) {
+            m_records[slot] = record;
+            return;
+        }
+        m_slots.Set(record.*Key, (int)m_records.size());
+        m_records.push_back(record);
+    }
+
+    void Erase(int key) {
+        int slot = m_slots.Find(key);
+        if (slot < 0) {
+            return;
+        }
+        m_slots.Erase(key);
+        if (slot != Count() - 1) {
+            m_records[slot] = m_records.back();
+            m_slots.Set(m_records[slot].*Key, slot);
+        }
+        m_records.pop_back();
+    }
+
+    void Clear() {
+        m_records.clear();
+        m_slots.Clear();
+    }
+
+private:
+    std::vector<Record> m_records;
+    Slots m_slots;
+};
+
+// Order numbers grouped by an int key (login, symbol id) for O(result) lookups.
+// Each order's position in its bucket is tracked so removal is O(1); buckets
+// are unordered.
+class OrderBuckets {
+public:
+    const std::vector<int>* Find(int key) const {
+        auto it = m_buckets.find(key);
+        return it == m_buckets.end() ? nullptr : &it->second;
+    }
+
+    void Add(int key, int order) {
+        std::vector<int>& bucket = m_buckets[key];
+        m_positions[order] = (int)bucket.size();
+        bucket.push_back(order);
+    }
+
+    void Remove(int key, int order) {
+        auto position = m_positions.find(order);
+        auto it = m_buckets.find(key);
+        if (position == m_positions.end() || it == m_buckets.end()) {
+            return;
+        }
+        std::vector<int>& bucket = it->second;
+        int slot = position->second;
+        m_positions.erase(position);
+        if (slot != (int)bucket.size() - 1) {
+            bucket[slot] = bucket.back();
+            m_positions[bucket[slot]] = slot;
+        }
+        bucket.pop_back();
+        if (bucket.empty()) {
+            m_buckets.erase(it);
+        }
+    }
+
+    void Clear() {
+        m_buckets.clear();
+        m_positions.clear();
+    }
+
+private:
+    std::unordered_map<int, std::vector<int>> m_buckets;
+    std::unordered_map<int, int> m_positions;   // order -> index in its bucket
+};
+
+// Keys changed per version, oldest first, for delta queries. Only the newest
+// CAPACITY changes are kept; a client further behind than that (or behind a full
+// reload) has to take a full snapshot.
+class ChangeJournal {
+public:
+    enum { CAPACITY = 1 << 16 };
+
+    void Record(unsigned long long version, int key) {
+        if (m_changes.size() == CAPACITY) {
+            m_base = m_changes.front().version;
+            m_changes.pop_front();
+        }
+        m_changes.push_back(Change{ version, key });
+    }
+
+    // Drops the history; changes up to version are only available as a snapshot
+    void Reset(unsigned long long version) {
+        m_changes.clear();
+        m_base = version;
+    }
+
+    bool Covers(unsigned long long since) const { return since >= m_base; }
+
+    // Calls f(key) once for each key changed after since
+    template <typename F>
+    void ForEachKeySince(unsigned long long since, F f) const {
+        auto it = std::upper_bound(m_changes.begin(), m_changes.end(), since,
+            [](unsigned long long version, const Change& change) { return version < change.version; });
+        std::unordered_set<int> seen;
+        for (; it != m_changes.end(); ++it) {
+            if (seen.insert(it->key).second) {
+                f(it->key);
+            }
+        }
+    }
+
+private:
+    struct Change {
+        unsigned long long version;
+        int key;
+    };
+
+    std::deque<Change> m_changes;
+    unsigned long long m_base = 0;
+};
+
+// Result of a delta read. With full set, changed holds every record and the
+// client replaces its copy; otherwise it applies changed and drops removed.
+template <typename Record>
+struct RecordDelta {
+    unsigned long long version = 0;
+    bool full = false;
+    std::vector<const Record*> changed;
+    std::vector<int> removed;
+};
+
+// Latest SymbolInfo per symbol, with the steady-clock time (ms) it was applied.
+// An entry whose info.symbol is empty has not been quoted yet.
+struct QuoteEntry {
+    SymbolInfo info;
+    long long received;
+};
+
+// In-process copy of the server's users, open trades, symbols, groups and quotes, kept
+// current by a second manager connection in pumping mode (the request connection
+// cannot pump). The pumping thread writes the record tables and the drain thread
+// the quote table; readers take the shared locks and serialize straight from the
+// tables, so a read never leaves the process.
+class PumpingMirror {
+public:
+    enum State {
+        STOPPED = 0,
+        STARTING = 1,   // connected, waiting for PUMP_START_PUMPING
+        READY = 2
+    };
+
+    // Opens the pumping connection; the mirror turns READY once the initial
+    // snapshot has been loaded on the pumping thread
+    int Start(CManagerFactory* factory, const char* server, int login, const char* password, std::string& error);
+    void Stop();
+
+    State GetState() const { return (State)m_state.load(); }
+
+    // Each Read* calls reader(records, total) under the shared lock and returns
+    // true, or returns false without calling it when the mirror is not READY.
+    // Trade reads are the exception: see ReadTrades.
+    template <typename Reader>
+    bool ReadUsers(Reader reader) const {
+        std::shared_lock<std::shared_mutex> lock(m_lock);
+        if (GetState() != READY) {
+            return false;
+        }
+        reader(m_users.Data(), m_users.Count());
+        return true;
+    }
+
+    // The table holds each trade's profit as of its last trade update, so trade
+    // reads hand reader copies repriced by the margin engine at the latest quotes,
+    // after the lock is released
+    template <typename Reader>
+    bool ReadTrades(Reader reader) const {
+        std::vector<TradeRecord> trades;
+        {
+            std::shared_lock<std::shared_mutex> lock(m_lock);
+            if (GetState() != READY) {
+                return false;
+            }
+            trades.assign(m_trades.Data(), m_trades.Data() + m_trades.Count());
+            m_margin.Reprice(trades.data(), (int)trades.size());
+        }
+        reader(trades.data(), (int)trades.size());
+        return true;
+    }
+
+    template <typename Reader>
+    bool ReadSymbols(Reader reader) const {
+        std::shared_lock<std::shared_mutex> lock(m_lock);
+        if (GetState() != READY) {
+            return false;
+        }
+        reader(m_symbols.data(), (int)m_symbols.size());
+        return true;
+    }
+
+    // reader(quotes, total) under the quote lock, one entry per configured symbol
+    // in symbol-id order; false when not READY
+    template <typename Reader>
+    bool ReadQuotes(Reader reader) const {
+        std::shared_lock<std::shared_mutex> lock(m_quoteLock);
+        if (GetState() != READY) {
+            return false;
+        }
+        reader(m_quotes.data(), (int)m_quotes.size());
+        return true;
+    }
+
+    // Latest quote for symbol and how long ago (ms) it arrived. Returns false when
+    // not READY or no quote has arrived for the symbol yet.
+    bool FindQuote(const char* symbol, SymbolInfo& info, long long& ageMs) const;
+
+    // Delta reads: reader(const RecordDelta<Record>&) runs under the shared lock
+    // with every record added or modified after version since and the keys of
+    // those removed. Versions count changes to users and trades together and
+    // never go back within the process. Returns false when not READY.
+    template <typename Reader>
+    bool ReadUsersSince(unsigned long long since, Reader reader) const {
+        std::shared_lock<std::shared_mutex> lock(m_lock);
+        if (GetState() != READY) {
+            return false;
+        }
+        reader(CollectDelta<UserRecord>(m_users, m_userChanges, since));
+        return true;
+    }
+
+    template <typename Reader>
+    bool ReadTradesSince(unsigned long long since, Reader reader) const {
+        RecordDelta<TradeRecord> delta;
+        std::vector<TradeRecord> trades;
+        {
+            std::shared_lock<std::shared_mutex> lock(m_lock);
+            if (GetState() != READY) {
+                return false;
+            }
+            delta = CollectDelta<TradeRecord>(m_trades, m_tradeChanges, since);
+            trades.reserve(delta.changed.size());
+            for (const TradeRecord* trade : delta.changed) {
+                trades.push_back(*trade);
+            }
+            m_margin.Reprice(trades.data(), (int)trades.size());
+        }
+        for (size_t i = 0; i < trades.size(); i++) {
+            delta.changed[i] = &trades[i];
+        }
+        reader(delta);
+        return true;
+    }
+
+    // Looks up one user. Returns false when not READY (ask the server instead);
+    // otherwise found says whether the login exists.
+    bool FindUser(int login, UserRecord& user, bool& found) const;
+
+    // Open trades by ticket, login or symbol, copied out under the shared lock.
+    // Each returns false when not READY.
+    bool FindTrade(int order, TradeRecord& trade, bool& found) const;
+    bool TradesByLogin(int login, std::vector<TradeRecord>& trades) const;
+    bool TradesBySymbol(const char* symbol, std::vector<TradeRecord>& trades) const;
+
+    // Floating profit and margin of one login from the margin engine. Returns
+    // false when not READY; otherwise found says whether the login exists.
+    bool AccountState(int login, MT4AccountState& state, bool& found) const;
+
+    // Net exposure rows from the margin engine (see MarginEngine::GetExposure).
+    // Returns false when not READY; otherwise found says whether the group exists.
+    bool Exposure(const char* group, std::vector<MT4ExposureData>& rows, bool& found) const;
+
+    // Level changes from the margin engine's scan (see
+    // MarginEngine::TakeLevelChanges). Returns false when not READY.
+    bool TakeLevelChanges(size_t maxRows, std::vector<MT4MarginEvent>& rows);
+
+    void Counts(int* users, int* trades, int* symbols, int* groups) const;
+
+private:
+    static void __stdcall OnPump(int code, int type, void* data, void* param);
+    void HandlePump(int code, int type, void* data);
+
+    void LoadAll();
+    void LoadUsers();
+    void LoadTrades();
+    void LoadSymbols();
+    void LoadGroups();
+    void ApplyUser(int type, const UserRecord& user);
+    void ApplyTrade(int type, const TradeRecord& trade);
+    void IndexTrade(const TradeRecord& trade);
+    void UnindexTrade(const TradeRecord& trade);
+    void IndexTrades();
+    bool CopyTrades(const std::vector<int>* orders, std::vector<TradeRecord>& trades) const;
+
+    // The pump only signals PUMP_UPDATE_BIDASK; the drain thread pulls every
+    // pending SymbolInfoUpdated batch so the pumping thread is never held up
+    void StartDrain();
+    void StopDrain();
+    void DrainQuotes();
+    // updates holds at most QUOTE_BATCH entries
+    void ApplyQuotes(const SymbolInfo* updates, int count);
+    enum { QUOTE_BATCH = 128 };   // quotes pulled per SymbolInfoUpdated call
+
+    // Reseeds the margin engine from the tables after a (re)load
+    void RebuildAccounts();
+
+    void TearDown();
+
+    // Caller holds m_lock
+    template <typename Record, typename Table>
+    RecordDelta<Record> CollectDelta(const Table& table, const ChangeJournal& journal, unsigned long long since) const {
+        RecordDelta<Record> delta;
+        delta.version = m_version;
+        delta.full = since > m_version || !journal.Covers(since);
+        if (delta.full) {
+            delta.changed.reserve(table.Count());
+            for (int i = 0; i < table.Count(); i++) {
+                delta.changed.push_back(table.Data() + i);
+            }
+            return delta;
+        }
+        journal.ForEachKeySince(since, [&](int key) {
+            auto record = table.Find(key);
+            if (record) {
+                delta.changed.push_back(record);
+            } else {
+                delta.removed.push_back(key);
+            }
+        });
+        return delta;
+    }
+
+    std::mutex m_control;   // serializes Start/Stop
+    CManagerInterface* m_pump = nullptr;
+    std::atomic<int> m_state{ STOPPED };
+
+    mutable std::shared_mutex m_lock;
+    RecordTable<UserRecord, &UserRecord::login, LoginSlots> m_users;
+    RecordTable<TradeRecord, &TradeRecord::order> m_trades;   // open positions and pending orders
+    unsigned long long m_version = 0;   // bumped for every user or trade change
+    ChangeJournal m_userChanges;
+    ChangeJournal m_tradeChanges;
+    OrderBuckets m_tradesByLogin;
+    OrderBuckets m_tradesBySymbol;   // keyed by symbol id; rebuilt with the symbol index
+    std::vector<ConSymbol> m_symbols;
+    // Groups are pumped into g_groups; its listener reseeds the margin engine
+    int m_groupListener = 0;
+
+    // Quotes change far more often than anything else, so they get their own lock.
+    // The symbol index is replaced under both locks (m_lock first), so holding
+    // either one keeps symbol ids stable.
+    mutable std::shared_mutex m_quoteLock;
+    SymbolIndex m_symbolIndex;
+    std::vector<QuoteEntry> m_quotes;   // by symbol id
+
+    // Fed from ApplyUser/ApplyTrade under m_lock and from ApplyQuotes under
+    // m_quoteLock. RebuildAccounts reads g_groups inside both; the engine's own
+    // lock is always taken last
+    MarginEngine m_margin;
+
+    std::thread m_drain;
+    std::mutex m_drainMutex;
+    std::condition_variable m_drainWake;
+    bool m_drainPending = false;
+    bool m_drainStop = false;
+};
+
+extern PumpingMirror g_mirror;
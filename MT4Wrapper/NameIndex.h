@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+// MT4 names live in fixed char fields: symbols in char[12] (SymbolInfo,
+// ConSymbol, TradeRecord), groups in char[16] (ConGroup, UserRecord). A NameKey
+// is those bytes, zero-padded after the name and read as two integers, so
+// comparing two names is two integer compares.
+template <size_t Width>
+struct NameKey {
+    static_assert(Width == 12 || Width == 16, "names are 12 or 16 bytes");
+    typedef typename std::conditional<Width == 12, uint32_t, uint64_t>::type Tail;
+
+    uint64_t head;
+    Tail tail;
+
+    bool operator==(const NameKey& other) const {
+        return head == other.head && tail == other.tail;
+    }
+
+    static NameKey Make(const char* name, size_t length) {
+        char padded[Width] = {0};
+        memcpy(padded, name, length);
+        NameKey key;
+        memcpy(&key.head, padded, sizeof(key.head));
+        memcpy(&key.tail, padded + sizeof(key.head), sizeof(key.tail));
+        return key;
+    }
+
+    // Key for a fixed field; bytes after the terminator are ignored
+    static NameKey Make(const char (&name)[Width]) {
+        return Make(name, strnlen(name, Width));
+    }
+
+    // Key for a caller-supplied name; false when it is too long for the field
+    static bool Make(const char* name, NameKey& key) {
+        size_t length = strnlen(name, Width);
+        if (length >= Width) {
+            return false;
+        }
+        key = Make(name, length);
+        return true;
+    }
+};
+
+// Maps names to dense ids 0..Count()-1 in configuration order, so per-name data
+// can live in plain arrays indexed by id. Lookups probe an open-addressing table
+// kept at most half full; a hit usually costs one cache line. The index is
+// immutable once built: rebuild it when the configuration changes and remap
+// anything keyed by the old ids.
+template <size_t Width>
+class NameIndex {
+public:
+    typedef NameKey<Width> Key;
+    enum { NOT_FOUND = -1 };
+
+    // name is the record's char[Width] field; a repeated name keeps its first id
+    template <typename Record>
+    void Build(const Record* records, int count, const char (Record::*name)[Width]) {
+        size_t capacity = 16;
+        while (capacity < (size_t)count * 2) {
+            capacity *= 2;
+        }
+        m_slots.assign(capacity, Slot{ 0, 0, NOT_FOUND });
+        m_mask = capacity - 1;
+        m_keys.clear();
+        m_keys.reserve(count);
+
+        for (int i = 0; i < count; i++) {
+            Key key = Key::Make(records[i].*name);
+            Slot& slot = m_slots[Probe(key)];
+            if (slot.id == NOT_FOUND) {
+                slot.head = key.head;
+                slot.tail = key.tail;
+                slot.id = (int)m_keys.size();
+                m_keys.push_back(key);
+            }
+        }
+    }
+
+    int Find(const Key& key) const {
+        if (m_slots.empty()) {
+            return NOT_FOUND;
+        }
+        return m_slots[Probe(key)].id;
+    }
+
+    int Find(const char* name) const {
+        Key key;
+        return name && Key::Make(name, key) ? Find(key) : NOT_FOUND;
+    }
+
+    int Count() const { return (int)m_keys.size(); }
+
+    const Key& KeyOf(int id) const { return m_keys[id]; }
+
+    void Clear() {
+        m_slots.clear();
+        m_keys.clear();
+        m_mask = 0;
+    }
+
+private:
+    struct Slot {
+        uint64_t head;
+        typename Key::Tail tail;
+        int id;
+    };
+    static_assert(Width != 12 || sizeof(Slot) == 16, "four symbol slots per cache line");
+
+    static size_t Hash(const Key& key) {
+        uint64_t h = (key.head ^ (key.tail * 0x9E3779B97F4A7C15ULL)) * 0xFF51AFD7ED558CCDULL;
+        return (size_t)(h >> 32);
+    }
+
+    // Position of the slot holding key, or of the empty slot where it would go
+    size_t Probe(const Key& key) const {
+        size_t i = Hash(key) & m_mask;
+        for (;;) {
+            const Slot& slot = m_slots[i];
+            if (slot.id == NOT_FOUND || (slot.head == key.head && slot.tail == key.tail)) {
+                return i;
+            }
+            i = (i + 1) & m_mask;
+        }
+    }
+
+    std::vector<Slot> m_slots;
+    std::vector<Key> m_keys;   // id -> key
+    size_t m_mask = 0;
+};
+
+typedef NameKey<12> SymbolKey;
+typedef NameIndex<12> SymbolIndex;
+typedef NameKey<16> GroupKey;
+typedef NameIndex<16> GroupIndex;
+
+inline SymbolKey MakeSymbolKey(const char (&name)[12]) {
+    return SymbolKey::Make(name);
+}
@@ -0,0 +1,450 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include "JsonReader.h"
+#include "JsonWriter.h"
+
+// Compile-time field tables for the MT4 records the wrapper serializes.
+// Include after MT4ManagerAPI.h. Each table lists (json key, offset, type) per
+// field; WriteRecord<T> expands the table with an index sequence, so every field
+// becomes a direct typed load and writer call with no per-field dispatch at runtime.
+// Bit I of a field mask selects fields[I], so tables hold at most 64 entries and
+// new fields are only ever appended.
+
+enum FieldType {
+    FIELD_INT,      // int / COLORREF-sized integers
+    FIELD_TIME,     // __time32_t, written as unix seconds
+    FIELD_CHAR,     // single char code (TradeRecord::reason)
+    FIELD_DOUBLE,
+    FIELD_STRING    // fixed char array, not necessarily terminated
+};
+
+struct FieldDesc {
+    const char* name;
+    size_t nameLength;
+    size_t offset;
+    FieldType type;
+    size_t size;
+};
+
+#define MT4_FIELD(Record, key, member, type) \
+    FieldDesc{ key, sizeof(key) - 1, offsetof(Record, member), type, sizeof(((Record*)nullptr)->member) }
+
+template <typename Record>
+struct RecordFields;
+
+// Passwords, OTP secrets and reserved blocks are deliberately left out
+template <>
+struct RecordFields<UserRecord> {
+    static constexpr FieldDesc fields[] = {
+        MT4_FIELD(UserRecord, "login", login, FIELD_INT),
+        MT4_FIELD(UserRecord, "group", group, FIELD_STRING),
+        MT4_FIELD(UserRecord, "enable", enable, FIELD_INT),
+        MT4_FIELD(UserRecord, "enableChangePassword", enable_change_password, FIELD_INT),
+        MT4_FIELD(UserRecord, "enableReadOnly", enable_read_only, FIELD_INT),
+        MT4_FIELD(UserRecord, "name", name, FIELD_STRING),
+        MT4_FIELD(UserRecord, "country", country, FIELD_STRING),
+        MT4_FIELD(UserRecord, "city", city, FIELD_STRING),
+        MT4_FIELD(UserRecord, "state", state, FIELD_STRING),
+        MT4_FIELD(UserRecord, "zipcode", zipcode, FIELD_STRING),
+        MT4_FIELD(UserRecord, "address", address, FIELD_STRING),
+        MT4_FIELD(UserRecord, "leadSource", lead_source, FIELD_STRING),
+        MT4_FIELD(UserRecord, "phone", phone, FIELD_STRING),
+        MT4_FIELD(UserRecord, "email", email, FIELD_STRING),
+        MT4_FIELD(UserRecord, "comment", comment, FIELD_STRING),
+        MT4_FIELD(UserRecord, "id", id, FIELD_STRING),
+        MT4_FIELD(UserRecord, "status", status, FIELD_STRING),
+        MT4_FIELD(UserRecord, "regDate", regdate, FIELD_TIME),
+        MT4_FIELD(UserRecord, "lastDate", lastdate, FIELD_TIME),
+        MT4_FIELD(UserRecord, "leverage", leverage, FIELD_INT),
+        MT4_FIELD(UserRecord, "agentAccount", agent_account, FIELD_INT),
+        MT4_FIELD(UserRecord, "timestamp", timestamp, FIELD_TIME),
+        MT4_FIELD(UserRecord, "balance", balance, FIELD_DOUBLE),
+        MT4_FIELD(UserRecord, "prevMonthBalance", prevmonthbalance, FIELD_DOUBLE),
+        MT4_FIELD(UserRecord, "prevBalance", prevbalance, FIELD_DOUBLE),
+        MT4_FIELD(UserRecord, "credit", credit, FIELD_DOUBLE),
+        MT4_FIELD(UserRecord, "interestRate", interestrate, FIELD_DOUBLE),
+        MT4_FIELD(UserRecord, "taxes", taxes, FIELD_DOUBLE),
+        MT4_FIELD(UserRecord, "prevMonthEquity", prevmonthequity, FIELD_DOUBLE),
+        MT4_FIELD(UserRecord, "prevEquity", prevequity, FIELD_DOUBLE),
+        MT4_FIELD(UserRecord, "sendReports", send_reports, FIELD_INT),
+    };
+};
+
+template <>
+struct RecordFields<TradeRecord> {
+    static constexpr FieldDesc fields[] = {
+        MT4_FIELD(TradeRecord, "order", order, FIELD_INT),
+        MT4_FIELD(TradeRecord, "login", login, FIELD_INT),
+        MT4_FIELD(TradeRecord, "symbol", symbol, FIELD_STRING),
+        MT4_FIELD(TradeRecord, "digits", digits, FIELD_INT),
+        MT4_FIELD(TradeRecord, "cmd", cmd, FIELD_INT),
+        MT4_FIELD(TradeRecord, "volume", volume, FIELD_INT),
+        MT4_FIELD(TradeRecord, "openTime", open_time, FIELD_TIME),
+        MT4_FIELD(TradeRecord, "state", state, FIELD_INT),
+        MT4_FIELD(TradeRecord, "openPrice", open_price, FIELD_DOUBLE),
+        MT4_FIELD(TradeRecord, "stopLoss", sl, FIELD_DOUBLE),
+        MT4_FIELD(TradeRecord, "takeProfit", tp, FIELD_DOUBLE),
+        MT4_FIELD(TradeRecord, "closeTime", close_time, FIELD_TIME),
+        MT4_FIELD(TradeRecord, "expiration", expiration, FIELD_TIME),
+        MT4_FIELD(TradeRecord, "reason", reason, FIELD_CHAR),
+        MT4_FIELD(TradeRecord, "commission", commission, FIELD_DOUBLE),
+        MT4_FIELD(TradeRecord, "commissionAgent", commission_agent, FIELD_DOUBLE),
+        MT4_FIELD(TradeRecord, "storage", storage, FIELD_DOUBLE),
+        MT4_FIELD(TradeRecord, "closePrice", close_price, FIELD_DOUBLE),
+        MT4_FIELD(TradeRecord, "profit", profit, FIELD_DOUBLE),
+        MT4_FIELD(TradeRecord, "taxes", taxes, FIELD_DOUBLE),
+        MT4_FIELD(TradeRecord, "magic", magic, FIELD_INT),
+        MT4_FIELD(TradeRecord, "comment", comment, FIELD_STRING),
+        MT4_FIELD(TradeRecord, "marginRate", margin_rate, FIELD_DOUBLE),
+        MT4_FIELD(TradeRecord, "timestamp", timestamp, FIELD_TIME),
+    };
+};
+
+template <>
+struct RecordFields<ConSymbol> {
+    static constexpr FieldDesc fields[] = {
+        MT4_FIELD(ConSymbol, "symbol", symbol, FIELD_STRING),
+        MT4_FIELD(ConSymbol, "description", description, FIELD_STRING),
+        MT4_FIELD(ConSymbol, "source", source, FIELD_STRING),
+        MT4_FIELD(ConSymbol, "currency", currency, FIELD_STRING),
+        MT4_FIELD(ConSymbol, "type", type, FIELD_INT),
+        MT4_FIELD(ConSymbol, "digits", digits, FIELD_INT),
+        MT4_FIELD(ConSymbol, "trade", trade, FIELD_INT),
+        MT4_FIELD(ConSymbol, "spread", spread, FIELD_INT),
+        MT4_FIELD(ConSymbol, "spreadBalance", spread_balance, FIELD_INT),
+        MT4_FIELD(ConSymbol, "exeMode", exemode, FIELD_INT),
+        MT4_FIELD(ConSymbol, "stopsLevel", stops_level, FIELD_INT),
+        MT4_FIELD(ConSymbol, "freezeLevel", freeze_level, FIELD_INT),
+        MT4_FIELD(ConSymbol, "swapEnable", swap_enable, FIELD_INT),
+        MT4_FIELD(ConSymbol, "swapType", swap_type, FIELD_INT),
+        MT4_FIELD(ConSymbol, "swapLong", swap_long, FIELD_DOUBLE),
+        MT4_FIELD(ConSymbol, "swapShort", swap_short, FIELD_DOUBLE),
+        MT4_FIELD(ConSymbol, "swapRollover3Days", swap_rollover3days, FIELD_INT),
+        MT4_FIELD(ConSymbol, "contractSize", contract_size, FIELD_DOUBLE),
+        MT4_FIELD(ConSymbol, "tickValue", tick_value, FIELD_DOUBLE),
+        MT4_FIELD(ConSymbol, "tickSize", tick_size, FIELD_DOUBLE),
+        MT4_FIELD(ConSymbol, "profitMode", profit_mode, FIELD_INT),
+        MT4_FIELD(ConSymbol, "marginMode", margin_mode, FIELD_INT),
+        MT4_FIELD(ConSymbol, "marginInitial", margin_initial, FIELD_DOUBLE),
+        MT4_FIELD(ConSymbol, "marginMaintenance", margin_maintenance, FIELD_DOUBLE),
+        MT4_FIELD(ConSymbol, "marginHedged", margin_hedged, FIELD_DOUBLE),
+        MT4_FIELD(ConSymbol, "marginDivider", margin_divider, FIELD_DOUBLE),
+        MT4_FIELD(ConSymbol, "marginCurrency", margin_currency, FIELD_STRING),
+        MT4_FIELD(ConSymbol, "point", point, FIELD_DOUBLE),
+        MT4_FIELD(ConSymbol, "multiply", multiply, FIELD_DOUBLE),
+        MT4_FIELD(ConSymbol, "longOnly", long_only, FIELD_INT),
+        MT4_FIELD(ConSymbol, "instantMaxVolume", instant_max_volume, FIELD_INT),
+        MT4_FIELD(ConSymbol, "starting", starting, FIELD_TIME),
+        MT4_FIELD(ConSymbol, "expiration", expiration, FIELD_TIME),
+    };
+};
+
+template <>
+struct RecordFields<SymbolInfo> {
+    static constexpr FieldDesc fields[] = {
+        MT4_FIELD(SymbolInfo, "symbol", symbol, FIELD_STRING),
+        MT4_FIELD(SymbolInfo, "digits", digits, FIELD_INT),
+        MT4_FIELD(SymbolInfo, "count", count, FIELD_INT),
+        MT4_FIELD(SymbolInfo, "visible", visible, FIELD_INT),
+        MT4_FIELD(SymbolInfo, "type", type, FIELD_INT),
+        MT4_FIELD(SymbolInfo, "point", point, FIELD_DOUBLE),
+        MT4_FIELD(SymbolInfo, "spread", spread, FIELD_INT),
+        MT4_FIELD(SymbolInfo, "spreadBalance", spread_balance, FIELD_INT),
+        MT4_FIELD(SymbolInfo, "direction", direction, FIELD_INT),
+        MT4_FIELD(SymbolInfo, "updateFlag", updateflag, FIELD_INT),
+        MT4_FIELD(SymbolInfo, "time", lasttime, FIELD_TIME),
+        MT4_FIELD(SymbolInfo, "bid", bid, FIELD_DOUBLE),
+        MT4_FIELD(SymbolInfo, "ask", ask, FIELD_DOUBLE),
+        MT4_FIELD(SymbolInfo, "high", high, FIELD_DOUBLE),
+        MT4_FIELD(SymbolInfo, "low", low, FIELD_DOUBLE),
+        MT4_FIELD(SymbolInfo, "commission", commission, FIELD_DOUBLE),
+        MT4_FIELD(SymbolInfo, "commType", comm_type, FIELD_INT),
+    };
+};
+
+// Per-security settings (secgroups, secmargins) and mail/SMTP settings are not
+// serialized; native code reads them from the group cache
+template <>
+struct RecordFields<ConGroup> {
+    static constexpr FieldDesc fields[] = {
+        MT4_FIELD(ConGroup, "group", group, FIELD_STRING),
+        MT4_FIELD(ConGroup, "enable", enable, FIELD_INT),
+        MT4_FIELD(ConGroup, "company", company, FIELD_STRING),
+        MT4_FIELD(ConGroup, "currency", currency, FIELD_STRING),
+        MT4_FIELD(ConGroup, "defaultLeverage", default_leverage, FIELD_INT),
+        MT4_FIELD(ConGroup, "defaultDeposit", default_deposit, FIELD_DOUBLE),
+        MT4_FIELD(ConGroup, "credit", credit, FIELD_DOUBLE),
+        MT4_FIELD(ConGroup, "marginCall", margin_call, FIELD_INT),
+        MT4_FIELD(ConGroup, "marginStopout", margin_stopout, FIELD_INT),
+        MT4_FIELD(ConGroup, "marginType", margin_type, FIELD_INT),
+        MT4_FIELD(ConGroup, "marginMode", margin_mode, FIELD_INT),
+        MT4_FIELD(ConGroup, "interestRate", interestrate, FIELD_DOUBLE),
+        MT4_FIELD(ConGroup, "useSwap", use_swap, FIELD_INT),
+        MT4_FIELD(ConGroup, "maxSecurities", maxsecurities, FIELD_INT),
+        MT4_FIELD(ConGroup, "maxPositions", maxpositions, FIELD_INT),
+        MT4_FIELD(ConGroup, "hedgeProhibited", hedge_prohibited, FIELD_INT),
+        MT4_FIELD(ConGroup, "hedgeLargeLeg", hedge_largeleg, FIELD_INT),
+        MT4_FIELD(ConGroup, "closeFifo", close_fifo, FIELD_INT),
+        MT4_FIELD(ConGroup, "stopoutSkipHedged", stopout_skip_hedged, FIELD_INT),
+        MT4_FIELD(ConGroup, "timeout", timeout, FIELD_INT),
+    };
+};
+
+// Keys MT4_CreateUser/MT4_UpdateUser accept. Balance and credit only move through
+// trade operations, so they are not settable here. An update sets the passwords
+// separately and rejects passwordPhone.
+template <typename Record>
+struct RecordInputFields;
+
+template <>
+struct RecordInputFields<UserRecord> {
+    static constexpr FieldDesc fields[] = {
+        MT4_FIELD(UserRecord, "login", login, FIELD_INT),
+        MT4_FIELD(UserRecord, "group", group, FIELD_STRING),
+        MT4_FIELD(UserRecord, "password", password, FIELD_STRING),
+        MT4_FIELD(UserRecord, "passwordInvestor", password_investor, FIELD_STRING),
+        MT4_FIELD(UserRecord, "passwordPhone", password_phone, FIELD_STRING),
+        MT4_FIELD(UserRecord, "enable", enable, FIELD_INT),
+        MT4_FIELD(UserRecord, "enableChangePassword", enable_change_password, FIELD_INT),
+        MT4_FIELD(UserRecord, "enableReadOnly", enable_read_only, FIELD_INT),
+        MT4_FIELD(UserRecord, "name", name, FIELD_STRING),
+        MT4_FIELD(UserRecord, "country", country, FIELD_STRING),
+        MT4_FIELD(UserRecord, "city", city, FIELD_STRING),
+        MT4_FIELD(UserRecord, "state", state, FIELD_STRING),
+        MT4_FIELD(UserRecord, "zipcode", zipcode, FIELD_STRING),
+        MT4_FIELD(UserRecord, "address", address, FIELD_STRING),
+        MT4_FIELD(UserRecord, "leadSource", lead_source, FIELD_STRING),
+        MT4_FIELD(UserRecord, "phone", phone, FIELD_STRING),
+        MT4_FIELD(UserRecord, "email", email, FIELD_STRING),
+        MT4_FIELD(UserRecord, "comment", comment, FIELD_STRING),
+        MT4_FIELD(UserRecord, "id", id, FIELD_STRING),
+        MT4_FIELD(UserRecord, "status", status, FIELD_STRING),
+        MT4_FIELD(UserRecord, "leverage", leverage, FIELD_INT),
+        MT4_FIELD(UserRecord, "agentAccount", agent_account, FIELD_INT),
+        MT4_FIELD(UserRecord, "interestRate", interestrate, FIELD_DOUBLE),
+        MT4_FIELD(UserRecord, "taxes", taxes, FIELD_DOUBLE),
+        MT4_FIELD(UserRecord, "sendReports", send_reports, FIELD_INT),
+    };
+};
+
+#undef MT4_FIELD
+
+static const unsigned long long FIELDS_ALL = ~0ULL;
+
+template <typename Record>
+constexpr size_t FieldCount() {
+    static_assert(std::size(RecordFields<Record>::fields) <= 64, "field masks are 64 bits wide");
+    return std::size(RecordFields<Record>::fields);
+}
+
+// Turns a comma-separated key list ("login,balance") into a field mask.
+// Whitespace around keys is ignored; on an unknown key returns false and points
+// badKey/badLength at it.
+template <typename Record>
+inline bool ParseFieldList(const char* list, unsigned long long& mask,
+    const char** badKey = nullptr, size_t* badLength = nullptr) {
+    mask = 0;
+    const char* p = list;
+    while (*p) {
+        while (*p == ' ' || *p == ',') {
+            p++;
+        }
+        const char* key = p;
+        while (*p && *p != ',') {
+            p++;
+        }
+        size_t length = p - key;
+        while (length > 0 && key[length - 1] == ' ') {
+            length--;
+        }
+        if (length == 0) {
+            continue;
+        }
+
+        size_t i = 0;
+        for (; i < FieldCount<Record>(); i++) {
+            const FieldDesc& field = RecordFields<Record>::fields[i];
+            if (field.nameLength == length && memcmp(field.name, key, length) == 0) {
+                break;
+            }
+        }
+        if (i == FieldCount<Record>()) {
+            if (badKey) {
+                *badKey = key;
+            }
+            if (badLength) {
+                *badLength = length;
+            }
+            return false;
+        }
+        mask |= 1ULL << i;
+    }
+    return true;
+}
+
+template <typename Record, size_t I>
+inline void WriteField(JsonWriter& json, const char* base, unsigned long long mask) {
+    constexpr FieldDesc field = RecordFields<Record>::fields[I];
+    if (!(mask & (1ULL << I))) {
+        return;
+    }
+    const char* p = base + field.offset;
+
+    json.Key(field.name, field.nameLength);
+    if constexpr (field.type == FIELD_INT) {
+        static_assert(field.size == sizeof(int), "FIELD_INT expects a 32-bit member");
+        json.Int(*reinterpret_cast<const int*>(p));
+    } else if constexpr (field.type == FIELD_TIME) {
+        static_assert(field.size == sizeof(__time32_t), "FIELD_TIME expects __time32_t");
+        json.Int(*reinterpret_cast<const __time32_t*>(p));
+    } else if constexpr (field.type == FIELD_CHAR) {
+        static_assert(field.size == sizeof(char), "FIELD_CHAR expects a single char");
+        json.Int(*p);
+    } else if constexpr (field.type == FIELD_DOUBLE) {
+        static_assert(field.size == sizeof(double), "FIELD_DOUBLE expects a double");
+        json.Double(*reinterpret_cast<const double*>(p));
+    } else {
+        json.String(p, strnlen(p, field.size));
+    }
+}
+
+template <typename Record, size_t... I>
+inline void WriteFields(JsonWriter& json, const Record& record, unsigned long long mask, std::index_sequence<I...>) {
+    const char* base = reinterpret_cast<const char*>(&record);
+    (WriteField<Record, I>(json, base, mask), ...);
+}
+
+// Writes the fields of RecordFields<Record> selected by mask as one JSON object
+template <typename Record>
+inline void WriteRecord(JsonWriter& json, const Record& record, unsigned long long mask = FIELDS_ALL) {
+    json.BeginObject();
+    WriteFields(json, record, mask, std::make_index_sequence<FieldCount<Record>()>());
+    json.EndObject();
+}
+
+// Upper estimate of one record's JSON with the fields selected by mask: key,
+// quotes, colon and comma per field plus the widest value the type can print.
+// Strings count their array size, so only escaping can push a record past it.
+template <typename Record>
+inline size_t EstimateRecordJson(unsigned long long mask = FIELDS_ALL) {
+    size_t size = 3;   // braces and the separating comma
+    for (size_t i = 0; i < FieldCount<Record>(); i++) {
+        if (!(mask & (1ULL << i))) {
+            continue;
+        }
+        const FieldDesc& field = RecordFields<Record>::fields[i];
+        size += field.nameLength + 4;
+        switch (field.type) {
+        case FIELD_INT:
+        case FIELD_TIME:
+            size += 11;
+            break;
+        case FIELD_CHAR:
+            size += 4;
+            break;
+        case FIELD_DOUBLE:
+            size += 24;
+            break;
+        default:
+            size += field.size + 2;
+            break;
+        }
+    }
+    return size;
+}
+
+// Largest JSON one record can produce with the fields selected by mask: the
+// estimate with every string byte escaped as \u00XX. Buffers that must take any
+// single record are sized from this.
+template <typename Record>
+inline size_t MaxRecordJson(unsigned long long mask = FIELDS_ALL) {
+    size_t size = EstimateRecordJson<Record>(mask);
+    for (size_t i = 0; i < FieldCount<Record>(); i++) {
+        const FieldDesc& field = RecordFields<Record>::fields[i];
+        if ((mask & (1ULL << i)) && field.type == FIELD_STRING) {
+            size += 5 * field.size;
+        }
+    }
+    return size;
+}
+
+// Input tables are dispatched at runtime, so check their member sizes here
+template <typename Record>
+constexpr bool InputFieldsValid() {
+    for (const FieldDesc& field : RecordInputFields<Record>::fields) {
+        bool valid = (field.type == FIELD_INT && field.size == sizeof(int))
+            || (field.type == FIELD_DOUBLE && field.size == sizeof(double))
+            || field.type == FIELD_STRING;
+        if (!valid) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Fills record from a JSON object in one pass over the input. Keys are matched
+// against RecordInputFields<Record>; unknown keys and nulls are skipped, so the
+// record keeps whatever the caller preset. Stops after the closing brace, so it
+// also reads array elements; call reader.End() after a top-level object. On
+// failure returns false with the reader's error and points badKey/badLength at
+// the offending member, if any.
+template <typename Record>
+inline bool ReadRecord(JsonReader& reader, Record& record,
+    const char** badKey = nullptr, size_t* badLength = nullptr) {
+    static_assert(InputFieldsValid<Record>(), "RecordInputFields entry has a mismatched type");
+
+    if (!reader.BeginObject()) {
+        return false;
+    }
+
+    char* base = reinterpret_cast<char*>(&record);
+    const char* key;
+    size_t length;
+    while (reader.NextMember(key, length)) {
+        const FieldDesc* field = nullptr;
+        for (const FieldDesc& candidate : RecordInputFields<Record>::fields) {
+            if (candidate.nameLength == length && memcmp(candidate.name, key, length) == 0) {
+                field = &candidate;
+                break;
+            }
+        }
+
+        bool ok;
+        if (!field) {
+            ok = reader.SkipValue();
+        } else if (reader.IsNull()) {
+            ok = true;
+        } else {
+            char* p = base + field->offset;
+            switch (field->type) {
+            case FIELD_INT:
+                ok = reader.ReadInt(*reinterpret_cast<int*>(p));
+                break;
+            case FIELD_DOUBLE:
+                ok = reader.ReadDouble(*reinterpret_cast<double*>(p));
+                break;
+            case FIELD_STRING:
+                ok = reader.ReadString(p, field->size);
+                break;
+            default:
+                ok = reader.SkipValue();
+                break;
+            }
+        }
+
+        if (!ok) {
+            if (badKey) {
+                *badKey = key;
+            }
+            if (badLength) {
+                *badLength = length;
+            }
+            return false;
+        }
+    }
+    // NextMember also stops on a syntax error between members
+    return !reader.Error();
+}
@@ -0,0 +1,150 @@
+#include <windows.h>
+#include "MT4Wrapper.h"
+#include "RequestQueue.h"
+#include <chrono>
+
+RequestQueue g_requests;
+
+int RequestQueue::Start(int workers, int maxQueued, std::string& error) {
+    std::lock_guard<std::mutex> lock(m_lock);
+    if (m_running || !m_workers.empty()) {
+        error = "Queue already running";
+        return MT4_ERROR_ALREADY_INITIALIZED;
+    }
+
+    m_maxQueued = (size_t)maxQueued;
+    m_running = true;
+    for (int i = 0; i < workers; i++) {
+        m_workers.emplace_back(&RequestQueue::Work, this);
+    }
+    error.clear();
+    return MT4_SUCCESS;
+}
+
+void RequestQueue::Stop() {
+    std::vector<std::thread> workers;
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_running = false;
+        workers.swap(m_workers);
+    }
+    m_queued.notify_all();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+long long RequestQueue::Submit(long long tag, Call call) {
+    long long id;
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (!m_running) {
+            return MT4_ERROR_NOT_INITIALIZED;
+        }
+        if (m_requests.size() >= m_maxQueued) {
+            return MT4_ERROR_BUSY;
+        }
+        id = ++m_nextId;
+        m_requests.push_back(Request{ id, tag, std::move(call) });
+    }
+    m_queued.notify_one();
+    return id;
+}
+
+void RequestQueue::Work() {
+    for (;;) {
+        std::unique_lock<std::mutex> lock(m_lock);
+        m_queued.wait(lock, [this] { return !m_requests.empty() || !m_running; });
+        if (m_requests.empty()) {
+            return;
+        }
+        Request request = std::move(m_requests.front());
+        m_requests.pop_front();
+        bool cancelled = !m_running;
+        lock.unlock();
+
+        Result result{ request.id, request.tag, MT4_SUCCESS, std::string() };
+        if (cancelled) {
+            result.result = MT4_ERROR_CANCELLED;
+            result.data = "Queue stopped";
+        }
+        else {
+            try {
+                result.result = request.call(result.data);
+            }
+            catch (const std::exception& e) {
+                result.result = MT4_ERROR_INTERNAL;
+                result.data = e.what();
+            }
+            catch (...) {
+                result.result = MT4_ERROR_INTERNAL;
+                result.data = "Unknown error running queued request";
+            }
+        }
+        Complete(result);
+    }
+}
+
+void RequestQueue::Complete(Result& result) {
+    std::unique_lock<std::mutex> lock(m_completionLock);
+    MT4_CompletionCallback callback = m_callback;
+    void* userContext = m_callbackContext;
+    if (!callback) {
+        m_ready.push_back(std::move(result));
+        lock.unlock();
+        m_completed.notify_one();
+        return;
+    }
+    lock.unlock();
+
+    MT4Completion completion = {};
+    completion.request = result.id;
+    completion.tag = result.tag;
+    completion.data = result.data.c_str();
+    completion.result = result.result;
+    completion.length = (int)result.data.size();
+    callback(&completion, userContext);
+}
+
+void RequestQueue::SetCallback(MT4_CompletionCallback callback, void* userContext) {
+    std::lock_guard<std::mutex> lock(m_completionLock);
+    m_callback = callback;
+    m_callbackContext = userContext;
+}
+
+int RequestQueue::Poll(MT4Completion* records, int maxRecords, int timeoutMs) {
+    std::unique_lock<std::mutex> lock(m_completionLock);
+    if (m_ready.empty() && timeoutMs > 0) {
+        m_completed.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this] { return !m_ready.empty(); });
+    }
+
+    int count = 0;
+    while (count < maxRecords && !m_ready.empty()) {
+        Result& ready = m_ready.front();
+        // Map nodes never move, so data stays put until Free
+        const std::string& data = m_polled.emplace(ready.id, std::move(ready.data)).first->second;
+
+        MT4Completion& completion = records[count++];
+        completion.request = ready.id;
+        completion.tag = ready.tag;
+        completion.data = data.c_str();
+        completion.result = ready.result;
+        completion.length = (int)data.size();
+        m_ready.pop_front();
+    }
+    return count;
+}
+
+bool RequestQueue::Free(long long request) {
+    std::lock_guard<std::mutex> lock(m_completionLock);
+    return m_polled.erase(request) > 0;
+}
+
+void RequestQueue::ClearCompletions() {
+    std::lock_guard<std::mutex> lock(m_completionLock);
+    m_ready.clear();
+    m_polled.clear();
+    m_callback = nullptr;
+    m_callbackContext = nullptr;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Include after MT4Wrapper.h.
+
+// Calls queued by the MT4_Submit* exports and the worker threads that run them.
+// A call runs one blocking export and leaves its output (or error text) in out;
+// its return value becomes the completion's result. Finished calls go to the
+// completion callback when one is set, otherwise to Poll.
+class RequestQueue {
+public:
+    typedef std::function<int(std::string& out)> Call;
+
+    int Start(int workers, int maxQueued, std::string& error);
+
+    // Joins the workers; calls still queued complete with MT4_ERROR_CANCELLED
+    void Stop();
+
+    // Request id (> 0), MT4_ERROR_NOT_INITIALIZED when stopped or
+    // MT4_ERROR_BUSY when the queue is full
+    long long Submit(long long tag, Call call);
+
+    void SetCallback(MT4_CompletionCallback callback, void* userContext);
+    int Poll(MT4Completion* records, int maxRecords, int timeoutMs);
+    bool Free(long long request);
+
+    // Drops completions nobody polled or freed
+    void ClearCompletions();
+
+private:
+    struct Request {
+        long long id;
+        long long tag;
+        Call call;
+    };
+
+    struct Result {
+        long long id;
+        long long tag;
+        int result;
+        std::string data;
+    };
+
+    void Work();
+    void Complete(Result& result);
+
+    std::mutex m_lock;
+    std::condition_variable m_queued;   // a request arrived or the queue stopped
+    std::deque<Request> m_requests;
+    std::vector<std::thread> m_workers;
+    size_t m_maxQueued = 0;
+    bool m_running = false;
+    long long m_nextId = 0;
+
+    std::mutex m_completionLock;
+    std::condition_variable m_completed;
+    MT4_CompletionCallback m_callback = nullptr;
+    void* m_callbackContext = nullptr;
+    std::deque<Result> m_ready;                // waiting for Poll
+    std::map<long long, std::string> m_polled; // returned by Poll, until Free
+};
+
+extern RequestQueue g_requests;